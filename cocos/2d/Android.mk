@@ -30,6 +30,7 @@ CCClippingNode.cpp \
 CCComponent.cpp \
 CCComponentContainer.cpp \
 CCConfiguration.cpp \
+CCCustomCommand.cpp \
 CCDeprecated.cpp \
 CCDirector.cpp \
 CCDrawingPrimitives.cpp \
@@ -79,6 +80,9 @@ CCParticleSystem.cpp \
 CCParticleSystemQuad.cpp \
 CCProfiling.cpp \
 CCProgressTimer.cpp \
+CCQuadCommand.cpp \
+CCRenderCommand.cpp \
+CCRenderer.cpp \
 CCRenderTexture.cpp \
 CCScene.cpp \
 CCScheduler.cpp \
@@ -29,7 +29,109 @@ THE SOFTWARE.
 #include "CCNode.h"
 #include "CCDirector.h"
 
+#if CC_ENABLE_ACTION_POOL && COCOS2D_DEBUG > 0
+#include <thread>
+#endif
+
 NS_CC_BEGIN
+
+#if CC_ENABLE_ACTION_POOL
+namespace {
+
+// Free lists of the blocks of ACTION_BLOCK_GRANULARITY, 2 * ACTION_BLOCK_GRANULARITY, ... ACTION_BLOCK_MAX_SIZE bytes.
+// The blocks are carved from chunks which are never freed, so that the pools can be used until the process exits
+const size_t ACTION_BLOCK_GRANULARITY = 16;
+const size_t ACTION_BLOCK_MAX_SIZE = 256;
+const size_t ACTION_BLOCKS_PER_CHUNK = 64;
+
+struct FreeBlock
+{
+    FreeBlock *next;
+};
+
+FreeBlock* s_freeBlocks[ACTION_BLOCK_MAX_SIZE / ACTION_BLOCK_GRANULARITY];
+
+#if COCOS2D_DEBUG > 0
+// The free lists aren't synchronized, they must only be used by the thread which allocated the first action
+void checkActionPoolThread()
+{
+    static std::thread::id s_poolThreadID = std::this_thread::get_id();
+    CCASSERT(s_poolThreadID == std::this_thread::get_id(), "Actions must be allocated and released on the cocos2d thread");
+}
+#endif
+
+}
+
+void* Action::operator new(size_t size)
+{
+#if COCOS2D_DEBUG > 0
+    checkActionPoolThread();
+#endif
+
+    if (size == 0 || size > ACTION_BLOCK_MAX_SIZE)
+    {
+        return ::operator new(size);
+    }
+
+    size_t index = (size - 1) / ACTION_BLOCK_GRANULARITY;
+    FreeBlock *block = s_freeBlocks[index];
+    if (block == NULL)
+    {
+        size_t blockSize = (index + 1) * ACTION_BLOCK_GRANULARITY;
+        char *chunk = (char*)::operator new(blockSize * ACTION_BLOCKS_PER_CHUNK);
+        for (size_t i = 0; i < ACTION_BLOCKS_PER_CHUNK; ++i)
+        {
+            FreeBlock *newBlock = (FreeBlock*)(chunk + i * blockSize);
+            newBlock->next = block;
+            block = newBlock;
+        }
+    }
+
+    s_freeBlocks[index] = block->next;
+    return block;
+}
+
+void Action::operator delete(void *ptr, size_t size)
+{
+    if (ptr == NULL)
+    {
+        return;
+    }
+
+#if COCOS2D_DEBUG > 0
+    checkActionPoolThread();
+#endif
+
+    if (size == 0 || size > ACTION_BLOCK_MAX_SIZE)
+    {
+        ::operator delete(ptr);
+        return;
+    }
+
+    size_t index = (size - 1) / ACTION_BLOCK_GRANULARITY;
+    FreeBlock *block = (FreeBlock*)ptr;
+    block->next = s_freeBlocks[index];
+    s_freeBlocks[index] = block;
+}
+
+void* Action::operator new(size_t size, const std::nothrow_t& nothrow) noexcept
+{
+    if (size == 0 || size > ACTION_BLOCK_MAX_SIZE)
+    {
+        return ::operator new(size, nothrow);
+    }
+
+    // not taken from the pools, but rounded up like their blocks since operator delete returns it to them
+    return ::operator new(((size - 1) / ACTION_BLOCK_GRANULARITY + 1) * ACTION_BLOCK_GRANULARITY, nothrow);
+}
+
+void Action::operator delete(void *ptr, const std::nothrow_t& nothrow) noexcept
+{
+    // only called when the constructor of an action allocated by the nothrow operator new throws
+    ::operator delete(ptr, nothrow);
+}
+#endif // CC_ENABLE_ACTION_POOL
+
 //
 // Action Base Class
 //
@@ -30,6 +30,9 @@ THE SOFTWARE.
 #include "CCObject.h"
 #include "CCGeometry.h"
 #include "CCPlatformMacros.h"
+#include "ccConfig.h"
+
+#include <new>
 
 NS_CC_BEGIN
 
@@ -55,6 +58,23 @@ public:
      * @lua NA
      */
     virtual ~Action(void);
+
+#if CC_ENABLE_ACTION_POOL
+    /** The actions are allocated from pools of memory blocks of the same size, see CC_ENABLE_ACTION_POOL.
+     Like the reference counting, the pools aren't thread safe: the actions have to be created and released on the cocos2d thread,
+     which is asserted in debug builds.
+     The nothrow and placement forms hidden by the class operators are declared again.
+     @since v3.0
+     * @js NA
+     * @lua NA
+     */
+    static void* operator new(size_t size);
+    static void operator delete(void *ptr, size_t size);
+    static void* operator new(size_t size, const std::nothrow_t& nothrow) noexcept;
+    static void operator delete(void *ptr, const std::nothrow_t& nothrow) noexcept;
+    static void* operator new(size_t size, void *where) noexcept { return where; }
+    static void operator delete(void *ptr, void *where) noexcept {}
+#endif
     /**
      * @js NA
      * @lua NA
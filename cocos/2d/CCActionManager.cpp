@@ -29,29 +29,17 @@ THE SOFTWARE.
 #include "CCNode.h"
 #include "CCScheduler.h"
 #include "ccMacros.h"
-#include "ccCArray.h"
-#include "uthash.h"
 #include "CCSet.h"
 
+#include <algorithm>
+
 NS_CC_BEGIN
-//
-// singleton stuff
-//
-typedef struct _hashElement
-{
-    struct _ccArray             *actions;
-    Object                    *target;
-    int                actionIndex;
-    Action                    *currentAction;
-    bool                        currentActionSalvaged;
-    bool                        paused;
-    UT_hash_handle                hh;
-} tHashElement;
 
 ActionManager::ActionManager(void)
-: _targets(NULL), 
-  _currentTarget(NULL),
-  _currentTargetSalvaged(false)
+: _removedTargets(0)
+, _targetTableCount(0)
+, _currentTarget(-1)
+, _currentTargetSalvaged(false)
 {
 
 }
@@ -65,55 +53,153 @@ ActionManager::~ActionManager(void)
 
 // private
 
-void ActionManager::deleteHashElement(tHashElement *element)
+size_t ActionManager::hashTarget(const Object *target) const
+{
+    size_t hash = (size_t)target >> 3;
+    hash ^= hash >> 11;
+    hash *= 2654435761u;
+    hash ^= hash >> 16;
+    return hash & (_targetTable.size() - 1);
+}
+
+int ActionManager::findTarget(const Object *target) const
+{
+    if (_targetTableCount == 0)
+    {
+        return -1;
+    }
+
+    size_t mask = _targetTable.size() - 1;
+    for (size_t slot = hashTarget(target); _targetTable[slot] != -1; slot = (slot + 1) & mask)
+    {
+        if (_targets[_targetTable[slot]].target == target)
+        {
+            return _targetTable[slot];
+        }
+    }
+    return -1;
+}
+
+void ActionManager::reserveTargetIndex()
 {
-    ccArrayFree(element->actions);
-    HASH_DEL(_targets, element);
-    element->target->release();
-    free(element);
+    // keep the table at most half full
+    if ((_targetTableCount + 1) * 2 > (int)_targetTable.size())
+    {
+        rehashTargets(std::max((size_t)16, _targetTable.size() * 2));
+    }
 }
 
-void ActionManager::actionAllocWithHashElement(tHashElement *element)
+void ActionManager::placeTargetIndex(int targetIndex)
 {
-    // 4 actions per Node by default
-    if (element->actions == NULL)
+    CCASSERT((_targetTableCount + 1) * 2 <= (int)_targetTable.size(), "reserveTargetIndex() should be called first");
+
+    size_t mask = _targetTable.size() - 1;
+    size_t slot = hashTarget(_targets[targetIndex].target);
+    while (_targetTable[slot] != -1)
     {
-        element->actions = ccArrayNew(4);
-    }else 
-    if (element->actions->num == element->actions->max)
+        slot = (slot + 1) & mask;
+    }
+    _targetTable[slot] = targetIndex;
+    ++_targetTableCount;
+}
+
+void ActionManager::eraseTargetIndex(const Object *target)
+{
+    size_t mask = _targetTable.size() - 1;
+    size_t slot = hashTarget(target);
+    while (_targets[_targetTable[slot]].target != target)
     {
-        ccArrayDoubleCapacity(element->actions);
+        slot = (slot + 1) & mask;
     }
+    _targetTable[slot] = -1;
+    --_targetTableCount;
 
+    // move back the following entries of the cluster which can't be found from their home slot anymore
+    for (size_t next = (slot + 1) & mask; _targetTable[next] != -1; next = (next + 1) & mask)
+    {
+        size_t home = hashTarget(_targets[_targetTable[next]].target);
+        bool reachable = (slot <= next) ? (slot < home && home <= next) : (slot < home || home <= next);
+        if (! reachable)
+        {
+            _targetTable[slot] = _targetTable[next];
+            _targetTable[next] = -1;
+            slot = next;
+        }
+    }
 }
 
-void ActionManager::removeActionAtIndex(long index, tHashElement *element)
+void ActionManager::rehashTargets(size_t capacity)
 {
-    Action *action = (Action*)element->actions->arr[index];
+    _targetTable.assign(capacity, -1);
+    _targetTableCount = 0;
 
-    if (action == element->currentAction && (! element->currentActionSalvaged))
+    for (int i = 0; i < (int)_targets.size(); ++i)
     {
-        element->currentAction->retain();
-        element->currentActionSalvaged = true;
+        if (_targets[i].target)
+        {
+            placeTargetIndex(i);
+        }
     }
+}
+
+void ActionManager::compactTargets()
+{
+    _targets.erase(std::remove_if(_targets.begin(), _targets.end(), [](const ActionTarget& element) {
+        return element.target == NULL;
+    }), _targets.end());
+    _removedTargets = 0;
+
+    rehashTargets(_targetTable.size());
+}
+
+void ActionManager::deleteTarget(int targetIndex)
+{
+    ActionTarget& element = _targets[targetIndex];
+    Object *target = element.target;
+
+    eraseTargetIndex(target);
+    element.target = NULL;
+    element.currentAction = NULL;
+    ++_removedTargets;
 
-    ccArrayRemoveObjectAtIndex(element->actions, index, true);
+    // keep the storage of the actions for the next target
+    element.actions.clear();
+    _freeActionLists.push_back(std::move(element.actions));
+    element.actions.clear();
+
+    target->release();
+}
+
+void ActionManager::removeActionAtIndex(long index, int targetIndex)
+{
+    ActionTarget& element = _targets[targetIndex];
+    Action *action = element.actions[index];
+
+    if (action == element.currentAction && (! element.currentActionSalvaged))
+    {
+        element.currentAction->retain();
+        element.currentActionSalvaged = true;
+    }
+
+    element.actions.erase(element.actions.begin() + index);
 
     // update actionIndex in case we are in tick. looping over the actions
-    if (element->actionIndex >= index)
+    if (element.actionIndex >= index)
     {
-        element->actionIndex--;
+        element.actionIndex--;
     }
 
-    if (element->actions->num == 0)
+    action->release();
+
+    if (_targets[targetIndex].actions.empty())
     {
-        if (_currentTarget == element)
+        if (_currentTarget == targetIndex)
         {
             _currentTargetSalvaged = true;
         }
         else
         {
-            deleteHashElement(element);
+            deleteTarget(targetIndex);
         }
     }
 }
@@ -122,21 +208,19 @@ void ActionManager::removeActionAtIndex(long index, tHashElement *element)
 
 void ActionManager::pauseTarget(Object *target)
 {
-    tHashElement *element = NULL;
-    HASH_FIND_PTR(_targets, &target, element);
-    if (element)
+    int index = findTarget(target);
+    if (index != -1)
     {
-        element->paused = true;
+        _targets[index].paused = true;
     }
 }
 
 void ActionManager::resumeTarget(Object *target)
 {
-    tHashElement *element = NULL;
-    HASH_FIND_PTR(_targets, &target, element);
-    if (element)
+    int index = findTarget(target);
+    if (index != -1)
     {
-        element->paused = false;
+        _targets[index].paused = false;
     }
 }
 
@@ -145,12 +229,12 @@ Set* ActionManager::pauseAllRunningActions()
     Set *idsWithActions = new Set();
     idsWithActions->autorelease();
     
-    for (tHashElement *element=_targets; element != NULL; element = (tHashElement *)element->hh.next) 
+    for (auto it = _targets.begin(); it != _targets.end(); ++it)
     {
-        if (! element->paused) 
+        if (it->target && ! it->paused)
         {
-            element->paused = true;
-            idsWithActions->addObject(element->target);
+            it->paused = true;
+            idsWithActions->addObject(it->target);
         }
     }    
     
@@ -173,36 +257,52 @@ void ActionManager::addAction(Action *action, Node *target, bool paused)
     CCASSERT(action != NULL, "");
     CCASSERT(target != NULL, "");
 
-    tHashElement *element = NULL;
-    // we should convert it to Object*, because we save it as Object*
-    Object *tmp = target;
-    HASH_FIND_PTR(_targets, &tmp, element);
-    if (! element)
+    int index = findTarget(target);
+    if (index == -1)
     {
-        element = (tHashElement*)calloc(sizeof(*element), 1);
-        element->paused = paused;
+        ActionTarget element;
+        if (_freeActionLists.empty())
+        {
+            // 4 actions per Node by default
+            element.actions.reserve(4);
+        }
+        else
+        {
+            element.actions.swap(_freeActionLists.back());
+            _freeActionLists.pop_back();
+        }
+        element.actionIndex = 0;
+        element.currentAction = NULL;
+        element.currentActionSalvaged = false;
+        element.paused = paused;
         target->retain();
-        element->target = target;
-        HASH_ADD_PTR(_targets, target, element);
+        element.target = target;
+
+        // grow the table before adding the target, or the rehash would already place it
+        reserveTargetIndex();
+        index = (int)_targets.size();
+        _targets.push_back(std::move(element));
+        placeTargetIndex(index);
     }
 
-     actionAllocWithHashElement(element);
- 
-     CCASSERT(! ccArrayContainsObject(element->actions, action), "");
-     ccArrayAppendObject(element->actions, action);
- 
-     action->startWithTarget(target);
+    std::vector<Action*>& actions = _targets[index].actions;
+    CCASSERT(std::find(actions.begin(), actions.end(), action) == actions.end(), "");
+    actions.push_back(action);
+    action->retain();
+
+    action->startWithTarget(target);
 }
 
 // remove
 
 void ActionManager::removeAllActions(void)
 {
-    for (tHashElement *element = _targets; element != NULL; )
+    for (int i = 0; i < (int)_targets.size(); ++i)
     {
-        Object *target = element->target;
-        element = (tHashElement*)element->hh.next;
-        removeAllActionsFromTarget(target);
+        if (_targets[i].target)
+        {
+            removeAllActionsFromTarget(_targets[i].target);
+        }
     }
 }
 
@@ -214,24 +314,32 @@ void ActionManager::removeAllActionsFromTarget(Object *target)
         return;
     }
 
-    tHashElement *element = NULL;
-    HASH_FIND_PTR(_targets, &target, element);
-    if (element)
+    int index = findTarget(target);
+    if (index != -1)
     {
-        if (ccArrayContainsObject(element->actions, element->currentAction) && (! element->currentActionSalvaged))
+        ActionTarget& element = _targets[index];
+        if (element.currentAction && (! element.currentActionSalvaged) &&
+            std::find(element.actions.begin(), element.actions.end(), element.currentAction) != element.actions.end())
+        {
+            element.currentAction->retain();
+            element.currentActionSalvaged = true;
+        }
+
+        std::vector<Action*>& actions = element.actions;
+        while (! actions.empty())
         {
-            element->currentAction->retain();
-            element->currentActionSalvaged = true;
+            Action *action = actions.back();
+            actions.pop_back();
+            action->release();
         }
 
-        ccArrayRemoveAllObjects(element->actions);
-        if (_currentTarget == element)
+        if (_currentTarget == index)
         {
             _currentTargetSalvaged = true;
         }
         else
         {
-            deleteHashElement(element);
+            deleteTarget(index);
         }
     }
     else
@@ -248,15 +356,14 @@ void ActionManager::removeAction(Action *action)
         return;
     }
 
-    tHashElement *element = NULL;
-    Object *target = action->getOriginalTarget();
-    HASH_FIND_PTR(_targets, &target, element);
-    if (element)
+    int index = findTarget(action->getOriginalTarget());
+    if (index != -1)
     {
-        long i = ccArrayGetIndexOfObject(element->actions, action);
-        if (i != CC_INVALID_INDEX)
+        std::vector<Action*>& actions = _targets[index].actions;
+        auto it = std::find(actions.begin(), actions.end(), action);
+        if (it != actions.end())
         {
-            removeActionAtIndex(i, element);
+            removeActionAtIndex(it - actions.begin(), index);
         }
     }
     else
@@ -270,19 +377,17 @@ void ActionManager::removeActionByTag(int tag, Object *target)
     CCASSERT(tag != Action::INVALID_TAG, "");
     CCASSERT(target != NULL, "");
 
-    tHashElement *element = NULL;
-    HASH_FIND_PTR(_targets, &target, element);
-
-    if (element)
+    int index = findTarget(target);
+    if (index != -1)
     {
-        long limit = element->actions->num;
-        for (long i = 0; i < limit; ++i)
+        const std::vector<Action*>& actions = _targets[index].actions;
+        for (long i = 0, limit = (long)actions.size(); i < limit; ++i)
         {
-            Action *action = (Action*)element->actions->arr[i];
+            Action *action = actions[i];
 
             if (action->getTag() == (int)tag && action->getOriginalTarget() == target)
             {
-                removeActionAtIndex(i, element);
+                removeActionAtIndex(i, index);
                 break;
             }
         }
@@ -291,28 +396,19 @@ void ActionManager::removeActionByTag(int tag, Object *target)
 
 // get
 
-// XXX: Passing "const O *" instead of "const O&" because HASH_FIND_IT requries the address of a pointer
-// and, it is not possible to get the address of a reference
 Action* ActionManager::getActionByTag(int tag, const Object *target) const
 {
     CCASSERT(tag != Action::INVALID_TAG, "");
 
-    tHashElement *element = NULL;
-    HASH_FIND_PTR(_targets, &target, element);
-
-    if (element)
+    int index = findTarget(target);
+    if (index != -1)
     {
-        if (element->actions != NULL)
+        const std::vector<Action*>& actions = _targets[index].actions;
+        for (auto it = actions.begin(); it != actions.end(); ++it)
         {
-            long limit = element->actions->num;
-            for (long i = 0; i < limit; ++i)
+            if ((*it)->getTag() == (int)tag)
             {
-                Action *action = (Action*)element->actions->arr[i];
-
-                if (action->getTag() == (int)tag)
-                {
-                    return action;
-                }
+                return *it;
             }
         }
         CCLOG("cocos2d : getActionByTag(tag = %d): Action not found", tag);
@@ -325,15 +421,12 @@ Action* ActionManager::getActionByTag(int tag, const Object *target) const
     return NULL;
 }
 
-// XXX: Passing "const O *" instead of "const O&" because HASH_FIND_IT requries the address of a pointer
-// and, it is not possible to get the address of a reference
 unsigned int ActionManager::getNumberOfRunningActionsInTarget(const Object *target) const
 {
-    tHashElement *element = NULL;
-    HASH_FIND_PTR(_targets, &target, element);
-    if (element)
+    int index = findTarget(target);
+    if (index != -1)
     {
-        return element->actions ? element->actions->num : 0;
+        return (unsigned int)_targets[index].actions.size();
     }
 
     return 0;
@@ -342,61 +435,71 @@ unsigned int ActionManager::getNumberOfRunningActionsInTarget(const Object *targ
 // main loop
 void ActionManager::update(float dt)
 {
-    for (tHashElement *elt = _targets; elt != NULL; )
+    // _targets may grow while inside this loop, so elements are accessed by index only
+    for (int i = 0; i < (int)_targets.size(); ++i)
     {
-        _currentTarget = elt;
+        if (! _targets[i].target)
+        {
+            continue;
+        }
+
+        _currentTarget = i;
         _currentTargetSalvaged = false;
 
-        if (! _currentTarget->paused)
+        if (! _targets[i].paused)
         {
-            // The 'actions' MutableArray may change while inside this loop.
-            for (_currentTarget->actionIndex = 0; _currentTarget->actionIndex < _currentTarget->actions->num;
-                _currentTarget->actionIndex++)
+            // The 'actions' array may change while inside this loop.
+            for (_targets[i].actionIndex = 0; _targets[i].actionIndex < (int)_targets[i].actions.size();
+                _targets[i].actionIndex++)
             {
-                _currentTarget->currentAction = (Action*)_currentTarget->actions->arr[_currentTarget->actionIndex];
-                if (_currentTarget->currentAction == NULL)
+                ActionTarget *elt = &_targets[i];
+                elt->currentAction = elt->actions[elt->actionIndex];
+                if (elt->currentAction == NULL)
                 {
                     continue;
                 }
 
-                _currentTarget->currentActionSalvaged = false;
+                elt->currentActionSalvaged = false;
 
-                _currentTarget->currentAction->step(dt);
+                elt->currentAction->step(dt);
 
-                if (_currentTarget->currentActionSalvaged)
+                elt = &_targets[i];
+                if (elt->currentActionSalvaged)
                 {
                     // The currentAction told the node to remove it. To prevent the action from
                     // accidentally deallocating itself before finishing its step, we retained
                     // it. Now that step is done, it's safe to release it.
-                    _currentTarget->currentAction->release();
+                    elt->currentAction->release();
                 } else
-                if (_currentTarget->currentAction->isDone())
+                if (elt->currentAction->isDone())
                 {
-                    _currentTarget->currentAction->stop();
+                    elt->currentAction->stop();
 
-                    Action *action = _currentTarget->currentAction;
+                    Action *action = _targets[i].currentAction;
                     // Make currentAction nil to prevent removeAction from salvaging it.
-                    _currentTarget->currentAction = NULL;
+                    _targets[i].currentAction = NULL;
                     removeAction(action);
                 }
 
-                _currentTarget->currentAction = NULL;
+                _targets[i].currentAction = NULL;
             }
         }
 
-        // elt, at this moment, is still valid
-        // so it is safe to ask this here (issue #490)
-        elt = (tHashElement*)(elt->hh.next);
-
         // only delete currentTarget if no actions were scheduled during the cycle (issue #481)
-        if (_currentTargetSalvaged && _currentTarget->actions->num == 0)
+        if (_currentTargetSalvaged && _targets[i].actions.empty())
         {
-            deleteHashElement(_currentTarget);
+            _currentTarget = -1;
+            deleteTarget(i);
         }
     }
 
     // issue #635
-    _currentTarget = NULL;
+    _currentTarget = -1;
+
+    if (_removedTargets > 0 && _removedTargets * 8 >= (int)_targets.size())
+    {
+        compactTargets();
+    }
 }
 
 NS_CC_END
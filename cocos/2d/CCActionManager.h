@@ -31,13 +31,12 @@ THE SOFTWARE.
 #include "CCAction.h"
 #include "CCArray.h"
 #include "CCObject.h"
+#include <vector>
 
 NS_CC_BEGIN
 
 class Set;
 
-struct _hashElement;
-
 /**
  * @addtogroup actions
  * @{
@@ -124,17 +123,47 @@ public:
     void resumeTargets(Set *targetsToResume);
 
 protected:
-    // declared in ActionManager.m
-
-    void removeActionAtIndex(long index, struct _hashElement *pElement);
-    void deleteHashElement(struct _hashElement *pElement);
-    void actionAllocWithHashElement(struct _hashElement *pElement);
+    // the actions of a target
+    struct ActionTarget
+    {
+        Object *target;                 // retained. NULL once removed, the entry is then dropped by the next compaction
+        std::vector<Action*> actions;   // retained
+        int actionIndex;
+        Action *currentAction;
+        bool currentActionSalvaged;
+        bool paused;
+    };
+
+    void removeActionAtIndex(long index, int targetIndex);
+    void deleteTarget(int targetIndex);
     void update(float dt);
 
+private:
+    // index in _targets of the target, -1 if it has no actions
+    int findTarget(const Object *target) const;
+    size_t hashTarget(const Object *target) const;
+    // grows _targetTable so that one more target fits, called before the target is added to _targets
+    void reserveTargetIndex();
+    // adds the index of a target of _targets to _targetTable, which must have room for it
+    void placeTargetIndex(int targetIndex);
+    void eraseTargetIndex(const Object *target);
+    // rebuilds _targetTable with at least 'capacity' slots
+    void rehashTargets(size_t capacity);
+    // drops the removed entries of _targets
+    void compactTargets();
+
 protected:
-    struct _hashElement    *_targets;
-    struct _hashElement    *_currentTarget;
-    bool            _currentTargetSalvaged;
+    // in the order the targets were added. Never shrunk during a tick, so it is only accessed by index
+    std::vector<ActionTarget> _targets;
+    int _removedTargets;
+    // open addressing hash table of the indices in _targets, -1 for an empty slot. Its size is a power of 2
+    std::vector<int> _targetTable;
+    int _targetTableCount;
+    // the storage of the removed targets, reused by the new ones so that running an action doesn't allocate memory
+    std::vector<std::vector<Action*> > _freeActionLists;
+    // index in _targets of the target being ticked, -1 outside of the tick
+    int _currentTarget;
+    bool _currentTargetSalvaged;
 };
 
 // end of actions group
@@ -33,6 +33,7 @@ THE SOFTWARE.
 #include "ccGLStateCache.h"
 #include "CCDirector.h"
 #include "TransformUtils.h"
+#include "CCRenderer.h"
 
 // external
 #include "kazmath/GL/matrix.h"
@@ -54,6 +55,7 @@ AtlasNode::AtlasNode()
 , _uniformColor(0)
 , _ignoreContentScaleFactor(false)
 {
+    _customCommand.func = CC_CALLBACK_0(AtlasNode::onDraw, this);
 }
 
 AtlasNode::~AtlasNode()
@@ -136,6 +138,12 @@ void AtlasNode::updateAtlasValues()
 
 // AtlasNode - draw
 void AtlasNode::draw(void)
+{
+    _customCommand.init(_modelViewTransform);
+    Director::getInstance()->getRenderer()->addCommand(&_customCommand);
+}
+
+void AtlasNode::onDraw()
 {
     CC_NODE_DRAW_SETUP();
 
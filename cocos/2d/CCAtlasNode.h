@@ -30,6 +30,7 @@ THE SOFTWARE.
 #include "CCNode.h"
 #include "CCProtocols.h"
 #include "ccTypes.h"
+#include "CCCustomCommand.h"
 
 NS_CC_BEGIN
 
@@ -113,6 +114,8 @@ private :
     void setIgnoreContentScaleFactor(bool bIgnoreContentScaleFactor);
 
 protected:
+    void onDraw();
+
     //! chars per row
     long    _itemsPerRow;
     //! chars per column
@@ -136,6 +139,8 @@ protected:
     GLint    _uniformColor;
     // This varible is only used for LabelAtlas FPS display. So plz don't modify its value.
     bool _ignoreContentScaleFactor;
+
+    CustomCommand _customCommand;
 };
 
 // end of base_node group
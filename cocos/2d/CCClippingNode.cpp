@@ -31,6 +31,7 @@
 #include "CCShaderCache.h"
 #include "CCDirector.h"
 #include "CCDrawingPrimitives.h"
+#include "CCRenderer.h"
 
 NS_CC_BEGIN
 
@@ -207,6 +208,10 @@ void ClippingNode::visit()
     
     ///////////////////////////////////
     // INIT
+
+    // the stencil state is changed right away, so draw what was recorded before
+    Renderer *renderer = Director::getInstance()->getRenderer();
+    renderer->render();
     
     // increment the current layer
     layer++;
@@ -326,6 +331,9 @@ void ClippingNode::visit()
     transform();
     _stencil->visit();
     kmGLPopMatrix();
+
+    // draw the stencil before restoring the alpha test and depth states
+    renderer->render();
     
     // restore alpha test state
     if (_alphaThreshold < 1)
@@ -362,6 +370,7 @@ void ClippingNode::visit()
     
     // draw (according to the stencil test func) this node and its childs
     Node::visit();
+    renderer->render();
     
     ///////////////////////////////////
     // CLEANUP
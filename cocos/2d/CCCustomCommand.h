@@ -0,0 +1,74 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+ 
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CCCUSTOMCOMMAND_H__
+#define __CCCUSTOMCOMMAND_H__
+
+#include "CCRenderCommand.h"
+#include "kazmath/mat4.h"
+#include <functional>
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup renderer
+ * @{
+ */
+
+/** A command that calls back into arbitrary drawing code.
+ 
+ Nodes that issue their own GL calls (DrawNode, LayerColor, particles, atlases...) put their
+ old draw() body in a callback and record a CustomCommand instead of drawing straight away.
+ The Renderer loads the model-view matrix recorded when the command was added into the kmGL
+ stack before calling `func`, so the callback can use CC_NODE_DRAW_SETUP() as before.
+ @since v3.0
+ */
+class CC_DLL CustomCommand : public RenderCommand
+{
+public:
+    CustomCommand();
+    virtual ~CustomCommand();
+
+    /** Records the model-view matrix the callback has to be executed with */
+    void init(const kmMat4& mv);
+
+    /** Returns the model-view matrix recorded in init() */
+    inline const kmMat4& getModelView() const { return _mv; }
+
+    /** Calls `func` if it was set */
+    void execute();
+
+    std::function<void()> func;
+
+protected:
+    kmMat4 _mv;
+};
+
+// end of renderer group
+/// @}
+
+NS_CC_END
+
+#endif // __CCCUSTOMCOMMAND_H__
@@ -61,6 +61,8 @@ THE SOFTWARE.
 #include "CCConfiguration.h"
 #include "CCEventDispatcher.h"
 #include "CCFontFreeType.h"
+#include "CCRenderer.h"
+#include "CCTMXXMLParser.h"
 
 /**
  Position of the FPS
@@ -74,6 +76,8 @@ THE SOFTWARE.
 using namespace std;
 
 unsigned int g_uNumberOfDraws = 0;
+unsigned int g_uNumberOfQuads = 0;
+unsigned int g_uNumberOfUploadedBytes = 0;
 
 NS_CC_BEGIN
 // XXX it should be a Director ivar. Move it there once support for multiple directors is added
@@ -122,6 +126,8 @@ bool Director::init(void)
     _FPSLabel = nullptr;
     _SPFLabel = nullptr;
     _drawsLabel = nullptr;
+    _quadsLabel = nullptr;
+    _uploadsLabel = nullptr;
     _totalFrames = _frames = 0;
     _FPS = new char[10];
     _lastUpdate = new struct timeval;
@@ -145,6 +151,9 @@ bool Director::init(void)
     _scheduler->scheduleUpdateForTarget(_actionManager, Scheduler::PRIORITY_SYSTEM, false);
 
     _eventDispatcher = new EventDispatcher();
+
+    _renderer = new Renderer();
+
     //init TextureCache
     initTextureCache();
     
@@ -161,6 +170,8 @@ Director::~Director(void)
     CC_SAFE_RELEASE(_FPSLabel);
     CC_SAFE_RELEASE(_SPFLabel);
     CC_SAFE_RELEASE(_drawsLabel);
+    CC_SAFE_RELEASE(_quadsLabel);
+    CC_SAFE_RELEASE(_uploadsLabel);
     
     CC_SAFE_RELEASE(_runningScene);
     CC_SAFE_RELEASE(_notificationNode);
@@ -168,6 +179,7 @@ Director::~Director(void)
     CC_SAFE_RELEASE(_scheduler);
     CC_SAFE_RELEASE(_actionManager);
     CC_SAFE_RELEASE(_eventDispatcher);
+    CC_SAFE_RELEASE(_renderer);
     
     // pop the autorelease pool
     PoolManager::sharedPoolManager()->pop();
@@ -277,6 +289,8 @@ void Director::drawScene()
         showStats();
     }
 
+    _renderer->render();
+
     kmGLPopMatrix();
 
     _totalFrames++;
@@ -354,6 +368,8 @@ void Director::setOpenGLView(EGLView *pobOpenGLView)
         {
             setGLDefaultValues();
         }  
+
+        _renderer->initGLView();
         
         CHECK_GL_ERROR_DEBUG();
 
@@ -465,6 +481,7 @@ void Director::purgeCachedData(void)
         _textureCache->removeUnusedTextures();
     }
     FileUtils::getInstance()->purgeCachedEntries();
+    TMXMapInfo::purgeTileDataCache();
 }
 
 float Director::getZEye(void) const
@@ -708,9 +725,12 @@ void Director::purgeDirector()
     CC_SAFE_RELEASE_NULL(_FPSLabel);
     CC_SAFE_RELEASE_NULL(_SPFLabel);
     CC_SAFE_RELEASE_NULL(_drawsLabel);
+    CC_SAFE_RELEASE_NULL(_quadsLabel);
+    CC_SAFE_RELEASE_NULL(_uploadsLabel);
 
     // purge bitmap cache
     LabelBMFont::purgeCachedData();
+    TMXMapInfo::purgeTileDataCache();
 
     FontFreeType::shutdownFreeType();
 
@@ -821,7 +841,7 @@ void Director::showStats()
     
     if (_displayStats)
     {
-        if (_FPSLabel && _SPFLabel && _drawsLabel)
+        if (_FPSLabel && _SPFLabel && _drawsLabel && _quadsLabel && _uploadsLabel)
         {
             if (_accumDt > CC_DIRECTOR_STATS_INTERVAL)
             {
@@ -837,8 +857,16 @@ void Director::showStats()
                 
                 sprintf(_FPS, "%4lu", (unsigned long)g_uNumberOfDraws);
                 _drawsLabel->setString(_FPS);
+
+                sprintf(_FPS, "%6lu", (unsigned long)g_uNumberOfQuads);
+                _quadsLabel->setString(_FPS);
+
+                sprintf(_FPS, "%6lu", (unsigned long)g_uNumberOfUploadedBytes / 1024);
+                _uploadsLabel->setString(_FPS);
             }
             
+            _uploadsLabel->visit();
+            _quadsLabel->visit();
             _drawsLabel->visit();
             _FPSLabel->visit();
             _SPFLabel->visit();
@@ -846,6 +874,8 @@ void Director::showStats()
     }    
     
     g_uNumberOfDraws = 0;
+    g_uNumberOfQuads = 0;
+    g_uNumberOfUploadedBytes = 0;
 }
 
 void Director::calculateMPF()
@@ -873,6 +903,8 @@ void Director::createStatsLabel()
         CC_SAFE_RELEASE_NULL(_FPSLabel);
         CC_SAFE_RELEASE_NULL(_SPFLabel);
         CC_SAFE_RELEASE_NULL(_drawsLabel);
+        CC_SAFE_RELEASE_NULL(_quadsLabel);
+        CC_SAFE_RELEASE_NULL(_uploadsLabel);
         _textureCache->removeTextureForKey("/cc_fps_images");
         FileUtils::getInstance()->purgeCachedEntries();
     }
@@ -923,8 +955,20 @@ void Director::createStatsLabel()
     _drawsLabel->initWithString("000", texture, 12, 32, '.');
     _drawsLabel->setScale(factor);
 
+    _quadsLabel = new LabelAtlas();
+    _quadsLabel->setIgnoreContentScaleFactor(true);
+    _quadsLabel->initWithString("000000", texture, 12, 32, '.');
+    _quadsLabel->setScale(factor);
+
+    _uploadsLabel = new LabelAtlas();
+    _uploadsLabel->setIgnoreContentScaleFactor(true);
+    _uploadsLabel->initWithString("000000", texture, 12, 32, '.');
+    _uploadsLabel->setScale(factor);
+
     Texture2D::setDefaultAlphaPixelFormat(currentFormat);
 
+    _uploadsLabel->setPosition(Point(0, 68*factor) + CC_DIRECTOR_STATS_POSITION);
+    _quadsLabel->setPosition(Point(0, 51*factor) + CC_DIRECTOR_STATS_POSITION);
     _drawsLabel->setPosition(Point(0, 34*factor) + CC_DIRECTOR_STATS_POSITION);
     _SPFLabel->setPosition(Point(0, 17*factor) + CC_DIRECTOR_STATS_POSITION);
     _FPSLabel->setPosition(CC_DIRECTOR_STATS_POSITION);
@@ -1001,6 +1045,11 @@ EventDispatcher* Director::getEventDispatcher() const
     return _eventDispatcher;
 }
 
+Renderer* Director::getRenderer() const
+{
+    return _renderer;
+}
+
 void Director::setEventDispatcher(EventDispatcher* dispatcher)
 {
     if (_eventDispatcher != dispatcher)
@@ -55,6 +55,7 @@ class Scheduler;
 class ActionManager;
 class EventDispatcher;
 class TextureCache;
+class Renderer;
 
 /**
 @brief Class that creates and handles the main Window and manages how
@@ -125,7 +126,7 @@ public:
 
     /** Whether or not to display the FPS on the bottom-left corner */
     inline bool isDisplayStats() { return _displayStats; }
-    /** Display the FPS on the bottom-left corner */
+    /** Display the FPS, the seconds per frame, the draw calls and the quads drawn per frame on the bottom-left corner */
     inline void setDisplayStats(bool displayStats) { _displayStats = displayStats; }
     
     /** seconds per frame */
@@ -361,6 +362,11 @@ public:
      @since v3.0
      */
     void setEventDispatcher(EventDispatcher* dispatcher);
+
+    /** Returns the Renderer that executes the commands recorded while visiting the scene
+     @since v3.0
+     */
+    Renderer* getRenderer() const;
     
     /* Gets delta time since last tick to main loop */
 	float getDeltaTime() const;
@@ -403,6 +409,11 @@ protected:
      @since v3.0
      */
     EventDispatcher* _eventDispatcher;
+
+    /** Renderer associated with this director
+     @since v3.0
+     */
+    Renderer* _renderer;
         
     /* delta time since last tick to main loop */
 	float _deltaTime;
@@ -426,6 +437,8 @@ protected:
     LabelAtlas *_FPSLabel;
     LabelAtlas *_SPFLabel;
     LabelAtlas *_drawsLabel;
+    LabelAtlas *_quadsLabel;
+    LabelAtlas *_uploadsLabel;  //! KB of vertices uploaded to the GPU per frame
     
     /** Whether or not the Director is paused */
     bool _paused;
@@ -25,6 +25,8 @@
 #include "CCGL.h"
 #include "CCNotificationCenter.h"
 #include "CCEventType.h"
+#include "CCDirector.h"
+#include "CCRenderer.h"
 
 NS_CC_BEGIN
 
@@ -104,6 +106,7 @@ DrawNode::DrawNode()
 , _dirty(false)
 {
     _blendFunc = BlendFunc::ALPHA_PREMULTIPLIED;
+    _customCommand.func = CC_CALLBACK_0(DrawNode::onDraw, this);
 }
 
 DrawNode::~DrawNode()
@@ -230,6 +233,12 @@ void DrawNode::render()
 }
 
 void DrawNode::draw()
+{
+    _customCommand.init(_modelViewTransform);
+    Director::getInstance()->getRenderer()->addCommand(&_customCommand);
+}
+
+void DrawNode::onDraw()
 {
     CC_NODE_DRAW_SETUP();
     GL::blendFunc(_blendFunc.src, _blendFunc.dst);
@@ -32,6 +32,7 @@
 
 #include "CCNode.h"
 #include "ccTypes.h"
+#include "CCCustomCommand.h"
 
 NS_CC_BEGIN
 
@@ -101,6 +102,7 @@ public:
 protected:
     void ensureCapacity(long count);
     void render();
+    void onDraw();
 
     GLuint      _vao;
     GLuint      _vbo;
@@ -112,6 +114,8 @@ protected:
     BlendFunc   _blendFunc;
 
     bool        _dirty;
+
+    CustomCommand _customCommand;
 };
 
 NS_CC_END
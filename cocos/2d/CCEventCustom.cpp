@@ -23,16 +23,68 @@
  ****************************************************************************/
 
 #include "CCEventCustom.h"
+#include "CCEventListener.h"
 #include "ccMacros.h"
 #include <functional>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
 
 NS_CC_BEGIN
 
+// The IDs of custom events follow the IDs of the other event listener types, so they never collide.
+static const int FIRST_CUSTOM_EVENT_ID = static_cast<int>(EventListener::Type::CUSTOM) + 1;
+
+// Interned event names, the name of an ID is s_customEventNames[ID - FIRST_CUSTOM_EVENT_ID].
+// A deque keeps the references returned by getEventName() valid when new names are added.
+// Guarded by s_customEventMutex, events may be constructed with a name on any thread.
+static std::unordered_map<std::string, int> s_customEventIDs;
+static std::deque<std::string> s_customEventNames;
+static std::mutex s_customEventMutex;
+
 EventCustom::EventCustom(const std::string& eventName)
 : Event(Type::CUSTOM)
 , _userData(nullptr)
-, _eventName(eventName)
+, _eventID(getEventIDForName(eventName))
+{
+}
+
+EventCustom::EventCustom(int eventID)
+: Event(Type::CUSTOM)
+, _userData(nullptr)
+, _eventID(eventID)
+{
+#if COCOS2D_DEBUG > 0
+    std::lock_guard<std::mutex> lock(s_customEventMutex);
+    CCASSERT(eventID >= FIRST_CUSTOM_EVENT_ID && eventID < FIRST_CUSTOM_EVENT_ID + static_cast<int>(s_customEventNames.size()), "Invalid custom event ID.");
+#endif
+}
+
+const std::string& EventCustom::getEventName() const
+{
+    // The names are never removed, and the deque doesn't move them when a name is added
+    std::lock_guard<std::mutex> lock(s_customEventMutex);
+    return s_customEventNames[_eventID - FIRST_CUSTOM_EVENT_ID];
+}
+
+int EventCustom::findEventIDForName(const std::string& eventName)
+{
+    std::lock_guard<std::mutex> lock(s_customEventMutex);
+    auto iter = s_customEventIDs.find(eventName);
+    return iter != s_customEventIDs.end() ? iter->second : -1;
+}
+
+int EventCustom::getEventIDForName(const std::string& eventName)
 {
+    std::lock_guard<std::mutex> lock(s_customEventMutex);
+    auto iter = s_customEventIDs.find(eventName);
+    if (iter != s_customEventIDs.end())
+        return iter->second;
+    
+    int eventID = FIRST_CUSTOM_EVENT_ID + static_cast<int>(s_customEventNames.size());
+    s_customEventNames.push_back(eventName);
+    s_customEventIDs.insert(std::make_pair(eventName, eventID));
+    return eventID;
 }
 
 NS_CC_END
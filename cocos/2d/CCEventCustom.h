@@ -32,9 +32,17 @@ NS_CC_BEGIN
 class EventCustom : public Event
 {
 public:
-    /** Constructor */
+    /** Constructor
+     *  @note The name is looked up with getEventIDForName, which locks a mutex. Events dispatched often should be
+     *        constructed with the ID of their name, which is looked up once.
+     */
     EventCustom(const std::string& eventName);
     
+    /** Constructor with an event ID returned by getEventIDForName, the event name isn't looked up.
+     *  @since v3.0
+     */
+    explicit EventCustom(int eventID);
+    
     /** Sets user data */
     inline void setUserData(void* data) { _userData = data; };
     
@@ -42,10 +50,31 @@ public:
     inline void* getUserData() const { return _userData; };
     
     /** Gets event name */
-    inline const std::string& getEventName() const { return _eventName; };
+    const std::string& getEventName() const;
+    
+    /** Gets event ID, it's the listener ID of the custom event listeners of this event */
+    inline int getEventID() const { return _eventID; };
+    
+    /** Sets event ID, so the event can be reused to dispatch another custom event.
+     *  @since v3.0
+     */
+    inline void setEventID(int eventID) { _eventID = eventID; };
+    
+    /** Gets the ID of a custom event name. An ID is assigned when a name is used for the first time,
+     *  it won't change and won't be shared with other names while the application is running.
+     *  It's thread safe.
+     *  @since v3.0
+     */
+    static int getEventIDForName(const std::string& eventName);
+    
+    /** Gets the ID of a custom event name like getEventIDForName, but doesn't assign an ID to a name which was never used.
+     *  @return -1 if no ID was assigned to the name
+     *  @since v3.0
+     */
+    static int findEventIDForName(const std::string& eventName);
 protected:
     void* _userData;       ///< User data
-    std::string _eventName;
+    int _eventID;          ///< The interned event name
 };
 
 NS_CC_END
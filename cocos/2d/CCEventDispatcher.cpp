@@ -55,6 +55,25 @@ private:
     int& _count;
 };
 
+// The touch hit index of EventDispatcher is a grid of TOUCH_HIT_GRID_SIZE x TOUCH_HIT_GRID_SIZE cells
+const int TOUCH_HIT_GRID_SIZE = 16;
+
+int getTouchHitCell(float value, float origin, float size)
+{
+    if (size <= 0)
+        return 0;
+    
+    int cell = static_cast<int>((value - origin) * TOUCH_HIT_GRID_SIZE / size);
+    return std::min(std::max(cell, 0), TOUCH_HIT_GRID_SIZE - 1);
+}
+
+// The bounding box of a node in world space
+cocos2d::Rect getTouchHitBounds(cocos2d::Node* node)
+{
+    const cocos2d::Size& size = node->getContentSize();
+    return cocos2d::RectApplyAffineTransform(cocos2d::Rect(0, 0, size.width, size.height), node->getNodeToWorldTransform());
+}
+
 }
 
 NS_CC_BEGIN
@@ -68,11 +87,7 @@ static EventListener::ListenerID getListenerID(Event* event)
             ret = static_cast<EventListener::ListenerID>(EventListener::Type::ACCELERATION);
             break;
         case Event::Type::CUSTOM:
-            {
-                auto customEvent = static_cast<EventCustom*>(event);
-                auto listenerID = std::hash<std::string>()(customEvent->getEventName());
-                ret = static_cast<EventListener::ListenerID>(listenerID);
-            }
+            ret = static_cast<EventCustom*>(event)->getEventID();
             break;
         case Event::Type::KEYBOARD:
             ret = static_cast<EventListener::ListenerID>(EventListener::Type::KEYBOARD);
@@ -175,7 +190,8 @@ void EventDispatcher::EventListenerVector::clear()
 
 
 EventDispatcher::EventDispatcher()
-: _inDispatch(0)
+: _isTouchHitIndexDirty(true)
+, _inDispatch(0)
 , _isEnabled(true)
 , _nodePriorityIndex(0)
 {
@@ -185,6 +201,14 @@ EventDispatcher::EventDispatcher()
 EventDispatcher::~EventDispatcher()
 {
     removeAllEventListeners();
+    
+    for (auto& iter : _touchClaimingListeners)
+    {
+        for (auto& l : iter.second)
+        {
+            l->release();
+        }
+    }
 }
 
 void EventDispatcher::visitTarget(Node* node)
@@ -203,7 +227,10 @@ void EventDispatcher::visitTarget(Node* node)
             child = static_cast<Node*>( children->getObjectAtIndex(i) );
             
             if ( child && child->getZOrder() < 0 )
-                visitTarget(child);
+            {
+                if (_nodesToVisit.find(child) != _nodesToVisit.end())
+                    visitTarget(child);
+            }
             else
                 break;
         }
@@ -213,7 +240,7 @@ void EventDispatcher::visitTarget(Node* node)
         for( ; i < childrenCount; i++ )
         {
             child = static_cast<Node*>( children->getObjectAtIndex(i) );
-            if (child)
+            if (child && _nodesToVisit.find(child) != _nodesToVisit.end())
                 visitTarget(child);
         }
     }
@@ -383,6 +410,8 @@ void EventDispatcher::removeEventListener(EventListener* listener)
 {
     if (listener == nullptr)
         return;
+    
+    _isTouchHitIndexDirty = true;
 
     bool isFound = false;
 
@@ -541,6 +570,240 @@ void EventDispatcher::dispatchEventToListeners(EventListenerVector* listeners, s
     }
 }
 
+void EventDispatcher::updateTouchHitIndex(EventListenerVector* listeners)
+{
+    if (!_isTouchHitIndexDirty)
+    {
+        // Only the entries whose node or one of its ancestors was changed are updated.
+        bool isGridOutdated = false;
+        for (int i = 0; i < static_cast<int>(_touchHitEntries.size()); ++i)
+        {
+            auto& entry = _touchHitEntries[i];
+            unsigned int version = entry.node->getTransformVersion();
+            if (version == entry.transformVersion)
+                continue;
+            
+            entry.transformVersion = version;
+            Rect bounds = getTouchHitBounds(entry.node);
+            
+            // An entry staying inside the grid only moves between cells, otherwise the grid is rebuilt over the new bounds.
+            if (!isGridOutdated
+                && _touchHitGridBounds.containsPoint(bounds.origin)
+                && _touchHitGridBounds.containsPoint(Point(bounds.getMaxX(), bounds.getMaxY())))
+            {
+                updateTouchHitCells(i, false);
+                entry.bounds = bounds;
+                updateTouchHitCells(i, true);
+            }
+            else
+            {
+                entry.bounds = bounds;
+                isGridOutdated = true;
+            }
+        }
+        
+        if (isGridOutdated)
+        {
+            buildTouchHitCells();
+        }
+        return;
+    }
+    
+    _isTouchHitIndexDirty = false;
+    _touchHitAlwaysEntries.clear();
+    _touchHitEntries.clear();
+    
+    int order = 0;
+    
+    auto addEntry = [&](EventListener* l){
+        auto listener = static_cast<EventListenerTouchOneByOne*>(l);
+        Node* node = listener->getSceneGraphPriority();
+        
+        TouchHitEntry entry = { l, node, order++, Rect::ZERO, 0 };
+        if (listener->isHitTestEnabled() && node != nullptr)
+        {
+            entry.bounds = getTouchHitBounds(node);
+            entry.transformVersion = node->getTransformVersion();
+            _touchHitEntries.push_back(entry);
+        }
+        else
+        {
+            _touchHitAlwaysEntries.push_back(entry);
+        }
+    };
+    
+    // Same order as dispatchEventToListeners: priority < 0, scene graph priority, priority > 0
+    auto fixedPriorityListeners = listeners->getFixedPriorityListeners();
+    auto sceneGraphPriorityListeners = listeners->getSceneGraphPriorityListeners();
+    
+    int i = 0;
+    if (fixedPriorityListeners)
+    {
+        for (; !fixedPriorityListeners->empty() && i < listeners->getGt0Index(); ++i)
+        {
+            addEntry(fixedPriorityListeners->at(i));
+        }
+    }
+    
+    if (sceneGraphPriorityListeners)
+    {
+        for (auto& l : *sceneGraphPriorityListeners)
+        {
+            addEntry(l);
+        }
+    }
+    
+    if (fixedPriorityListeners)
+    {
+        for (; i < static_cast<int>(fixedPriorityListeners->size()); ++i)
+        {
+            addEntry(fixedPriorityListeners->at(i));
+        }
+    }
+    
+    buildTouchHitCells();
+}
+
+void EventDispatcher::buildTouchHitCells()
+{
+    _touchHitCells.clear();
+    
+    if (_touchHitEntries.empty())
+        return;
+    
+    _touchHitGridBounds = _touchHitEntries[0].bounds;
+    for (auto& entry : _touchHitEntries)
+    {
+        _touchHitGridBounds = _touchHitGridBounds.unionWithRect(entry.bounds);
+    }
+    
+    _touchHitCells.resize(TOUCH_HIT_GRID_SIZE * TOUCH_HIT_GRID_SIZE);
+    for (int i = 0; i < static_cast<int>(_touchHitEntries.size()); ++i)
+    {
+        updateTouchHitCells(i, true);
+    }
+}
+
+void EventDispatcher::updateTouchHitCells(int index, bool isAdded)
+{
+    const Rect& bounds = _touchHitEntries[index].bounds;
+    const Point& origin = _touchHitGridBounds.origin;
+    const Size& size = _touchHitGridBounds.size;
+    
+    int minX = getTouchHitCell(bounds.getMinX(), origin.x, size.width);
+    int maxX = getTouchHitCell(bounds.getMaxX(), origin.x, size.width);
+    int minY = getTouchHitCell(bounds.getMinY(), origin.y, size.height);
+    int maxY = getTouchHitCell(bounds.getMaxY(), origin.y, size.height);
+    
+    // The entries are in dispatching order, so keeping the indices sorted keeps every cell in dispatching order.
+    for (int y = minY; y <= maxY; ++y)
+    {
+        for (int x = minX; x <= maxX; ++x)
+        {
+            auto& cell = _touchHitCells[y * TOUCH_HIT_GRID_SIZE + x];
+            auto iter = std::lower_bound(cell.begin(), cell.end(), index);
+            if (isAdded)
+            {
+                cell.insert(iter, index);
+            }
+            else if (iter != cell.end() && *iter == index)
+            {
+                cell.erase(iter);
+            }
+        }
+    }
+}
+
+void EventDispatcher::dispatchTouchBeganToListeners(const Point& location, const std::function<bool(EventListener*)>& onEvent)
+{
+    auto alwaysIter = _touchHitAlwaysEntries.begin();
+    auto alwaysEnd = _touchHitAlwaysEntries.end();
+    std::vector<int>::iterator hitIter, hitEnd;
+    
+    if (_touchHitGridBounds.containsPoint(location))
+    {
+        int x = getTouchHitCell(location.x, _touchHitGridBounds.origin.x, _touchHitGridBounds.size.width);
+        int y = getTouchHitCell(location.y, _touchHitGridBounds.origin.y, _touchHitGridBounds.size.height);
+        auto& cell = _touchHitCells[y * TOUCH_HIT_GRID_SIZE + x];
+        hitIter = cell.begin();
+        hitEnd = cell.end();
+    }
+    else
+    {
+        hitIter = hitEnd = _touchHitCells[0].end();
+    }
+    
+    // Merges the listeners without hit test and the candidates of the cell by their dispatching order
+    while (alwaysIter != alwaysEnd || hitIter != hitEnd)
+    {
+        EventListener* l = nullptr;
+        
+        if (hitIter == hitEnd || (alwaysIter != alwaysEnd && alwaysIter->order < _touchHitEntries[*hitIter].order))
+        {
+            l = alwaysIter->listener;
+            ++alwaysIter;
+        }
+        else
+        {
+            const TouchHitEntry& entry = _touchHitEntries[*hitIter];
+            if (entry.bounds.containsPoint(location))
+            {
+                l = entry.listener;
+            }
+            ++hitIter;
+        }
+        
+        if (l && !l->isPaused() && l->isRegistered() && onEvent(l))
+            break;
+    }
+}
+
+void EventDispatcher::dispatchTouchToClaimingListeners(EventListenerVector* listeners, Touch* touch, EventTouch* event, const std::function<bool(EventListener*)>& onEvent)
+{
+    EventTouch::EventCode eventCode = event->getEventCode();
+    auto iter = _touchClaimingListeners.find(touch->getID());
+    if (iter == _touchClaimingListeners.end())
+        return;
+    
+    // A copy is iterated since the listeners may dispatch other touches, it owns the references of the listeners
+    // once the touch ends, and retains them otherwise.
+    std::vector<EventListener*> claimingListeners = iter->second;
+    if (eventCode == EventTouch::EventCode::ENDED || eventCode == EventTouch::EventCode::CANCELLED)
+    {
+        _touchClaimingListeners.erase(iter);
+    }
+    else
+    {
+        for (auto& l : claimingListeners)
+        {
+            l->retain();
+        }
+    }
+    
+    // The claiming listeners are called in the current dispatching order, their priorities may have changed since the touch began.
+    dispatchEventToListeners(listeners, [&](EventListener* l) -> bool {
+        return std::find(claimingListeners.begin(), claimingListeners.end(), l) != claimingListeners.end() && onEvent(l);
+    });
+    
+    for (auto& l : claimingListeners)
+    {
+        l->release();
+    }
+}
+
+void EventDispatcher::releaseTouchClaimingListeners(int touchID)
+{
+    auto iter = _touchClaimingListeners.find(touchID);
+    if (iter == _touchClaimingListeners.end())
+        return;
+    
+    for (auto& l : iter->second)
+    {
+        l->release();
+    }
+    _touchClaimingListeners.erase(iter);
+}
+
 void EventDispatcher::dispatchEvent(Event* event)
 {
     if (!_isEnabled)
@@ -578,6 +841,13 @@ void EventDispatcher::dispatchEvent(Event* event)
     updateListeners(event);
 }
 
+void EventDispatcher::dispatchCustomEvent(int eventID, void* optionalUserData)
+{
+    EventCustom event(eventID);
+    event.setUserData(optionalUserData);
+    dispatchEvent(&event);
+}
+
 void EventDispatcher::dispatchTouchEvent(EventTouch* event)
 {
     auto touchOneByOneID = static_cast<EventListener::ListenerID>(EventListener::Type::TOUCH_ONE_BY_ONE);
@@ -607,6 +877,9 @@ void EventDispatcher::dispatchTouchEvent(EventTouch* event)
         auto mutableTouchesIter = mutableTouches.begin();
         auto touchesIter = orignalTouches.begin();
         
+        // The touch hit index is only used by the outermost dispatch, a nested one mustn't rebuild it while it's being iterated.
+        bool isHitIndexAvailable = (event->getEventCode() == EventTouch::EventCode::BEGAN && _inDispatch == 1);
+        
         for (; touchesIter != orignalTouches.end(); ++touchesIter)
         {
             bool isSwallowed = false;
@@ -633,6 +906,9 @@ void EventDispatcher::dispatchTouchEvent(EventTouch* event)
                         if (isClaimed && listener->_isRegistered)
                         {
                             listener->_claimedTouches.push_back(*touchesIter);
+                            
+                            listener->retain();
+                            _touchClaimingListeners[(*touchesIter)->getID()].push_back(listener);
                         }
                     }
                 }
@@ -698,7 +974,31 @@ void EventDispatcher::dispatchTouchEvent(EventTouch* event)
             };
             
             //
-            dispatchEventToListeners(oneByOnelisteners, onTouchEvent);
+            if (event->getEventCode() != EventTouch::EventCode::BEGAN)
+            {
+                dispatchTouchToClaimingListeners(oneByOnelisteners, *touchesIter, event, onTouchEvent);
+            }
+            else
+            {
+                // The listeners which claimed a touch of the same ID missed its end
+                releaseTouchClaimingListeners((*touchesIter)->getID());
+                
+                if (isHitIndexAvailable)
+                {
+                    // Updated per touch since the listeners of the previous touch may have moved nodes.
+                    updateTouchHitIndex(oneByOnelisteners);
+                }
+                
+                if (isHitIndexAvailable && !_touchHitCells.empty())
+                {
+                    dispatchTouchBeganToListeners((*touchesIter)->getLocation(), onTouchEvent);
+                }
+                else
+                {
+                    dispatchEventToListeners(oneByOnelisteners, onTouchEvent);
+                }
+            }
+            
             if (event->isStopped())
             {
                 return;
@@ -795,6 +1095,7 @@ void EventDispatcher::updateListeners(Event* event)
                 {
                     iter = sceneGraphPriorityListeners->erase(iter);
                     l->release();
+                    _isTouchHitIndexDirty = true;
                 }
                 else
                 {
@@ -812,6 +1113,7 @@ void EventDispatcher::updateListeners(Event* event)
                 {
                     iter = fixedPriorityListeners->erase(iter);
                     l->release();
+                    _isTouchHitIndexDirty = true;
                 }
                 else
                 {
@@ -940,19 +1242,50 @@ void EventDispatcher::sortEventListenersOfSceneGraphPriority(EventListener::List
     if (listeners == nullptr)
         return;
     
+    auto sceneGraphlisteners = listeners->getSceneGraphPriorityListeners();
+    
+    if (sceneGraphlisteners == nullptr || sceneGraphlisteners->empty())
+        return;
+    
     Node* rootNode = (Node*)Director::getInstance()->getRunningScene();
     // Reset priority index
     _nodePriorityIndex = 0;
     _nodePriorityMap.clear();
+    _nodesToVisit.clear();
+    
+    // Only the paths from the root to the nodes of these listeners decide their order,
+    // so the rest of the scene graph doesn't need to be walked.
+    for (auto& l : *sceneGraphlisteners)
+    {
+        for (Node* node = l->getSceneGraphPriority(); node != nullptr; node = node->getParent())
+        {
+            if (!_nodesToVisit.insert(node).second)
+                break;
+        }
+    }
 
     visitTarget(rootNode);
     
+    // Looks up the priority of each listener once instead of in every comparison.
+    // Nodes which aren't in the running scene get priority 0.
+    std::vector<std::pair<int, EventListener*>> priorities;
+    priorities.reserve(sceneGraphlisteners->size());
+    for (auto& l : *sceneGraphlisteners)
+    {
+        auto iter = _nodePriorityMap.find(l->getSceneGraphPriority());
+        priorities.push_back(std::make_pair(iter != _nodePriorityMap.end() ? iter->second : 0, l));
+    }
+    
     // After sort: priority < 0, > 0
-    auto sceneGraphlisteners = listeners->getSceneGraphPriorityListeners();
-    std::sort(sceneGraphlisteners->begin(), sceneGraphlisteners->end(), [this](const EventListener* l1, const EventListener* l2) {
-        return _nodePriorityMap[l1->getSceneGraphPriority()] > _nodePriorityMap[l2->getSceneGraphPriority()];
+    std::sort(priorities.begin(), priorities.end(), [](const std::pair<int, EventListener*>& p1, const std::pair<int, EventListener*>& p2) {
+        return p1.first > p2.first;
     });
     
+    for (size_t i = 0; i < priorities.size(); ++i)
+    {
+        (*sceneGraphlisteners)[i] = priorities[i].second;
+    }
+    
 #if DUMP_LISTENER_ITEM_PRIORITY_INFO
     log("-----------------------------------");
     for (auto& l : *sceneGraphlisteners)
@@ -1009,6 +1342,8 @@ EventDispatcher::EventListenerVector* EventDispatcher::getListeners(EventListene
 
 void EventDispatcher::removeEventListenersForListenerID(EventListener::ListenerID listenerID)
 {
+    _isTouchHitIndexDirty = true;
+    
     auto listenerItemIter = _listeners.find(listenerID);
     if (listenerItemIter != _listeners.end())
     {
@@ -1075,7 +1410,12 @@ void EventDispatcher::removeEventListeners(EventListener::Type listenerType)
 
 void EventDispatcher::removeCustomEventListeners(const std::string& customEventName)
 {
-    removeEventListenersForListenerID(std::hash<std::string>()(customEventName));
+    // A name which was never used has no listener
+    int eventID = EventCustom::findEventIDForName(customEventName);
+    if (eventID < 0)
+        return;
+    
+    removeEventListenersForListenerID(eventID);
 }
 
 void EventDispatcher::removeAllEventListeners()
@@ -1120,6 +1460,11 @@ void EventDispatcher::setDirtyForNode(Node* node)
 
 void EventDispatcher::setDirty(EventListener::ListenerID listenerID, DirtyFlag flag)
 {    
+    if (listenerID == static_cast<EventListener::ListenerID>(EventListener::Type::TOUCH_ONE_BY_ONE))
+    {
+        _isTouchHitIndexDirty = true;
+    }
+    
     auto iter = _priorityDirtyFlagMap.find(listenerID);
     if (iter == _priorityDirtyFlagMap.end())
     {
@@ -28,10 +28,12 @@
 #include "CCPlatformMacros.h"
 #include "CCEventListener.h"
 #include "CCEvent.h"
+#include "CCGeometry.h"
 
 #include <functional>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <list>
 #include <vector>
 
@@ -39,6 +41,7 @@ NS_CC_BEGIN
 
 class Event;
 class EventTouch;
+class Touch;
 class Node;
 
 /**
@@ -98,6 +101,12 @@ public:
      */
     void dispatchEvent(Event* event);
     
+    /** Dispatches a custom event by the ID of its name, which is returned by EventCustom::getEventIDForName.
+     *  Neither the event name nor a heap allocated event is needed.
+     *  @since v3.0
+     */
+    void dispatchCustomEvent(int eventID, void* optionalUserData = nullptr);
+    
     /** Constructor of EventDispatcher */
     EventDispatcher();
     /** Destructor of EventDispatcher */
@@ -183,6 +192,38 @@ private:
     /** Dispatches event to listeners with a specified listener type */
     void dispatchEventToListeners(EventListenerVector* listeners, std::function<bool(EventListener*)> onEvent);
     
+    /** Dispatches a moved, ended or cancelled touch to the TOUCH_ONE_BY_ONE listeners which claimed it, in dispatching order */
+    void dispatchTouchToClaimingListeners(EventListenerVector* listeners, Touch* touch, EventTouch* event, const std::function<bool(EventListener*)>& onEvent);
+    
+    /** Releases the listeners which claimed a touch of the ID, and forgets them */
+    void releaseTouchClaimingListeners(int touchID);
+    
+    /** Rebuilds the touch hit index if the TOUCH_ONE_BY_ONE listeners were changed,
+     *  otherwise only updates the entries whose node or one of its ancestors was transformed or reparented.
+     */
+    void updateTouchHitIndex(EventListenerVector* listeners);
+    
+    /** Rebuilds the grid of the touch hit index over the bounds of `_touchHitEntries` */
+    void buildTouchHitCells();
+    
+    /** Adds the entry of `_touchHitEntries` at index to the cells overlapping its bounds, or removes it from them */
+    void updateTouchHitCells(int index, bool isAdded);
+    
+    /** Dispatches a began touch to the TOUCH_ONE_BY_ONE listeners in the same order as dispatchEventToListeners does,
+     *  but the listeners which enabled hit test are only visited when the touch is inside their nodes.
+     */
+    void dispatchTouchBeganToListeners(const Point& location, const std::function<bool(EventListener*)>& onEvent);
+    
+    /** An item of the touch hit index */
+    struct TouchHitEntry
+    {
+        EventListener* listener;
+        Node* node;     /// The node of the listener, only used when hit test is enabled
+        int order;      /// The position of the listener in dispatching order
+        Rect bounds;    /// The bounding box of the node in world space, only used when hit test is enabled
+        unsigned int transformVersion;  /// Node::getTransformVersion() when the bounds were computed
+    };
+    
     /// Priority dirty flag
     enum class DirtyFlag
     {
@@ -195,7 +236,9 @@ private:
     /** Sets the dirty flag for a specified listener ID */
     void setDirty(EventListener::ListenerID listenerID, DirtyFlag flag);
     
-    /** Walks though scene graph to get the draw order for each node, it's called before sorting event listener with scene graph priority */
+    /** Walks though scene graph to get the draw order for each node, it's called before sorting event listener with scene graph priority.
+     *  Only the subtrees in `_nodesToVisit` are walked, the other ones don't contain any node of the listeners being sorted.
+     */
     void visitTarget(Node* node);
     
 private:
@@ -211,9 +254,32 @@ private:
     /** The map of node and its event priority */
     std::unordered_map<Node*, int> _nodePriorityMap;
     
+    /** The nodes of the listeners being sorted and all their ancestors */
+    std::unordered_set<Node*> _nodesToVisit;
+    
     /** The listeners to be added after dispatching event */
     std::vector<EventListener*> _toAddedListeners;
     
+    /** The TOUCH_ONE_BY_ONE listeners which claimed each touch ID, they're retained until the touch ends */
+    std::unordered_map<int, std::vector<EventListener*>> _touchClaimingListeners;
+    
+    /** The TOUCH_ONE_BY_ONE listeners without hit test, in dispatching order */
+    std::vector<TouchHitEntry> _touchHitAlwaysEntries;
+    
+    /** The TOUCH_ONE_BY_ONE listeners with hit test, in dispatching order */
+    std::vector<TouchHitEntry> _touchHitEntries;
+    
+    /** A grid over `_touchHitGridBounds`, each cell holds the indices in `_touchHitEntries` of the entries overlapping it,
+     *  in ascending order. It's empty if no listener enabled hit test.
+     */
+    std::vector<std::vector<int>> _touchHitCells;
+    
+    /** Contains the bounds of the hit test listeners, it's only extended when the grid is rebuilt */
+    Rect _touchHitGridBounds;
+    
+    /** Whether the touch hit index needs to be rebuilt because of added, removed or resorted listeners */
+    bool _isTouchHitIndexDirty;
+    
     /** The nodes were associated with scene graph based priority listeners */
     std::set<Node*> _dirtyNodes;
     
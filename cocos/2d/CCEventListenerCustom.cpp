@@ -33,9 +33,14 @@ EventListenerCustom::EventListenerCustom()
 }
 
 EventListenerCustom* EventListenerCustom::create(const std::string& eventName, std::function<void(EventCustom*)> callback)
+{
+    return create(EventCustom::getEventIDForName(eventName), callback);
+}
+
+EventListenerCustom* EventListenerCustom::create(ListenerID eventID, std::function<void(EventCustom*)> callback)
 {
     EventListenerCustom* ret = new EventListenerCustom();
-    if (ret && ret->init(std::hash<std::string>()(eventName), callback))
+    if (ret && ret->init(eventID, callback))
     {
         ret->autorelease();
     }
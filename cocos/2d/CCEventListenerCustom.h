@@ -58,6 +58,13 @@ public:
      */
     static EventListenerCustom* create(const std::string& eventName, std::function<void(EventCustom*)> callback);
     
+    /** Creates an event listener with the ID of an event name and callback.
+     *  @param eventID The ID returned by EventCustom::getEventIDForName.
+     *  @param callback The callback function when the specified event was emitted.
+     *  @since v3.0
+     */
+    static EventListenerCustom* create(ListenerID eventID, std::function<void(EventCustom*)> callback);
+    
     /// Overrides
     virtual bool checkAvailable() override;
     virtual EventListenerCustom* clone() override;
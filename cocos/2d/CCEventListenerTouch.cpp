@@ -36,6 +36,7 @@ EventListenerTouchOneByOne::EventListenerTouchOneByOne()
 , onTouchEnded(nullptr)
 , onTouchCancelled(nullptr)
 , _needSwallow(false)
+, _hitTestEnabled(false)
 {
 }
 
@@ -59,6 +60,17 @@ void EventListenerTouchOneByOne::setSwallowTouches(bool needSwallow)
     _needSwallow = needSwallow;
 }
 
+void EventListenerTouchOneByOne::setHitTestEnabled(bool enabled)
+{
+    CCASSERT(!isRegistered(), "The hit test can't be changed after the listener was added to the event dispatcher.");
+    _hitTestEnabled = enabled;
+}
+
+bool EventListenerTouchOneByOne::isHitTestEnabled() const
+{
+    return _hitTestEnabled;
+}
+
 EventListenerTouchOneByOne* EventListenerTouchOneByOne::create()
 {
     auto ret = new EventListenerTouchOneByOne();
@@ -98,6 +110,7 @@ EventListenerTouchOneByOne* EventListenerTouchOneByOne::clone()
         
         ret->_claimedTouches = _claimedTouches;
         ret->_needSwallow = _needSwallow;
+        ret->_hitTestEnabled = _hitTestEnabled;
     }
     else
     {
@@ -42,6 +42,17 @@ public:
     
     void setSwallowTouches(bool needSwallow);
     
+    /** Enables the hit test of the event dispatcher for this listener.
+     *  If enabled, onTouchBegan is only invoked for touches inside the bounding box of the node (in world space),
+     *  which lets the dispatcher skip the listener without calling it. The priority of the listener is unchanged.
+     *  @note Only works with scene graph priority, and must be set before the listener is added to the event dispatcher.
+     *  @since v3.0
+     */
+    void setHitTestEnabled(bool enabled);
+    
+    /** Whether the hit test of the event dispatcher is enabled for this listener */
+    bool isHitTestEnabled() const;
+    
     /// Overrides
     virtual EventListenerTouchOneByOne* clone() override;
     virtual bool checkAvailable() override;
@@ -59,6 +70,7 @@ private:
     
     std::vector<Touch*> _claimedTouches;
     bool _needSwallow;
+    bool _hitTestEnabled;
     
     friend class EventDispatcher;
 };
@@ -28,6 +28,7 @@ THE SOFTWARE.
 #include "CCDirector.h"
 #include "CCGLProgram.h"
 #include "ccGLStateCache.h"
+#include "CCRenderer.h"
 #include "ccMacros.h"
 #include "platform/CCFileUtils.h"
 #include "uthash.h"
@@ -285,6 +286,13 @@ bool GLProgram::link()
 
 void GLProgram::use()
 {
+    // Draws that don't go through the renderer must not overtake the commands recorded before them
+    Renderer *renderer = Director::getInstance()->getRenderer();
+    if (renderer->hasPendingCommands() && !renderer->isRendering())
+    {
+        renderer->render();
+    }
+
     GL::useProgram(_program);
 }
 
@@ -528,12 +536,17 @@ void GLProgram::setUniformLocationWithMatrix4fv(GLint location, GLfloat* matrixA
 
 void GLProgram::setUniformsForBuiltins()
 {
-    kmMat4 matrixP;
 	kmMat4 matrixMV;
+	kmGLGetMatrix(KM_GL_MODELVIEW, &matrixMV);
+
+    setUniformsForBuiltins(matrixMV);
+}
+
+void GLProgram::setUniformsForBuiltins(const kmMat4 &matrixMV)
+{
+    kmMat4 matrixP;
 
 	kmGLGetMatrix(KM_GL_PROJECTION, &matrixP);
-	kmGLGetMatrix(KM_GL_MODELVIEW, &matrixMV);
-	
 
     if(_flags.usesMVP) {
         kmMat4 matrixMVP;
@@ -543,7 +556,7 @@ void GLProgram::setUniformsForBuiltins()
 
     if(_flags.usesMV) {
         setUniformLocationWithMatrix4fv(_uniforms[UNIFORM_P_MATRIX], matrixP.mat, 1);
-        setUniformLocationWithMatrix4fv(_uniforms[UNIFORM_MV_MATRIX], matrixMV.mat, 1);
+        setUniformLocationWithMatrix4fv(_uniforms[UNIFORM_MV_MATRIX], (GLfloat*)matrixMV.mat, 1);
     }
 
 	if(_flags.usesTime) {
@@ -32,6 +32,7 @@ THE SOFTWARE.
 #include "CCObject.h"
 
 #include "CCGL.h"
+#include "kazmath/mat4.h"
 
 NS_CC_BEGIN
 
@@ -124,7 +125,10 @@ public:
     void addAttribute(const char* attributeName, GLuint index);
     /** links the glProgram */
     bool link();
-    /** it will call glUseProgram() */
+    /** it will call glUseProgram()
+     If the renderer has queued commands and is not executing them, they are flushed first,
+     so that immediate-mode draws are painted in scene-graph order.
+     */
     void use();
 /** It will create 4 uniforms:
     - kUniformPMatrix
@@ -203,6 +207,10 @@ public:
     
     /** will update the builtin uniforms if they are different than the previous call for this same shader program. */
     void setUniformsForBuiltins();
+    /** same as setUniformsForBuiltins(), but uses the given model-view matrix instead of the top of the kmGL stack
+     @since v3.0
+     */
+    void setUniformsForBuiltins(const kmMat4 &modelView);
 
     /** returns the vertexShader error log */
     const char* getVertexShaderLog() const;
@@ -26,6 +26,7 @@ THE SOFTWARE.
 #include "CCGrid.h"
 #include "CCDirector.h"
 #include "CCGrabber.h"
+#include "CCRenderer.h"
 #include "ccUtils.h"
 #include "CCGLProgram.h"
 #include "CCShaderCache.h"
@@ -200,6 +201,9 @@ void GridBase::beforeDraw(void)
 {
     // save projection
     Director *director = Director::getInstance();
+    // what was recorded before has to be drawn with the current projection and frame buffer
+    director->getRenderer()->render();
+
     _directorProjection = director->getProjection();
 
     // 2d projection
@@ -210,10 +214,13 @@ void GridBase::beforeDraw(void)
 
 void GridBase::afterDraw(cocos2d::Node *target)
 {
+    Director *director = Director::getInstance();
+    // draw the grabbed node before unbinding the grabber's frame buffer
+    director->getRenderer()->render();
+
     _grabber->afterRender(_texture);
 
     // restore projection
-    Director *director = Director::getInstance();
     director->setProjection(_directorProjection);
 
     if (target->getCamera()->isDirty())
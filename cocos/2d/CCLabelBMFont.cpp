@@ -183,11 +183,9 @@ void CCBMFontConfiguration::purgeFontDefDictionary()
 std::set<unsigned int>* CCBMFontConfiguration::parseConfigFile(const std::string& controlFile)
 {    
     std::string fullpath = FileUtils::getInstance()->fullPathForFilename(controlFile);
-    String *contents = String::createWithContentsOfFile(fullpath.c_str());
+    FileView *contents = FileUtils::getInstance()->openFileView(fullpath);
 
     CCASSERT(contents, "CCBMFontConfiguration::parseConfigFile | Open file error.");
-    
-    set<unsigned int> *validCharsString = new set<unsigned int>();
 
     if (!contents)
     {
@@ -195,25 +193,22 @@ std::set<unsigned int>* CCBMFontConfiguration::parseConfigFile(const std::string
         return NULL;
     }
 
+    set<unsigned int> *validCharsString = new set<unsigned int>();
+
     // parse spacing / padding
     std::string line;
-    std::string strLeft = contents->getCString();
-    while (strLeft.length() > 0)
+    const char *lineStart = (const char*)contents->getBytes();
+    const char *contentsEnd = lineStart + strlen(lineStart);
+    while (lineStart < contentsEnd)
     {
-        size_t pos = strLeft.find('\n');
-
-        if (pos != (int)std::string::npos)
+        // get one line, straight from the file
+        const char *lineEnd = (const char*)memchr(lineStart, '\n', contentsEnd - lineStart);
+        if (!lineEnd)
         {
-            // the data is more than a line.get one line
-            line = strLeft.substr(0, pos);
-            strLeft = strLeft.substr(pos + 1);
-        }
-        else
-        {
-            // get the left data
-            line = strLeft;
-            strLeft.erase();
+            lineEnd = contentsEnd;
         }
+        line.assign(lineStart, lineEnd);
+        lineStart = lineEnd + 1;
 
         if(line.substr(0,strlen("info face")) == "info face") 
         {
@@ -255,6 +250,8 @@ std::set<unsigned int>* CCBMFontConfiguration::parseConfigFile(const std::string
             this->parseKerningEntry(line);
         }
     }
+
+    contents->release();
     
     return validCharsString;
 }
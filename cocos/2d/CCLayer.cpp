@@ -43,6 +43,7 @@ THE SOFTWARE.
 #include "CCEventListenerAcceleration.h"
 #include "platform/CCDevice.h"
 #include "CCScene.h"
+#include "CCRenderer.h"
 
 NS_CC_BEGIN
 
@@ -234,6 +235,7 @@ LayerColor::LayerColor()
 {
     // default blend function
     _blendFunc = BlendFunc::ALPHA_PREMULTIPLIED;
+    _customCommand.func = CC_CALLBACK_0(LayerColor::onDraw, this);
 }
     
 LayerColor::~LayerColor()
@@ -368,6 +370,12 @@ void LayerColor::updateColor()
 }
 
 void LayerColor::draw()
+{
+    _customCommand.init(_modelViewTransform);
+    Director::getInstance()->getRenderer()->addCommand(&_customCommand);
+}
+
+void LayerColor::onDraw()
 {
     CC_NODE_DRAW_SETUP();
 
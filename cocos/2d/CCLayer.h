@@ -36,6 +36,7 @@ THE SOFTWARE.
 #include "CCPhysicsSetting.h"
 
 #include "CCEventKeyboard.h"
+#include "CCCustomCommand.h"
 
 NS_CC_BEGIN
 
@@ -243,10 +244,13 @@ public:
 
 protected:
     virtual void updateColor();
+    void onDraw();
 
     BlendFunc _blendFunc;
     Vertex2F _squareVertices[4];
     Color4F  _squareColors[4];
+
+    CustomCommand _customCommand;
 };
 
 //
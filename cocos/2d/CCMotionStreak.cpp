@@ -30,6 +30,7 @@ THE SOFTWARE.
 #include "ccMacros.h"
 #include "CCDirector.h"
 #include "CCVertex.h"
+#include "CCRenderer.h"
 
 NS_CC_BEGIN
 
@@ -51,6 +52,7 @@ MotionStreak::MotionStreak()
 , _colorPointer(NULL)
 , _texCoords(NULL)
 {
+    _customCommand.func = CC_CALLBACK_0(MotionStreak::onDraw, this);
 }
 
 MotionStreak::~MotionStreak()
@@ -327,6 +329,12 @@ void MotionStreak::draw()
     if(_nuPoints <= 1)
         return;
 
+    _customCommand.init(_modelViewTransform);
+    Director::getInstance()->getRenderer()->addCommand(&_customCommand);
+}
+
+void MotionStreak::onDraw()
+{
     CC_NODE_DRAW_SETUP();
 
     GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX );
@@ -29,6 +29,7 @@ THE SOFTWARE.
 #include "CCTexture2D.h"
 #include "ccTypes.h"
 #include "CCNode.h"
+#include "CCCustomCommand.h"
 #ifdef EMSCRIPTEN
 #include "CCGLBufferedNode.h"
 #endif // EMSCRIPTEN
@@ -114,6 +115,8 @@ public:
     virtual bool isOpacityModifyRGB() const override;
 
 protected:
+    void onDraw();
+
     bool _fastMode;
     bool _startingPositionInitialized;
 private:
@@ -138,6 +141,8 @@ private:
     Vertex2F* _vertices;
     GLubyte* _colorPointer;
     Tex2F* _texCoords;
+
+    CustomCommand _customCommand;
 };
 
 // end of misc_nodes group
@@ -28,6 +28,7 @@ THE SOFTWARE.
 #include "CCNode.h"
 
 #include <algorithm>
+#include <string.h>
 
 #include "CCString.h"
 #include "ccCArray.h"
@@ -91,6 +92,9 @@ bool nodeComparisonLess(Object* p1, Object* p2)
 // XXX: Yes, nodes might have a sort problem once every 15 days if the game runs at 60 FPS and each frame sprites are reordered.
 static int s_globalOrderOfArrival = 1;
 
+// Gives a node a new transform version whenever its transform or its parent changes, see Node::getTransformVersion()
+static unsigned int s_transformVersionCounter = 0;
+
 Node::Node(void)
 : _rotationX(0.0f)
 , _rotationY(0.0f)
@@ -109,6 +113,8 @@ Node::Node(void)
 , _additionalTransformDirty(false)
 , _transformDirty(true)
 , _inverseDirty(true)
+, _transformVersion(0)
+, _transformUpdated(true)
 , _camera(NULL)
 // children (lazy allocs)
 // lazy alloc
@@ -125,6 +131,7 @@ Node::Node(void)
 , _orderOfArrival(0)
 , _running(false)
 , _visible(true)
+, _cullingEnabled(false)
 , _ignoreAnchorPointForPosition(false)
 , _reorderChildDirty(false)
 , _isTransitionFinished(false)
@@ -145,6 +152,9 @@ Node::Node(void)
     
     ScriptEngineProtocol* pEngine = ScriptEngineManager::getInstance()->getScriptEngine();
     _scriptType = pEngine != NULL ? pEngine->getScriptType() : kScriptTypeNone;
+
+    kmMat4Identity(&_modelViewTransform);
+    kmMat4Identity(&_parentModelViewTransform);
 }
 
 Node::~Node()
@@ -178,6 +188,7 @@ Node::~Node()
             if (node)
             {
                 node->_parent = NULL;
+                node->_transformVersion = ++s_transformVersionCounter;
             }
         }
     }
@@ -208,6 +219,7 @@ void Node::setSkewX(float newSkewX)
 {
     _skewX = newSkewX;
     _transformDirty = _inverseDirty = true;
+    _transformVersion = ++s_transformVersionCounter;
 }
 
 float Node::getSkewY() const
@@ -220,6 +232,7 @@ void Node::setSkewY(float newSkewY)
     _skewY = newSkewY;
 
     _transformDirty = _inverseDirty = true;
+    _transformVersion = ++s_transformVersionCounter;
 }
 
 /// zOrder getter
@@ -257,6 +270,7 @@ float Node::getVertexZ() const
 void Node::setVertexZ(float var)
 {
     _vertexZ = var;
+    _transformUpdated = true;
 }
 
 
@@ -272,6 +286,7 @@ void Node::setRotation(float newRotation)
 {
     _rotationX = _rotationY = newRotation;
     _transformDirty = _inverseDirty = true;
+    _transformVersion = ++s_transformVersionCounter;
     
 #ifdef CC_USE_PHYSICS
     if (_physicsBody)
@@ -290,6 +305,7 @@ void Node::setRotationX(float fRotationX)
 {
     _rotationX = fRotationX;
     _transformDirty = _inverseDirty = true;
+    _transformVersion = ++s_transformVersionCounter;
 }
 
 float Node::getRotationY() const
@@ -301,6 +317,7 @@ void Node::setRotationY(float fRotationY)
 {
     _rotationY = fRotationY;
     _transformDirty = _inverseDirty = true;
+    _transformVersion = ++s_transformVersionCounter;
 }
 
 /// scale getter
@@ -315,6 +332,7 @@ void Node::setScale(float scale)
 {
     _scaleX = _scaleY = scale;
     _transformDirty = _inverseDirty = true;
+    _transformVersion = ++s_transformVersionCounter;
 }
 
 /// scaleX getter
@@ -329,6 +347,7 @@ void Node::setScale(float scaleX,float scaleY)
     _scaleX = scaleX;
     _scaleY = scaleY;
     _transformDirty = _inverseDirty = true;
+    _transformVersion = ++s_transformVersionCounter;
 }
 
 /// scaleX setter
@@ -336,6 +355,7 @@ void Node::setScaleX(float newScaleX)
 {
     _scaleX = newScaleX;
     _transformDirty = _inverseDirty = true;
+    _transformVersion = ++s_transformVersionCounter;
 }
 
 /// scaleY getter
@@ -349,6 +369,7 @@ void Node::setScaleY(float newScaleY)
 {
     _scaleY = newScaleY;
     _transformDirty = _inverseDirty = true;
+    _transformVersion = ++s_transformVersionCounter;
 }
 
 /// position getter
@@ -362,6 +383,7 @@ void Node::setPosition(const Point& newPosition)
 {
     _position = newPosition;
     _transformDirty = _inverseDirty = true;
+    _transformVersion = ++s_transformVersionCounter;
     
 #ifdef CC_USE_PHYSICS
     if (_physicsBody)
@@ -439,6 +461,31 @@ void Node::setVisible(bool var)
     _visible = var;
 }
 
+void Node::setCullingEnabled(bool cullingEnabled)
+{
+    _cullingEnabled = cullingEnabled;
+}
+
+bool Node::isCullingEnabled() const
+{
+    return _cullingEnabled;
+}
+
+bool Node::isInsideVisibleRect() const
+{
+    Rect box = RectApplyAffineTransform(Rect(0, 0, _contentSize.width, _contentSize.height), getNodeToWorldTransform());
+
+    Director *director = Director::getInstance();
+    Point origin = director->getVisibleOrigin();
+    Size size = director->getVisibleSize();
+
+    // touching edges count as visible
+    return !(box.getMaxX() < origin.x ||
+             box.getMinX() > origin.x + size.width ||
+             box.getMaxY() < origin.y ||
+             box.getMinY() > origin.y + size.height);
+}
+
 const Point& Node::getAnchorPointInPoints() const
 {
     return _anchorPointInPoints;
@@ -457,6 +504,7 @@ void Node::setAnchorPoint(const Point& point)
         _anchorPoint = point;
         _anchorPointInPoints = Point(_contentSize.width * _anchorPoint.x, _contentSize.height * _anchorPoint.y );
         _transformDirty = _inverseDirty = true;
+        _transformVersion = ++s_transformVersionCounter;
     }
 }
 
@@ -474,6 +522,7 @@ void Node::setContentSize(const Size & size)
 
         _anchorPointInPoints = Point(_contentSize.width * _anchorPoint.x, _contentSize.height * _anchorPoint.y );
         _transformDirty = _inverseDirty = true;
+        _transformVersion = ++s_transformVersionCounter;
     }
 }
 
@@ -487,6 +536,7 @@ bool Node::isRunning() const
 void Node::setParent(Node * var)
 {
     _parent = var;
+    _transformVersion = ++s_transformVersionCounter;
 }
 
 /// isRelativeAnchorPoint getter
@@ -501,6 +551,7 @@ void Node::ignoreAnchorPointForPosition(bool newValue)
     {
 		_ignoreAnchorPointForPosition = newValue;
 		_transformDirty = _inverseDirty = true;
+		_transformVersion = ++s_transformVersionCounter;
 	}
 }
 
@@ -881,7 +932,10 @@ void Node::visit()
                 break;
         }
         // self draw
-        this->draw();
+        if (!_cullingEnabled || isInsideVisibleRect())
+        {
+            this->draw();
+        }
 
         for( ; i < _children->count(); i++ )
         {
@@ -890,7 +944,7 @@ void Node::visit()
                 node->visit();
         }
     }
-    else
+    else if (!_cullingEnabled || isInsideVisibleRect())
     {
         this->draw();
     }
@@ -921,19 +975,36 @@ void Node::transform()
     updatePhysicsTransform();
 #endif
 
-    kmMat4 transfrom4x4;
+    kmMat4 parentTransform;
+    kmGLGetMatrix(KM_GL_MODELVIEW, &parentTransform);
 
-    // Convert 3x3 into 4x4 matrix
-    CGAffineToGL(this->getNodeToParentTransform(), transfrom4x4.mat);
+    // raises _transformUpdated if the node has moved since the last call
+    const AffineTransform& transform = this->getNodeToParentTransform();
 
-    // Update Z vertex manually
-    transfrom4x4.mat[14] = _vertexZ;
+    // XXX: Expensive calls. Camera should be integrated into the cached affine matrix
+    bool useCamera = ( _camera != NULL && !(_grid != NULL && _grid->isActive()) );
 
-    kmGLMultMatrix( &transfrom4x4 );
+    // Only recompute the model-view matrix if the node or any of its ancestors has moved.
+    // Comparing the parent matrix also catches projection changes and nodes visited from another parent (RenderTexture...)
+    if (_transformUpdated || memcmp(&parentTransform, &_parentModelViewTransform, sizeof(kmMat4)) != 0)
+    {
+        kmMat4 transfrom4x4;
 
+        // Convert 3x3 into 4x4 matrix
+        CGAffineToGL(transform, transfrom4x4.mat);
 
-    // XXX: Expensive calls. Camera should be integrated into the cached affine matrix
-    if ( _camera != NULL && !(_grid != NULL && _grid->isActive()) )
+        // Update Z vertex manually
+        transfrom4x4.mat[14] = _vertexZ;
+
+        kmMat4Multiply(&_modelViewTransform, &parentTransform, &transfrom4x4);
+        _parentModelViewTransform = parentTransform;
+        _transformUpdated = false;
+    }
+
+    // the commands recorded by draw() are executed later on and use this matrix
+    kmGLLoadMatrix(&_modelViewTransform);
+
+    if ( useCamera )
     {
         bool translate = (_anchorPointInPoints.x != 0.0f || _anchorPointInPoints.y != 0.0f);
 
@@ -944,8 +1015,11 @@ void Node::transform()
 
         if( translate )
             kmGLTranslatef(RENDER_IN_SUBPIXEL(-_anchorPointInPoints.x), RENDER_IN_SUBPIXEL(-_anchorPointInPoints.y), 0 );
-    }
 
+        // the cached matrix now includes the camera, which may move at any time: recompute it next time
+        kmGLGetMatrix(KM_GL_MODELVIEW, &_modelViewTransform);
+        _transformUpdated = true;
+    }
 }
 
 
@@ -1259,6 +1333,7 @@ const AffineTransform& Node::getNodeToParentTransform() const
         }
 
         _transformDirty = false;
+        _transformUpdated = true;
     }
 
     return _transform;
@@ -1269,6 +1344,7 @@ void Node::setAdditionalTransform(const AffineTransform& additionalTransform)
     _additionalTransform = additionalTransform;
     _transformDirty = true;
     _additionalTransformDirty = true;
+    _transformVersion = ++s_transformVersionCounter;
 }
 
 const AffineTransform& Node::getParentToNodeTransform() const
@@ -1296,6 +1372,21 @@ AffineTransform Node::getWorldToNodeTransform() const
     return AffineTransformInvert(this->getNodeToWorldTransform());
 }
 
+void Node::updateTransformVersion() const
+{
+    _transformVersion = ++s_transformVersionCounter;
+}
+
+unsigned int Node::getTransformVersion() const
+{
+    unsigned int version = _transformVersion;
+    for (Node *p = _parent; p != nullptr; p = p->getParent())
+    {
+        version = std::max(version, p->_transformVersion);
+    }
+    return version;
+}
+
 Point Node::convertToNodeSpace(const Point& worldPoint) const
 {
     Point ret = PointApplyAffineTransform(worldPoint, getWorldToNodeTransform());
@@ -1346,6 +1437,7 @@ void Node::updatePhysicsTransform()
         _position = _physicsBody->getPosition();
         _rotationX = _rotationY = _physicsBody->getRotation();
         _transformDirty = _inverseDirty = true;
+        _transformVersion = ++s_transformVersionCounter;
     }
 }
 #endif
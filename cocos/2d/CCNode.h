@@ -470,6 +470,36 @@ public:
      */
     virtual bool isVisible() const;
 
+    /**
+     * Sets whether the node skips its own draw when it is outside the visible rect
+     *
+     * When enabled, visit() tests the bounding box of the node in world space against the visible rect
+     * of the Director before calling draw(). Its children are still visited: each of them is culled
+     * according to its own setting.
+     * Don't enable it on nodes drawn outside of their content size (particle systems, DrawNode...) or
+     * on nodes drawn into a RenderTexture.
+     *
+     * The default value is false.
+     *
+     * @param cullingEnabled   true to skip the draw of the node when it is off-screen.
+     * @since v3.0
+     */
+    void setCullingEnabled(bool cullingEnabled);
+    /**
+     * Returns whether the node skips its own draw when it is outside the visible rect
+     *
+     * @see setCullingEnabled(bool)
+     * @since v3.0
+     */
+    bool isCullingEnabled() const;
+    /**
+     * Returns whether the bounding box of the node, in world space, intersects the visible rect of the Director
+     *
+     * @see setCullingEnabled(bool)
+     * @since v3.0
+     */
+    virtual bool isInsideVisibleRect() const;
+
     
     /** 
      * Sets the rotation (angle) of the node in degrees. 
@@ -965,6 +995,9 @@ public:
 
     /** 
      * Override this method to draw your own node.
+     * Since v3.0 draw() is expected to record its drawing into the Renderer (see QuadCommand and CustomCommand)
+     * using the model-view matrix computed by transform(), instead of issuing GL calls straight away.
+     * Immediate-mode draws still work: the renderer is flushed when they use their GL program.
      * The following GL states will be enabled by default:
      * - glEnableClientState(GL_VERTEX_ARRAY);
      * - glEnableClientState(GL_COLOR_ARRAY);
@@ -1280,6 +1313,16 @@ public:
     /** @deprecated Use worldToNodeTransform() instead */
     CC_DEPRECATED_ATTRIBUTE inline virtual AffineTransform worldToNodeTransform() const { return getWorldToNodeTransform(); }
 
+    /**
+     * Returns the transform version of the node in world space, which changes every time the transform or the parent
+     * of this node or of one of its ancestors is changed.
+     * It lets caches of world space data find out whether they are out of date, without being invalidated by other nodes.
+     * @note Subclasses which compute their transform outside of Node's setters (e.g. PhysicsSprite) must call
+     *       updateTransformVersion() when it changes.
+     * @since v3.0
+     */
+    unsigned int getTransformVersion() const;
+
     /// @} end of Transformations
     
     
@@ -1426,6 +1469,9 @@ protected:
     /// Convert cocos2d coordinates to UI windows coordinate.
     Point convertToWindowSpace(const Point& nodePoint) const;
 
+    /// Gives the node a new transform version, see getTransformVersion()
+    void updateTransformVersion() const;
+
 
     float _rotationX;                 ///< rotation angle on x-axis
     float _rotationY;                 ///< rotation angle on y-axis
@@ -1452,6 +1498,11 @@ protected:
     mutable bool _additionalTransformDirty;   ///< The flag to check whether the additional transform is dirty
     mutable bool _transformDirty;             ///< transform dirty flag
     mutable bool _inverseDirty;               ///< inverse transform dirty flag
+    mutable unsigned int _transformVersion;   ///< stamp of the last change of the transform or the parent, see getTransformVersion()
+    mutable bool _transformUpdated;           ///< whether the transform changed since the model-view matrix was last computed. Must be set by getNodeToParentTransform() overrides
+
+    kmMat4 _modelViewTransform;     ///< model-view matrix computed by the last transform(), used to record render commands
+    kmMat4 _parentModelViewTransform; ///< parent model-view matrix _modelViewTransform was computed from
 
     Camera *_camera;                ///< a camera
     
@@ -1480,6 +1531,8 @@ protected:
     bool _running;                    ///< is running
     
     bool _visible;                    ///< is this node visible
+
+    bool _cullingEnabled;             ///< whether the draw of the node is skipped when it is outside the visible rect
     
     bool _ignoreAnchorPointForPosition; ///< true if the Anchor Point will be (0,0) when you position the Node, false otherwise.
                                           ///< Used by Layer and Scene.
@@ -42,13 +42,15 @@
 #include "platform/CCFileUtils.h"
 #include "kazmath/GL/matrix.h"
 #include "CCProfiling.h"
+#include "CCDirector.h"
+#include "CCRenderer.h"
 
 NS_CC_BEGIN
 
 ParticleBatchNode::ParticleBatchNode()
 : _textureAtlas(NULL)
 {
-
+    _customCommand.func = CC_CALLBACK_0(ParticleBatchNode::onDraw, this);
 }
 
 ParticleBatchNode::~ParticleBatchNode()
@@ -399,13 +401,19 @@ void ParticleBatchNode::removeAllChildrenWithCleanup(bool doCleanup)
 
 void ParticleBatchNode::draw(void)
 {
-    CC_PROFILER_START("CCParticleBatchNode - draw");
-
     if( _textureAtlas->getTotalQuads() == 0 )
     {
         return;
     }
 
+    _customCommand.init(_modelViewTransform);
+    Director::getInstance()->getRenderer()->addCommand(&_customCommand);
+}
+
+void ParticleBatchNode::onDraw()
+{
+    CC_PROFILER_START("CCParticleBatchNode - draw");
+
     CC_NODE_DRAW_SETUP();
 
     GL::blendFunc( _blendFunc.src, _blendFunc.dst );
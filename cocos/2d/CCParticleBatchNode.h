@@ -31,6 +31,7 @@
 
 #include "CCNode.h"
 #include "CCProtocols.h"
+#include "CCCustomCommand.h"
 
 NS_CC_BEGIN
 
@@ -128,6 +129,7 @@ public:
     virtual const BlendFunc& getBlendFunc(void) const override;
 
 private:
+    void onDraw();
     void updateAllAtlasIndexes();
     void increaseAtlasCapacityTo(unsigned int quantity);
     unsigned int searchNewPositionInChildrenForZ(int z);
@@ -140,6 +142,8 @@ private:
 private:
     /** the blend function used for drawing the quads */
     BlendFunc _blendFunc;
+    /** the command recorded into the renderer to draw the quads */
+    CustomCommand _customCommand;
 };
 
 // end of particle_nodes group
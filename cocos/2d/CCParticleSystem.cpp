@@ -44,6 +44,12 @@ THE SOFTWARE.
 #include "CCParticleSystem.h"
 
 #include <string>
+#include <deque>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #include "CCParticleBatchNode.h"
 #include "ccTypes.h"
@@ -80,13 +86,210 @@ NS_CC_BEGIN
 //  cocos2d uses a another approach, but the results are almost identical. 
 //
 
+//
+// Worker threads running the simulate() step of the particle systems when
+// ParticleSystem::setParallelSimulationEnabled(true) is used.
+// Systems are queued by ParticleSystem::update() and waited for by ParticleSystem::finishSimulation(),
+// both on the main thread.
+//
+class ParticleSimulationPool
+{
+public:
+    static ParticleSimulationPool* getInstance()
+    {
+        static ParticleSimulationPool s_pool;
+        return &s_pool;
+    }
+
+    void submit(ParticleSystem* system)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (_threads.empty())
+        {
+            unsigned int count = std::thread::hardware_concurrency();
+            count = count > 1 ? std::min(count - 1, 8u) : 1;
+            for (unsigned int i = 0; i < count; ++i)
+            {
+                _threads.push_back(std::thread(&ParticleSimulationPool::workerLoop, this));
+            }
+        }
+        _queue.push_back(system);
+        _jobCondition.notify_one();
+    }
+
+    void wait(ParticleSystem* system)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        // not started yet: run it here instead of waiting for a worker
+        auto it = std::find(_queue.begin(), _queue.end(), system);
+        if (it != _queue.end())
+        {
+            _queue.erase(it);
+            lock.unlock();
+            system->simulate();
+            return;
+        }
+
+        _doneCondition.wait(lock, [this, system]{
+            return std::find(_running.begin(), _running.end(), system) == _running.end();
+        });
+    }
+
+private:
+    ParticleSimulationPool()
+    : _quit(false)
+    {
+    }
+
+    ~ParticleSimulationPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _quit = true;
+        }
+        _jobCondition.notify_all();
+        for (auto& thread : _threads)
+        {
+            thread.join();
+        }
+    }
+
+    void workerLoop()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (true)
+        {
+            _jobCondition.wait(lock, [this]{ return _quit || !_queue.empty(); });
+            if (_queue.empty())
+            {
+                break;
+            }
+
+            ParticleSystem* system = _queue.front();
+            _queue.pop_front();
+            _running.push_back(system);
+
+            lock.unlock();
+            system->simulate();
+            lock.lock();
+
+            _running.erase(std::find(_running.begin(), _running.end(), system));
+            _doneCondition.notify_all();
+        }
+    }
+
+    std::vector<std::thread> _threads;
+    std::deque<ParticleSystem*> _queue;
+    std::vector<ParticleSystem*> _running;
+    std::mutex _mutex;
+    std::condition_variable _jobCondition;
+    std::condition_variable _doneCondition;
+    bool _quit;
+};
+
+static bool s_parallelSimulation = false;
+
+ParticleData::ParticleData()
+: _buffer(NULL)
+, _maxCount(0)
+{
+    setArrays(NULL, 0);
+}
+
+ParticleData::~ParticleData()
+{
+    release();
+}
+
+bool ParticleData::init(int count)
+{
+    release();
+
+    // one block for every array, atlasIndex is the last one
+    _buffer = calloc(count, FLOAT_ARRAYS * sizeof(float) + sizeof(unsigned int));
+    if (!_buffer)
+    {
+        return false;
+    }
+
+    setArrays((float*)_buffer, count);
+    _maxCount = count;
+
+    return true;
+}
+
+void ParticleData::release()
+{
+    CC_SAFE_FREE(_buffer);
+    setArrays(NULL, 0);
+    _maxCount = 0;
+}
+
+void ParticleData::setArrays(float* block, int count)
+{
+    float** arrays[FLOAT_ARRAYS] = {
+        &posx, &posy, &startPosX, &startPosY,
+        &colorR, &colorG, &colorB, &colorA,
+        &deltaColorR, &deltaColorG, &deltaColorB, &deltaColorA,
+        &size, &deltaSize, &rotation, &deltaRotation, &timeToLive,
+        &modeA.dirX, &modeA.dirY, &modeA.radialAccel, &modeA.tangentialAccel,
+        &modeB.angle, &modeB.degreesPerSecond, &modeB.radius, &modeB.deltaRadius,
+    };
+
+    for (int i = 0; i < FLOAT_ARRAYS; ++i)
+    {
+        *arrays[i] = block ? block + i * count : NULL;
+    }
+    atlasIndex = block ? (unsigned int*)(block + FLOAT_ARRAYS * count) : NULL;
+}
+
+void ParticleData::copyParticle(int dst, int src)
+{
+    posx[dst] = posx[src];
+    posy[dst] = posy[src];
+    startPosX[dst] = startPosX[src];
+    startPosY[dst] = startPosY[src];
+
+    colorR[dst] = colorR[src];
+    colorG[dst] = colorG[src];
+    colorB[dst] = colorB[src];
+    colorA[dst] = colorA[src];
+
+    deltaColorR[dst] = deltaColorR[src];
+    deltaColorG[dst] = deltaColorG[src];
+    deltaColorB[dst] = deltaColorB[src];
+    deltaColorA[dst] = deltaColorA[src];
+
+    size[dst] = size[src];
+    deltaSize[dst] = deltaSize[src];
+
+    rotation[dst] = rotation[src];
+    deltaRotation[dst] = deltaRotation[src];
+
+    timeToLive[dst] = timeToLive[src];
+
+    atlasIndex[dst] = atlasIndex[src];
+
+    modeA.dirX[dst] = modeA.dirX[src];
+    modeA.dirY[dst] = modeA.dirY[src];
+    modeA.radialAccel[dst] = modeA.radialAccel[src];
+    modeA.tangentialAccel[dst] = modeA.tangentialAccel[src];
+
+    modeB.angle[dst] = modeB.angle[src];
+    modeB.degreesPerSecond[dst] = modeB.degreesPerSecond[src];
+    modeB.radius[dst] = modeB.radius[src];
+    modeB.deltaRadius[dst] = modeB.deltaRadius[src];
+}
+
 ParticleSystem::ParticleSystem()
-: _configName("")
+: _step()
+, _simulationPending(false)
+, _configName("")
 , _isBlendAdditive(false)
 , _isAutoRemoveOnFinish(false)
 , _plistFile("")
 , _elapsed(0)
-, _particles(NULL)
 , _emitCounter(0)
 , _particleIdx(0)
 , _batchNode(NULL)
@@ -429,11 +632,7 @@ bool ParticleSystem::initWithTotalParticles(unsigned int numberOfParticles)
 {
     _totalParticles = numberOfParticles;
 
-    CC_SAFE_FREE(_particles);
-    
-    _particles = (tParticle*)calloc(_totalParticles, sizeof(tParticle));
-
-    if( ! _particles )
+    if( ! _particleData.init(_totalParticles) )
     {
         CCLOG("Particle system: not enough memory");
         this->release();
@@ -445,7 +644,7 @@ bool ParticleSystem::initWithTotalParticles(unsigned int numberOfParticles)
     {
         for (int i = 0; i < _totalParticles; i++)
         {
-            _particles[i].atlasIndex=i;
+            _particleData.atlasIndex[i] = i;
         }
     }
     // default, active
@@ -466,9 +665,6 @@ bool ParticleSystem::initWithTotalParticles(unsigned int numberOfParticles)
 
     _isAutoRemoveOnFinish = false;
 
-    // Optimization: compile updateParticle method
-    //updateParticleSel = @selector(updateQuadWithParticle:newPosition:);
-    //updateParticleImp = (CC_UPDATE_PARTICLE_IMP) [self methodForSelector:updateParticleSel];
     //for batchNode
     _transformSystemDirty = false;
     // update after action in run!
@@ -482,7 +678,7 @@ ParticleSystem::~ParticleSystem()
     // Since the scheduler retains the "target (in this case the ParticleSystem)
 	// it is not needed to call "unscheduleUpdate" here. In fact, it will be called in "cleanup"
     //unscheduleUpdate();
-    CC_SAFE_FREE(_particles);
+    _particleData.release();
     CC_SAFE_RELEASE(_texture);
 }
 
@@ -493,123 +689,188 @@ bool ParticleSystem::addParticle()
         return false;
     }
 
-    tParticle * particle = &_particles[ _particleCount ];
-    this->initParticle(particle);
-    ++_particleCount;
+    this->addParticles(1);
 
     return true;
 }
 
-void ParticleSystem::initParticle(tParticle* particle)
+void ParticleSystem::addParticles(int count)
 {
+    finishSimulation();
+
+    CCASSERT(_particleCount + count <= _totalParticles, "ParticleSystem: not enough room for the new particles");
+
+    // each attribute is initialized for all the new particles before the next one,
+    // so the random numbers are drawn in a fixed order for a given count
+    const int start = _particleCount;
+    const int end = _particleCount + count;
+
     // timeToLive
     // no negative life. prevent division by 0
-    particle->timeToLive = _life + _lifeVar * CCRANDOM_MINUS1_1();
-    particle->timeToLive = MAX(0, particle->timeToLive);
+    for (int i = start; i < end; ++i)
+    {
+        float life = _life + _lifeVar * CCRANDOM_MINUS1_1();
+        _particleData.timeToLive[i] = MAX(0, life);
+    }
 
     // position
-    particle->pos.x = _sourcePosition.x + _posVar.x * CCRANDOM_MINUS1_1();
+    for (int i = start; i < end; ++i)
+    {
+        _particleData.posx[i] = _sourcePosition.x + _posVar.x * CCRANDOM_MINUS1_1();
+    }
+    for (int i = start; i < end; ++i)
+    {
+        _particleData.posy[i] = _sourcePosition.y + _posVar.y * CCRANDOM_MINUS1_1();
+    }
 
-    particle->pos.y = _sourcePosition.y + _posVar.y * CCRANDOM_MINUS1_1();
+    // Color
+#define SET_COLOR(c, b, v)\
+    for (int i = start; i < end; ++i)\
+    {\
+        c[i] = clampf(b + v * CCRANDOM_MINUS1_1(), 0, 1);\
+    }
 
+    SET_COLOR(_particleData.colorR, _startColor.r, _startColorVar.r);
+    SET_COLOR(_particleData.colorG, _startColor.g, _startColorVar.g);
+    SET_COLOR(_particleData.colorB, _startColor.b, _startColorVar.b);
+    SET_COLOR(_particleData.colorA, _startColor.a, _startColorVar.a);
 
-    // Color
-    Color4F start;
-    start.r = clampf(_startColor.r + _startColorVar.r * CCRANDOM_MINUS1_1(), 0, 1);
-    start.g = clampf(_startColor.g + _startColorVar.g * CCRANDOM_MINUS1_1(), 0, 1);
-    start.b = clampf(_startColor.b + _startColorVar.b * CCRANDOM_MINUS1_1(), 0, 1);
-    start.a = clampf(_startColor.a + _startColorVar.a * CCRANDOM_MINUS1_1(), 0, 1);
-
-    Color4F end;
-    end.r = clampf(_endColor.r + _endColorVar.r * CCRANDOM_MINUS1_1(), 0, 1);
-    end.g = clampf(_endColor.g + _endColorVar.g * CCRANDOM_MINUS1_1(), 0, 1);
-    end.b = clampf(_endColor.b + _endColorVar.b * CCRANDOM_MINUS1_1(), 0, 1);
-    end.a = clampf(_endColor.a + _endColorVar.a * CCRANDOM_MINUS1_1(), 0, 1);
-
-    particle->color = start;
-    particle->deltaColor.r = (end.r - start.r) / particle->timeToLive;
-    particle->deltaColor.g = (end.g - start.g) / particle->timeToLive;
-    particle->deltaColor.b = (end.b - start.b) / particle->timeToLive;
-    particle->deltaColor.a = (end.a - start.a) / particle->timeToLive;
+    // the end colors are kept in the delta arrays until the deltas are computed
+    SET_COLOR(_particleData.deltaColorR, _endColor.r, _endColorVar.r);
+    SET_COLOR(_particleData.deltaColorG, _endColor.g, _endColorVar.g);
+    SET_COLOR(_particleData.deltaColorB, _endColor.b, _endColorVar.b);
+    SET_COLOR(_particleData.deltaColorA, _endColor.a, _endColorVar.a);
 
-    // size
-    float startS = _startSize + _startSizeVar * CCRANDOM_MINUS1_1();
-    startS = MAX(0, startS); // No negative value
+#undef SET_COLOR
 
-    particle->size = startS;
+    for (int i = start; i < end; ++i)
+    {
+        _particleData.deltaColorR[i] = (_particleData.deltaColorR[i] - _particleData.colorR[i]) / _particleData.timeToLive[i];
+        _particleData.deltaColorG[i] = (_particleData.deltaColorG[i] - _particleData.colorG[i]) / _particleData.timeToLive[i];
+        _particleData.deltaColorB[i] = (_particleData.deltaColorB[i] - _particleData.colorB[i]) / _particleData.timeToLive[i];
+        _particleData.deltaColorA[i] = (_particleData.deltaColorA[i] - _particleData.colorA[i]) / _particleData.timeToLive[i];
+    }
+
+    // size
+    for (int i = start; i < end; ++i)
+    {
+        float startS = _startSize + _startSizeVar * CCRANDOM_MINUS1_1();
+        _particleData.size[i] = MAX(0, startS); // No negative value
+    }
 
     if (_endSize == START_SIZE_EQUAL_TO_END_SIZE)
     {
-        particle->deltaSize = 0;
+        for (int i = start; i < end; ++i)
+        {
+            _particleData.deltaSize[i] = 0;
+        }
     }
     else
     {
-        float endS = _endSize + _endSizeVar * CCRANDOM_MINUS1_1();
-        endS = MAX(0, endS); // No negative values
-        particle->deltaSize = (endS - startS) / particle->timeToLive;
+        for (int i = start; i < end; ++i)
+        {
+            float endS = _endSize + _endSizeVar * CCRANDOM_MINUS1_1();
+            endS = MAX(0, endS); // No negative values
+            _particleData.deltaSize[i] = (endS - _particleData.size[i]) / _particleData.timeToLive[i];
+        }
     }
 
     // rotation
-    float startA = _startSpin + _startSpinVar * CCRANDOM_MINUS1_1();
-    float endA = _endSpin + _endSpinVar * CCRANDOM_MINUS1_1();
-    particle->rotation = startA;
-    particle->deltaRotation = (endA - startA) / particle->timeToLive;
+    for (int i = start; i < end; ++i)
+    {
+        float startA = _startSpin + _startSpinVar * CCRANDOM_MINUS1_1();
+        float endA = _endSpin + _endSpinVar * CCRANDOM_MINUS1_1();
+        _particleData.rotation[i] = startA;
+        _particleData.deltaRotation[i] = (endA - startA) / _particleData.timeToLive[i];
+    }
 
     // position
+    Point startPos = Point::ZERO;
     if (_positionType == PositionType::FREE)
     {
-        particle->startPos = this->convertToWorldSpace(Point::ZERO);
+        startPos = this->convertToWorldSpace(Point::ZERO);
     }
     else if (_positionType == PositionType::RELATIVE)
     {
-        particle->startPos = _position;
+        startPos = _position;
+    }
+    for (int i = start; i < end; ++i)
+    {
+        _particleData.startPosX[i] = startPos.x;
+        _particleData.startPosY[i] = startPos.y;
     }
-
-    // direction
-    float a = CC_DEGREES_TO_RADIANS( _angle + _angleVar * CCRANDOM_MINUS1_1() );    
 
     // Mode Gravity: A
     if (_emitterMode == Mode::GRAVITY)
     {
-        Point v(cosf( a ), sinf( a ));
-        float s = modeA.speed + modeA.speedVar * CCRANDOM_MINUS1_1();
-
-        // direction
-        particle->modeA.dir = v * s ;
+        for (int i = start; i < end; ++i)
+        {
+            // direction
+            float a = CC_DEGREES_TO_RADIANS( _angle + _angleVar * CCRANDOM_MINUS1_1() );
+            float s = modeA.speed + modeA.speedVar * CCRANDOM_MINUS1_1();
+            _particleData.modeA.dirX[i] = cosf( a ) * s;
+            _particleData.modeA.dirY[i] = sinf( a ) * s;
+        }
 
         // radial accel
-        particle->modeA.radialAccel = modeA.radialAccel + modeA.radialAccelVar * CCRANDOM_MINUS1_1();
- 
+        for (int i = start; i < end; ++i)
+        {
+            _particleData.modeA.radialAccel[i] = modeA.radialAccel + modeA.radialAccelVar * CCRANDOM_MINUS1_1();
+        }
 
         // tangential accel
-        particle->modeA.tangentialAccel = modeA.tangentialAccel + modeA.tangentialAccelVar * CCRANDOM_MINUS1_1();
+        for (int i = start; i < end; ++i)
+        {
+            _particleData.modeA.tangentialAccel[i] = modeA.tangentialAccel + modeA.tangentialAccelVar * CCRANDOM_MINUS1_1();
+        }
 
         // rotation is dir
         if(modeA.rotationIsDir)
-            particle->rotation = -CC_RADIANS_TO_DEGREES(particle->modeA.dir.getAngle());
+        {
+            for (int i = start; i < end; ++i)
+            {
+                _particleData.rotation[i] = -CC_RADIANS_TO_DEGREES(atan2f(_particleData.modeA.dirY[i], _particleData.modeA.dirX[i]));
+            }
+        }
     }
 
     // Mode Radius: B
     else 
     {
         // Set the default diameter of the particle from the source position
-        float startRadius = modeB.startRadius + modeB.startRadiusVar * CCRANDOM_MINUS1_1();
-        float endRadius = modeB.endRadius + modeB.endRadiusVar * CCRANDOM_MINUS1_1();
+        for (int i = start; i < end; ++i)
+        {
+            _particleData.modeB.angle[i] = CC_DEGREES_TO_RADIANS( _angle + _angleVar * CCRANDOM_MINUS1_1() );
+        }
 
-        particle->modeB.radius = startRadius;
+        for (int i = start; i < end; ++i)
+        {
+            _particleData.modeB.radius[i] = modeB.startRadius + modeB.startRadiusVar * CCRANDOM_MINUS1_1();
+        }
 
         if (modeB.endRadius == START_RADIUS_EQUAL_TO_END_RADIUS)
         {
-            particle->modeB.deltaRadius = 0;
+            for (int i = start; i < end; ++i)
+            {
+                _particleData.modeB.deltaRadius[i] = 0;
+            }
         }
         else
         {
-            particle->modeB.deltaRadius = (endRadius - startRadius) / particle->timeToLive;
+            for (int i = start; i < end; ++i)
+            {
+                float endRadius = modeB.endRadius + modeB.endRadiusVar * CCRANDOM_MINUS1_1();
+                _particleData.modeB.deltaRadius[i] = (endRadius - _particleData.modeB.radius[i]) / _particleData.timeToLive[i];
+            }
         }
 
-        particle->modeB.angle = a;
-        particle->modeB.degreesPerSecond = CC_DEGREES_TO_RADIANS(modeB.rotatePerSecond + modeB.rotatePerSecondVar * CCRANDOM_MINUS1_1());
-    }    
+        for (int i = start; i < end; ++i)
+        {
+            _particleData.modeB.degreesPerSecond[i] = CC_DEGREES_TO_RADIANS(modeB.rotatePerSecond + modeB.rotatePerSecondVar * CCRANDOM_MINUS1_1());
+        }
+    }
+
+    _particleCount = end;
 }
 
 void ParticleSystem::stopSystem()
@@ -621,13 +882,15 @@ void ParticleSystem::stopSystem()
 
 void ParticleSystem::resetSystem()
 {
+    finishSimulation();
+
     _isActive = true;
     _elapsed = 0;
-    for (_particleIdx = 0; _particleIdx < _particleCount; ++_particleIdx)
+    for (int i = 0; i < _particleCount; ++i)
     {
-        tParticle *p = &_particles[_particleIdx];
-        p->timeToLive = 0;
+        _particleData.timeToLive[i] = 0;
     }
+    _particleIdx = _particleCount;
 }
 bool ParticleSystem::isFull()
 {
@@ -639,6 +902,8 @@ void ParticleSystem::update(float dt)
 {
     CC_PROFILER_START_CATEGORY(kProfilerCategoryParticles , "CCParticleSystem - update");
 
+    finishSimulation();
+
     if (_isActive && _emissionRate)
     {
         float rate = 1.0f / _emissionRate;
@@ -648,11 +913,16 @@ void ParticleSystem::update(float dt)
             _emitCounter += dt;
         }
         
-        while (_particleCount < _totalParticles && _emitCounter > rate) 
+        int emitCount = 0;
+        while (_particleCount + emitCount < _totalParticles && _emitCounter > rate) 
         {
-            this->addParticle();
+            ++emitCount;
             _emitCounter -= rate;
         }
+        if (emitCount > 0)
+        {
+            this->addParticles(emitCount);
+        }
 
         _elapsed += dt;
         if (_duration != -1 && _duration < _elapsed)
@@ -661,165 +931,228 @@ void ParticleSystem::update(float dt)
         }
     }
 
-    _particleIdx = 0;
-
-    Point currentPosition = Point::ZERO;
-    if (_positionType == PositionType::FREE)
-    {
-        currentPosition = this->convertToWorldSpace(Point::ZERO);
-    }
-    else if (_positionType == PositionType::RELATIVE)
-    {
-        currentPosition = _position;
-    }
-
     if (_visible)
     {
-        while (_particleIdx < _particleCount)
+        // life
+        for (int i = 0; i < _particleCount; ++i)
         {
-            tParticle *p = &_particles[_particleIdx];
+            _particleData.timeToLive[i] -= dt;
+        }
 
-            // life
-            p->timeToLive -= dt;
+        // remove the dead particles by moving the last one in their slot
+        for (int i = 0; i < _particleCount; )
+        {
+            if (_particleData.timeToLive[i] > 0)
+            {
+                ++i;
+                continue;
+            }
 
-            if (p->timeToLive > 0) 
+            // life < 0
+            int currentIndex = _particleData.atlasIndex[i];
+            if( i != _particleCount-1 )
             {
-                // Mode A: gravity, direction, tangential accel & radial accel
-                if (_emitterMode == Mode::GRAVITY)
-                {
-                    Point tmp, radial, tangential;
+                _particleData.copyParticle(i, _particleCount-1);
+            }
+            if (_batchNode)
+            {
+                //disable the switched particle
+                _batchNode->disableParticle(_atlasIndex+currentIndex);
 
-                    radial = Point::ZERO;
-                    // radial acceleration
-                    if (p->pos.x || p->pos.y)
-                    {
-                        radial = p->pos.normalize();
-                    }
-                    tangential = radial;
-                    radial = radial * p->modeA.radialAccel;
-
-                    // tangential acceleration
-                    float newy = tangential.x;
-                    tangential.x = -tangential.y;
-                    tangential.y = newy;
-                    tangential = tangential * p->modeA.tangentialAccel;
-
-                    // (gravity + radial + tangential) * dt
-                    tmp = radial + tangential + modeA.gravity;
-                    tmp = tmp * dt;
-                    p->modeA.dir = p->modeA.dir + tmp;
-					if (_configName.length()>0)
-					{
-						if (_yCoordFlipped == -1)
-						{
-							 tmp = p->modeA.dir * dt;
-						}
-						else
-						{
-							 tmp = p->modeA.dir * -dt;
-						}
-					}
-					else
-					{
-						 tmp = p->modeA.dir * dt;
-					}
-                    p->pos = p->pos + tmp;
-                }
+                //switch indexes
+                _particleData.atlasIndex[_particleCount-1] = currentIndex;
+            }
 
-                // Mode B: radius movement
-                else 
-                {                
-                    // Update the angle and radius of the particle.
-                    p->modeB.angle += p->modeB.degreesPerSecond * dt;
-                    p->modeB.radius += p->modeB.deltaRadius * dt;
+            --_particleCount;
 
-                    p->pos.x = - cosf(p->modeB.angle) * p->modeB.radius;
-                    p->pos.y = - sinf(p->modeB.angle) * p->modeB.radius;
-                    if (_yCoordFlipped == 1)
-                    {
-                      p->pos.y = -p->pos.y;
-                    }
-				}
+            if( _particleCount == 0 && _isAutoRemoveOnFinish )
+            {
+                this->unscheduleUpdate();
+                _parent->removeChild(this, true);
+                return;
+            }
+        }
 
-                // color
-                p->color.r += (p->deltaColor.r * dt);
-                p->color.g += (p->deltaColor.g * dt);
-                p->color.b += (p->deltaColor.b * dt);
-                p->color.a += (p->deltaColor.a * dt);
+        // the integration only uses the particle arrays and _step, so it can run on a worker thread
+        _step.dt = dt;
+        _step.emitterMode = _emitterMode;
+        _step.gravity = modeA.gravity;
+        // particles loaded from a Particle Designer file move along -dir unless the y axis is flipped
+        _step.positionDt = (_configName.length() > 0 && _yCoordFlipped != -1) ? -dt : dt;
+        _step.radiusFlipY = (_yCoordFlipped == 1) ? 1.0f : -1.0f;
+        _step.relativePosition = (_positionType == PositionType::FREE || _positionType == PositionType::RELATIVE);
+        _step.currentPosition = Point::ZERO;
+        if (_positionType == PositionType::FREE)
+        {
+            _step.currentPosition = this->convertToWorldSpace(Point::ZERO);
+        }
+        else if (_positionType == PositionType::RELATIVE)
+        {
+            _step.currentPosition = _position;
+        }
+        _step.quadOffset = _batchNode ? _position : Point::ZERO;
+        _step.opacityModifyRGB = _opacityModifyRGB;
 
-                // size
-                p->size += (p->deltaSize * dt);
-                p->size = MAX( 0, p->size );
+        if (s_parallelSimulation && !_batchNode && _particleCount > 0)
+        {
+            // released by finishSimulation()
+            this->retain();
+            _simulationPending = true;
+            ParticleSimulationPool::getInstance()->submit(this);
+        }
+        else
+        {
+            simulate();
+        }
 
-                // angle
-                p->rotation += (p->deltaRotation * dt);
+        _particleIdx = _particleCount;
+        _transformSystemDirty = false;
+    }
+    if (! _batchNode && ! _simulationPending)
+    {
+        postStep();
+    }
 
-                //
-                // update values in quad
-                //
+    CC_PROFILER_STOP_CATEGORY(kProfilerCategoryParticles , "CCParticleSystem - update");
+}
 
-                Point    newPos;
+void ParticleSystem::simulate()
+{
+    const float dt = _step.dt;
 
-                if (_positionType == PositionType::FREE || _positionType == PositionType::RELATIVE)
-                {
-                    Point diff = currentPosition - p->startPos;
-                    newPos = p->pos - diff;
-                } 
-                else
-                {
-                    newPos = p->pos;
-                }
+    // the loops below have no branch nor call on the particle values so they can be vectorized
+    const int count = _particleCount;
 
-                // translate newPos to correct position, since matrix transform isn't performed in batchnode
-                // don't update the particle with the new position information, it will interfere with the radius and tangential calculations
-                if (_batchNode)
-                {
-                    newPos.x+=_position.x;
-                    newPos.y+=_position.y;
-                }
+    // Mode A: gravity, direction, tangential accel & radial accel
+    if (_step.emitterMode == Mode::GRAVITY)
+    {
+        float* __restrict posx = _particleData.posx;
+        float* __restrict posy = _particleData.posy;
+        float* __restrict dirX = _particleData.modeA.dirX;
+        float* __restrict dirY = _particleData.modeA.dirY;
+        const float* __restrict radialAccel = _particleData.modeA.radialAccel;
+        const float* __restrict tangentialAccel = _particleData.modeA.tangentialAccel;
+
+        const float gravityX = _step.gravity.x * dt;
+        const float gravityY = _step.gravity.y * dt;
+        const float posDt = _step.positionDt;
+
+        for (int i = 0; i < count; ++i)
+        {
+            // radial acceleration, along the normalized position (zero at the origin)
+            float lengthSQ = posx[i] * posx[i] + posy[i] * posy[i];
+            float invLength = lengthSQ > 0 ? 1.0f / sqrtf(lengthSQ) : 0.0f;
+            float radialX = posx[i] * invLength;
+            float radialY = posy[i] * invLength;
+
+            // tangential acceleration, perpendicular to the radial one
+            // (gravity + radial + tangential) * dt
+            float radial = radialAccel[i] * dt;
+            float tangential = tangentialAccel[i] * dt;
+            dirX[i] += radialX * radial - radialY * tangential + gravityX;
+            dirY[i] += radialY * radial + radialX * tangential + gravityY;
+
+            posx[i] += dirX[i] * posDt;
+            posy[i] += dirY[i] * posDt;
+        }
+    }
 
-                updateQuadWithParticle(p, newPos);
-                //updateParticleImp(self, updateParticleSel, p, newPos);
+    // Mode B: radius movement
+    else 
+    {
+        float* __restrict posx = _particleData.posx;
+        float* __restrict posy = _particleData.posy;
+        float* __restrict angle = _particleData.modeB.angle;
+        float* __restrict radius = _particleData.modeB.radius;
+        const float* __restrict degreesPerSecond = _particleData.modeB.degreesPerSecond;
+        const float* __restrict deltaRadius = _particleData.modeB.deltaRadius;
 
-                // update particle counter
-                ++_particleIdx;
-            } 
-            else 
-            {
-                // life < 0
-                int currentIndex = p->atlasIndex;
-                if( _particleIdx != _particleCount-1 )
-                {
-                    _particles[_particleIdx] = _particles[_particleCount-1];
-                }
-                if (_batchNode)
-                {
-                    //disable the switched particle
-                    _batchNode->disableParticle(_atlasIndex+currentIndex);
+        const float flipY = _step.radiusFlipY;
 
-                    //switch indexes
-                    _particles[_particleCount-1].atlasIndex = currentIndex;
-                }
+        // Update the angle and radius of the particle.
+        for (int i = 0; i < count; ++i)
+        {
+            angle[i] += degreesPerSecond[i] * dt;
+            radius[i] += deltaRadius[i] * dt;
+        }
+
+        for (int i = 0; i < count; ++i)
+        {
+            posx[i] = - cosf(angle[i]) * radius[i];
+            posy[i] = flipY * sinf(angle[i]) * radius[i];
+        }
+    }
+
+    // color
+    for (int i = 0; i < count; ++i)
+    {
+        _particleData.colorR[i] += _particleData.deltaColorR[i] * dt;
+    }
+    for (int i = 0; i < count; ++i)
+    {
+        _particleData.colorG[i] += _particleData.deltaColorG[i] * dt;
+    }
+    for (int i = 0; i < count; ++i)
+    {
+        _particleData.colorB[i] += _particleData.deltaColorB[i] * dt;
+    }
+    for (int i = 0; i < count; ++i)
+    {
+        _particleData.colorA[i] += _particleData.deltaColorA[i] * dt;
+    }
 
+    // size
+    for (int i = 0; i < count; ++i)
+    {
+        float size = _particleData.size[i] + _particleData.deltaSize[i] * dt;
+        _particleData.size[i] = size > 0 ? size : 0;
+    }
 
-                --_particleCount;
+    // angle
+    for (int i = 0; i < count; ++i)
+    {
+        _particleData.rotation[i] += _particleData.deltaRotation[i] * dt;
+    }
 
-                if( _particleCount == 0 && _isAutoRemoveOnFinish )
-                {
-                    this->unscheduleUpdate();
-                    _parent->removeChild(this, true);
-                    return;
-                }
-            }
-        } //while
-        _transformSystemDirty = false;
+    //
+    // update values in quad
+    //
+    updateParticleQuads();
+}
+
+void ParticleSystem::finishSimulation()
+{
+    if (! _simulationPending)
+    {
+        return;
     }
+
+    ParticleSimulationPool::getInstance()->wait(this);
+    _simulationPending = false;
+
     if (! _batchNode)
     {
         postStep();
     }
 
-    CC_PROFILER_STOP_CATEGORY(kProfilerCategoryParticles , "CCParticleSystem - update");
+    // retained by update(). The owner may have released the system meanwhile, so don't delete it while it is in use
+    this->autorelease();
+}
+
+void ParticleSystem::setParallelSimulationEnabled(bool enabled)
+{
+    s_parallelSimulation = enabled;
+}
+
+bool ParticleSystem::isParallelSimulationEnabled()
+{
+    return s_parallelSimulation;
+}
+
+void ParticleSystem::onExit()
+{
+    finishSimulation();
+    Node::onExit();
 }
 
 void ParticleSystem::updateWithNoTime(void)
@@ -827,10 +1160,8 @@ void ParticleSystem::updateWithNoTime(void)
     this->update(0.0f);
 }
 
-void ParticleSystem::updateQuadWithParticle(tParticle* particle, const Point& newPosition)
+void ParticleSystem::updateParticleQuads()
 {
-    CC_UNUSED_PARAM(particle);
-    CC_UNUSED_PARAM(newPosition);
     // should be overridden
 }
 
@@ -1083,6 +1414,8 @@ int ParticleSystem::getTotalParticles() const
 
 void ParticleSystem::setTotalParticles(int var)
 {
+    finishSimulation();
+
     CCASSERT( var <= _allocatedParticles, "Particle: resizing particle array only supported for quads");
     _totalParticles = var;
 }
@@ -1120,6 +1453,8 @@ ParticleBatchNode* ParticleSystem::getBatchNode(void) const
 
 void ParticleSystem::setBatchNode(ParticleBatchNode* batchNode)
 {
+    finishSimulation();
+
     if( _batchNode != batchNode ) {
 
         _batchNode = batchNode; // weak reference
@@ -1128,7 +1463,7 @@ void ParticleSystem::setBatchNode(ParticleBatchNode* batchNode)
             //each particle needs a unique index
             for (int i = 0; i < _totalParticles; i++)
             {
-                _particles[i].atlasIndex=i;
+                _particleData.atlasIndex[i] = i;
             }
         }
     }
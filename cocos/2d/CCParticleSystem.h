@@ -39,45 +39,83 @@ NS_CC_BEGIN
  */
 
 class ParticleBatchNode;
+class ParticleSimulationPool;
 
 /**
-Structure that contains the values of each particle
+Values of all the particles of a system, stored as one array per attribute (structure of arrays),
+so that the update loops walk contiguous memory and can be vectorized by the compiler.
+The particle i is made of posx[i], posy[i], colorR[i]...
+@since v3.0
 */
-typedef struct sParticle {
-    Point     pos;
-    Point     startPos;
+class CC_DLL ParticleData
+{
+public:
+    float* posx;
+    float* posy;
+    float* startPosX;
+    float* startPosY;
+
+    float* colorR;
+    float* colorG;
+    float* colorB;
+    float* colorA;
 
-    Color4F    color;
-    Color4F    deltaColor;
+    float* deltaColorR;
+    float* deltaColorG;
+    float* deltaColorB;
+    float* deltaColorA;
 
-    float        size;
-    float        deltaSize;
+    float* size;
+    float* deltaSize;
 
-    float        rotation;
-    float        deltaRotation;
+    float* rotation;
+    float* deltaRotation;
 
-    float        timeToLive;
+    float* timeToLive;
 
-    unsigned int    atlasIndex;
+    unsigned int* atlasIndex;
 
     //! Mode A: gravity, direction, radial accel, tangential accel
     struct {
-        Point        dir;
-        float        radialAccel;
-        float        tangentialAccel;
+        float* dirX;
+        float* dirY;
+        float* radialAccel;
+        float* tangentialAccel;
     } modeA;
 
     //! Mode B: radius mode
     struct {
-        float        angle;
-        float        degreesPerSecond;
-        float        radius;
-        float        deltaRadius;
+        float* angle;
+        float* degreesPerSecond;
+        float* radius;
+        float* deltaRadius;
     } modeB;
 
-}tParticle;
+    ParticleData();
+    ~ParticleData();
+
+    /** allocates (zeroed) room for count particles. Previous values are lost */
+    bool init(int count);
+    /** frees the arrays */
+    void release();
+    inline int getMaxCount() const { return _maxCount; }
+
+    /** copies the particle src over the particle dst */
+    void copyParticle(int dst, int src);
+
+private:
+    ParticleData(const ParticleData&);
+    ParticleData& operator=(const ParticleData&);
 
-//typedef void (*CC_UPDATE_PARTICLE_IMP)(id, SEL, tParticle*, Point);
+    //! number of float arrays above
+    enum { FLOAT_ARRAYS = 25 };
+    //! points the arrays into block, which holds count values for each one, or to NULL
+    void setArrays(float* block, int count);
+
+    //! all the arrays live in this block
+    void* _buffer;
+    int _maxCount;
+};
 
 class Texture2D;
 
@@ -171,6 +209,21 @@ public:
 
     //! create a system with a fixed number of particles
     static ParticleSystem* createWithTotalParticles(unsigned int numberOfParticles);
+
+    /** Enables or disables the parallel simulation of the particle systems. Disabled by default.
+
+     When enabled, each emitter still emits its new particles on the main thread, in the scheduler order, so the emission
+     stays deterministic when the random seed is fixed. The integration of its particles and the update of its quads then run
+     as a job on a pool of worker threads, which is waited for before the emitter is drawn or its particles are changed.
+     Emitters rendered by a ParticleBatchNode share the atlas of the batch node and are always simulated on the main thread.
+     @since v3.0
+     */
+    static void setParallelSimulationEnabled(bool enabled);
+    /** whether the particle systems are simulated on worker threads
+     @since v3.0
+     */
+    static bool isParallelSimulationEnabled();
+
     /**
      * @js ctor
      */
@@ -205,17 +258,26 @@ public:
 
     //! Add a particle to the emitter
     bool addParticle();
-    //! Initializes a particle
-    void initParticle(tParticle* particle);
+    /** Adds and initializes count particles at the end of the particle arrays. The caller has to check there is room for them
+     @since v3.0
+     */
+    void addParticles(int count);
     //! stop emitting particles. Running particles will continue to run until they die
     void stopSystem();
     //! Kill all living particles.
     void resetSystem();
     //! whether or not the system is full
     bool isFull();
+    /** waits for the parallel simulation of the last update, if it is still running. The system is ready to be drawn or changed afterwards
+     @since v3.0
+     */
+    void finishSimulation();
 
-    //! should be overridden by subclasses
-    virtual void updateQuadWithParticle(tParticle* particle, const Point& newPosition);
+    /** updates the quads of all the living particles from the values of _step, called once per update. Should be overridden by subclasses.
+     It is called on a worker thread when the simulation is parallel, so it must only change the quads of this system.
+     @since v3.0
+     */
+    virtual void updateParticleQuads();
     //! should be overridden by subclasses
     virtual void postStep();
 
@@ -377,6 +439,7 @@ public:
     inline void setPositionType(PositionType type) { _positionType = type; };
     
     // Overrides
+    virtual void onExit() override;
     virtual void update(float dt) override;
     virtual Texture2D* getTexture() const override;
     virtual void setTexture(Texture2D *texture) override;
@@ -396,7 +459,36 @@ public:
 protected:
     virtual void updateBlendFunc();
 
+    //! integrates the living particles and updates their quads with the values of _step. Runs on a worker thread when the simulation is parallel
+    void simulate();
+
+    friend class ParticleSimulationPool;
+
 protected:
+    /** values used by simulate(), copied from the system on the main thread so that the simulation
+     doesn't read properties which can be changed while it runs
+     */
+    struct SimulationStep
+    {
+        float dt;
+        Mode emitterMode;
+        Point gravity;
+        //! dt, negated when the particles move along -dir
+        float positionDt;
+        //! -1 or 1, sign of the y position in radius mode
+        float radiusFlipY;
+        //! whether the quads are positioned relative to the start position of the particles
+        bool relativePosition;
+        //! position of the emitter used when relativePosition is true
+        Point currentPosition;
+        //! offset added to the quads, since the matrix transform isn't performed in batchnode
+        Point quadOffset;
+        bool opacityModifyRGB;
+    } _step;
+
+    //! whether a simulation job of the system is queued or running
+    bool _simulationPending;
+
     /** whether or not the particles are using blend additive.
      If enabled, the following blending function will be used.
      @code
@@ -453,8 +545,8 @@ protected:
         float rotatePerSecondVar;
     } modeB;
 
-    //! Array of particles
-    tParticle *_particles;
+    //! Particles values
+    ParticleData _particleData;
 
     //Emitter name
     std::string _configName;
@@ -468,10 +560,6 @@ protected:
     //!  particle idx
     int _particleIdx;
 
-    // Optimization
-    //CC_UPDATE_PARTICLE_IMP    updateParticleImp;
-    //SEL                        updateParticleSel;
-
     /** weak reference to the SpriteBatchNode that renders the Sprite */
     ParticleBatchNode* _batchNode;
 
@@ -37,6 +37,7 @@ THE SOFTWARE.
 #include "TransformUtils.h"
 #include "CCNotificationCenter.h"
 #include "CCEventType.h"
+#include "CCRenderer.h"
 
 // extern
 #include "kazmath/GL/matrix.h"
@@ -86,6 +87,7 @@ ParticleSystemQuad::ParticleSystemQuad()
 #endif
 {
     memset(_buffersVBO, 0, sizeof(_buffersVBO));
+    _customCommand.func = CC_CALLBACK_0(ParticleSystemQuad::onDraw, this);
 }
 
 ParticleSystemQuad::~ParticleSystemQuad()
@@ -135,6 +137,8 @@ ParticleSystemQuad * ParticleSystemQuad::createWithTotalParticles(unsigned int n
 // pointRect should be in Texture coordinates, not pixel coordinates
 void ParticleSystemQuad::initTexCoordsWithRect(const Rect& pointRect)
 {
+    finishSimulation();
+
     // convert to Tex coords
 
     Rect rect = Rect(
@@ -241,85 +245,119 @@ void ParticleSystemQuad::initIndices()
     }
 }
 
-void ParticleSystemQuad::updateQuadWithParticle(tParticle* particle, const Point& newPosition)
+void ParticleSystemQuad::updateParticleQuads()
 {
-    V3F_C4B_T2F_Quad *quad;
+    if (_particleCount <= 0)
+    {
+        return;
+    }
+
+    // the positions are translated by _step.quadOffset in batchnode.
+    // don't update the particles with the new position information, it will interfere with the radius and tangential calculations
+    const Point& currentPosition = _step.currentPosition;
+    const Point& offset = _step.quadOffset;
+    const bool relative = _step.relativePosition;
 
+    V3F_C4B_T2F_Quad *startQuad;
+    const unsigned int *atlasIndex = NULL;
     if (_batchNode)
     {
-        V3F_C4B_T2F_Quad *batchQuads = _batchNode->getTextureAtlas()->getQuads();
-        quad = &(batchQuads[_atlasIndex+particle->atlasIndex]);
+        startQuad = &(_batchNode->getTextureAtlas()->getQuads()[_atlasIndex]);
+        atlasIndex = _particleData.atlasIndex;
     }
     else
     {
-        quad = &(_quads[_particleIdx]);
+        startQuad = _quads;
     }
-    Color4B color = (_opacityModifyRGB)
-        ? Color4B( particle->color.r*particle->color.a*255, particle->color.g*particle->color.a*255, particle->color.b*particle->color.a*255, particle->color.a*255)
-        : Color4B( particle->color.r*255, particle->color.g*255, particle->color.b*255, particle->color.a*255);
 
-    quad->bl.colors = color;
-    quad->br.colors = color;
-    quad->tl.colors = color;
-    quad->tr.colors = color;
-
-    // vertices
-    GLfloat size_2 = particle->size/2;
-    if (particle->rotation) 
+    const float *posx = _particleData.posx;
+    const float *posy = _particleData.posy;
+    const float *startPosX = _particleData.startPosX;
+    const float *startPosY = _particleData.startPosY;
+    const float *size = _particleData.size;
+    const float *rotation = _particleData.rotation;
+    const float *colorR = _particleData.colorR;
+    const float *colorG = _particleData.colorG;
+    const float *colorB = _particleData.colorB;
+    const float *colorA = _particleData.colorA;
+
+    for (int i = 0; i < _particleCount; ++i)
     {
-        GLfloat x1 = -size_2;
-        GLfloat y1 = -size_2;
-
-        GLfloat x2 = size_2;
-        GLfloat y2 = size_2;
-        GLfloat x = newPosition.x;
-        GLfloat y = newPosition.y;
-
-        GLfloat r = (GLfloat)-CC_DEGREES_TO_RADIANS(particle->rotation);
-        GLfloat cr = cosf(r);
-        GLfloat sr = sinf(r);
-        GLfloat ax = x1 * cr - y1 * sr + x;
-        GLfloat ay = x1 * sr + y1 * cr + y;
-        GLfloat bx = x2 * cr - y1 * sr + x;
-        GLfloat by = x2 * sr + y1 * cr + y;
-        GLfloat cx = x2 * cr - y2 * sr + x;
-        GLfloat cy = x2 * sr + y2 * cr + y;
-        GLfloat dx = x1 * cr - y2 * sr + x;
-        GLfloat dy = x1 * sr + y2 * cr + y;
-
-        // bottom-left
-        quad->bl.vertices.x = ax;
-        quad->bl.vertices.y = ay;
+        V3F_C4B_T2F_Quad *quad = atlasIndex ? &startQuad[atlasIndex[i]] : &startQuad[i];
 
-        // bottom-right vertex:
-        quad->br.vertices.x = bx;
-        quad->br.vertices.y = by;
+        Color4B color = (_step.opacityModifyRGB)
+            ? Color4B( colorR[i]*colorA[i]*255, colorG[i]*colorA[i]*255, colorB[i]*colorA[i]*255, colorA[i]*255)
+            : Color4B( colorR[i]*255, colorG[i]*255, colorB[i]*255, colorA[i]*255);
 
-        // top-left vertex:
-        quad->tl.vertices.x = dx;
-        quad->tl.vertices.y = dy;
+        quad->bl.colors = color;
+        quad->br.colors = color;
+        quad->tl.colors = color;
+        quad->tr.colors = color;
 
-        // top-right vertex:
-        quad->tr.vertices.x = cx;
-        quad->tr.vertices.y = cy;
-    } 
-    else 
-    {
-        // bottom-left vertex:
-        quad->bl.vertices.x = newPosition.x - size_2;
-        quad->bl.vertices.y = newPosition.y - size_2;
+        GLfloat x = posx[i] + offset.x;
+        GLfloat y = posy[i] + offset.y;
+        if (relative)
+        {
+            x -= currentPosition.x - startPosX[i];
+            y -= currentPosition.y - startPosY[i];
+        }
 
-        // bottom-right vertex:
-        quad->br.vertices.x = newPosition.x + size_2;
-        quad->br.vertices.y = newPosition.y - size_2;
+        // vertices
+        GLfloat size_2 = size[i]/2;
+        if (rotation[i]) 
+        {
+            GLfloat x1 = -size_2;
+            GLfloat y1 = -size_2;
+
+            GLfloat x2 = size_2;
+            GLfloat y2 = size_2;
+
+            GLfloat r = (GLfloat)-CC_DEGREES_TO_RADIANS(rotation[i]);
+            GLfloat cr = cosf(r);
+            GLfloat sr = sinf(r);
+            GLfloat ax = x1 * cr - y1 * sr + x;
+            GLfloat ay = x1 * sr + y1 * cr + y;
+            GLfloat bx = x2 * cr - y1 * sr + x;
+            GLfloat by = x2 * sr + y1 * cr + y;
+            GLfloat cx = x2 * cr - y2 * sr + x;
+            GLfloat cy = x2 * sr + y2 * cr + y;
+            GLfloat dx = x1 * cr - y2 * sr + x;
+            GLfloat dy = x1 * sr + y2 * cr + y;
+
+            // bottom-left
+            quad->bl.vertices.x = ax;
+            quad->bl.vertices.y = ay;
+
+            // bottom-right vertex:
+            quad->br.vertices.x = bx;
+            quad->br.vertices.y = by;
+
+            // top-left vertex:
+            quad->tl.vertices.x = dx;
+            quad->tl.vertices.y = dy;
+
+            // top-right vertex:
+            quad->tr.vertices.x = cx;
+            quad->tr.vertices.y = cy;
+        } 
+        else 
+        {
+            // bottom-left vertex:
+            quad->bl.vertices.x = x - size_2;
+            quad->bl.vertices.y = y - size_2;
 
-        // top-left vertex:
-        quad->tl.vertices.x = newPosition.x - size_2;
-        quad->tl.vertices.y = newPosition.y + size_2;
+            // bottom-right vertex:
+            quad->br.vertices.x = x + size_2;
+            quad->br.vertices.y = y - size_2;
 
-        // top-right vertex:
-        quad->tr.vertices.x = newPosition.x + size_2;
-        quad->tr.vertices.y = newPosition.y + size_2;                
+            // top-left vertex:
+            quad->tl.vertices.x = x - size_2;
+            quad->tl.vertices.y = y + size_2;
+
+            // top-right vertex:
+            quad->tr.vertices.x = x + size_2;
+            quad->tr.vertices.y = y + size_2;                
+        }
     }
 }
 void ParticleSystemQuad::postStep()
@@ -328,6 +366,7 @@ void ParticleSystemQuad::postStep()
 	
 	// Option 1: Sub Data
     glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(_quads[0])*_totalParticles, _quads);
+    CC_INCREMENT_GL_UPLOADED_BYTES(sizeof(_quads[0])*_totalParticles);
 	
 	// Option 2: Data
     //	glBufferData(GL_ARRAY_BUFFER, sizeof(quads_[0]) * particleCount, quads_, GL_DYNAMIC_DRAW);
@@ -348,6 +387,14 @@ void ParticleSystemQuad::draw()
 {    
     CCASSERT(!_batchNode,"draw should not be called when added to a particleBatchNode");
 
+    _customCommand.init(_modelViewTransform);
+    Director::getInstance()->getRenderer()->addCommand(&_customCommand);
+}
+
+void ParticleSystemQuad::onDraw()
+{
+    finishSimulation();
+
     CC_NODE_DRAW_SETUP();
 
     GL::bindTexture2D( _texture->getName() );
@@ -403,29 +450,29 @@ void ParticleSystemQuad::draw()
 
 void ParticleSystemQuad::setTotalParticles(int tp)
 {
+    finishSimulation();
+
     // If we are setting the total number of particles to a number higher
     // than what is allocated, we need to allocate new arrays
     if( tp > _allocatedParticles )
     {
         // Allocate new memory
-        size_t particlesSize = tp * sizeof(tParticle);
         size_t quadsSize = sizeof(_quads[0]) * tp * 1;
         size_t indicesSize = sizeof(_indices[0]) * tp * 6 * 1;
 
-        tParticle* particlesNew = (tParticle*)realloc(_particles, particlesSize);
+        // the particles are reset below, so their values don't need to be kept
+        bool particlesAllocated = _particleData.init(tp);
         V3F_C4B_T2F_Quad* quadsNew = (V3F_C4B_T2F_Quad*)realloc(_quads, quadsSize);
         GLushort* indicesNew = (GLushort*)realloc(_indices, indicesSize);
 
-        if (particlesNew && quadsNew && indicesNew)
+        if (particlesAllocated && quadsNew && indicesNew)
         {
             // Assign pointers
-            _particles = particlesNew;
             _quads = quadsNew;
             _indices = indicesNew;
 
             // Clear the memory
             // XXX: Bug? If the quads are cleared, then drawing doesn't work... WHY??? XXX
-            memset(_particles, 0, particlesSize);
             memset(_quads, 0, quadsSize);
             memset(_indices, 0, indicesSize);
 
@@ -434,7 +481,7 @@ void ParticleSystemQuad::setTotalParticles(int tp)
         else
         {
             // Out of memory, failed to resize some array
-            if (particlesNew) _particles = particlesNew;
+            if (!particlesAllocated) _particleData.init(_allocatedParticles);
             if (quadsNew) _quads = quadsNew;
             if (indicesNew) _indices = indicesNew;
 
@@ -449,7 +496,7 @@ void ParticleSystemQuad::setTotalParticles(int tp)
         {
             for (int i = 0; i < _totalParticles; i++)
             {
-                _particles[i].atlasIndex=i;
+                _particleData.atlasIndex[i] = i;
             }
         }
 
@@ -531,6 +578,8 @@ void ParticleSystemQuad::setupVBO()
 
 void ParticleSystemQuad::listenBackToForeground(Object *obj)
 {
+    finishSimulation();
+
 #if CC_TEXTURE_ATLAS_USE_VAO
         setupVBOandVAO();
 #else
@@ -566,6 +615,8 @@ bool ParticleSystemQuad::allocMemory()
 
 void ParticleSystemQuad::setBatchNode(ParticleBatchNode * batchNode)
 {
+    finishSimulation();
+
     if( _batchNode != batchNode ) 
     {
         ParticleBatchNode* oldBatch = _batchNode;
@@ -28,6 +28,7 @@ THE SOFTWARE.
 #define __CC_PARTICLE_SYSTEM_QUAD_H__
 
 #include  "CCParticleSystem.h"
+#include "CCCustomCommand.h"
 
 NS_CC_BEGIN
 
@@ -112,7 +113,7 @@ public:
      * @js NA
      * @lua NA
      */
-    virtual void updateQuadWithParticle(tParticle* particle, const Point& newPosition) override;
+    virtual void updateParticleQuads() override;
     /**
      * @js NA
      * @lua NA
@@ -141,6 +142,7 @@ private:
     void setupVBO();
 #endif
     bool allocMemory();
+    void onDraw();
     
 protected:
     V3F_C4B_T2F_Quad    *_quads;        // quads to be rendered
@@ -151,6 +153,8 @@ protected:
 #endif
     
     GLuint                _buffersVBO[2]; //0: vertex  1: indices
+
+    CustomCommand         _customCommand;
 };
 
 // end of particle_nodes group
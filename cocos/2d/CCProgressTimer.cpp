@@ -32,6 +32,7 @@ THE SOFTWARE.
 #include "CCDirector.h"
 #include "TransformUtils.h"
 #include "CCDrawingPrimitives.h"
+#include "CCRenderer.h"
 // extern
 #include "kazmath/GL/matrix.h"
 
@@ -53,7 +54,9 @@ ProgressTimer::ProgressTimer()
 ,_vertexDataCount(0)
 ,_vertexData(NULL)
 ,_reverseDirection(false)
-{}
+{
+    _customCommand.func = CC_CALLBACK_0(ProgressTimer::onDraw, this);
+}
 
 ProgressTimer* ProgressTimer::create(Sprite* sp)
 {
@@ -502,6 +505,12 @@ void ProgressTimer::draw(void)
     if( ! _vertexData || ! _sprite)
         return;
 
+    _customCommand.init(_modelViewTransform);
+    Director::getInstance()->getRenderer()->addCommand(&_customCommand);
+}
+
+void ProgressTimer::onDraw()
+{
     CC_NODE_DRAW_SETUP();
 
     GL::blendFunc( _sprite->getBlendFunc().src, _sprite->getBlendFunc().dst );
@@ -26,6 +26,7 @@ THE SOFTWARE.
 #define __MISC_NODE_CCPROGRESS_TIMER_H__
 
 #include "CCSprite.h"
+#include "CCCustomCommand.h"
 #ifdef EMSCRIPTEN
 #include "CCGLBufferedNode.h"
 #endif // EMSCRIPTEN
@@ -129,6 +130,7 @@ public:
     virtual void setOpacity(GLubyte opacity) override;
     
 protected:
+    void onDraw();
     Tex2F textureCoordFromAlphaPoint(Point alpha);
     Vertex2F vertexFromAlphaPoint(Point alpha);
     void updateProgress(void);
@@ -146,6 +148,8 @@ protected:
     V2F_C4B_T2F *_vertexData;
 
     bool _reverseDirection;
+
+    CustomCommand _customCommand;
 };
 
 // end of misc_nodes group
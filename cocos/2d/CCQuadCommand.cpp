@@ -0,0 +1,73 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+ 
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "CCQuadCommand.h"
+#include "CCGLProgram.h"
+#include "ccGLStateCache.h"
+
+NS_CC_BEGIN
+
+QuadCommand::QuadCommand()
+: RenderCommand(Type::QUAD_COMMAND)
+, _textureID(0)
+, _shader(nullptr)
+, _blendType(BlendFunc::DISABLE)
+, _quads(nullptr)
+, _quadCount(0)
+{
+    kmMat4Identity(&_mv);
+}
+
+QuadCommand::~QuadCommand()
+{
+}
+
+void QuadCommand::init(GLuint textureID, GLProgram* shader, const BlendFunc& blendType, V3F_C4B_T2F_Quad* quads, long quadCount, const kmMat4& mv)
+{
+    _textureID = textureID;
+    _shader = shader;
+    _blendType = blendType;
+    _quads = quads;
+    _quadCount = quadCount;
+    kmMat4Assign(&_mv, &mv);
+}
+
+void QuadCommand::useMaterial() const
+{
+    _shader->use();
+
+    GL::bindTexture2D(_textureID);
+    GL::blendFunc(_blendType.src, _blendType.dst);
+}
+
+bool QuadCommand::hasSameMaterial(const QuadCommand* other) const
+{
+    return _textureID == other->_textureID
+        && _shader == other->_shader
+        && _blendType.src == other->_blendType.src
+        && _blendType.dst == other->_blendType.dst;
+}
+
+NS_CC_END
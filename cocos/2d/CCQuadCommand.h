@@ -0,0 +1,88 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+ 
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CCQUADCOMMAND_H__
+#define __CCQUADCOMMAND_H__
+
+#include "CCRenderCommand.h"
+#include "ccTypes.h"
+#include "CCGL.h"
+#include "kazmath/mat4.h"
+
+NS_CC_BEGIN
+
+class GLProgram;
+
+/**
+ * @addtogroup renderer
+ * @{
+ */
+
+/** A command that draws textured quads.
+ 
+ The quads are given in the node's local space, together with the model-view matrix of the
+ node, the texture name, the shader program and the blend function they have to be drawn with.
+ The quads are copied (in world space) by Renderer::addCommand(), so they can be changed once
+ the command was added.
+ @since v3.0
+ */
+class CC_DLL QuadCommand : public RenderCommand
+{
+public:
+    QuadCommand();
+    virtual ~QuadCommand();
+
+    /** Records the quads to draw and the state they have to be drawn with */
+    void init(GLuint textureID, GLProgram* shader, const BlendFunc& blendType, V3F_C4B_T2F_Quad* quads, long quadCount, const kmMat4& mv);
+
+    /** Uses the shader, binds the texture and sets the blend function of the command */
+    void useMaterial() const;
+
+    /** Returns whether the quads of both commands can be drawn with the same draw call,
+     that is, whether they use the same texture, shader program and blend function */
+    bool hasSameMaterial(const QuadCommand* other) const;
+
+    inline GLuint getTextureID() const { return _textureID; }
+    inline GLProgram* getShader() const { return _shader; }
+    inline const BlendFunc& getBlendType() const { return _blendType; }
+    inline V3F_C4B_T2F_Quad* getQuads() const { return _quads; }
+    inline long getQuadCount() const { return _quadCount; }
+    inline const kmMat4& getModelView() const { return _mv; }
+
+protected:
+    GLuint _textureID;
+    GLProgram* _shader;
+    BlendFunc _blendType;
+    V3F_C4B_T2F_Quad* _quads;
+    long _quadCount;
+    kmMat4 _mv;
+};
+
+// end of renderer group
+/// @}
+
+NS_CC_END
+
+#endif // __CCQUADCOMMAND_H__
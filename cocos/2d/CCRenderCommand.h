@@ -0,0 +1,71 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+ 
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CCRENDERCOMMAND_H__
+#define __CCRENDERCOMMAND_H__
+
+#include "CCPlatformMacros.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup renderer
+ * @{
+ */
+
+/** Base class of the commands recorded by Node::visit() and executed by the Renderer.
+ 
+ A command only stores what is needed to issue its draw later on. Renderer::addCommand()
+ copies the quads and the model-view matrix of the command, so a node can reuse one command
+ and add it again (e.g. when it's visited several times before the queue is flushed). Any
+ other data the command points to has to be kept alive by the node until the Renderer has
+ flushed its queue.
+ @since v3.0
+ */
+class CC_DLL RenderCommand
+{
+public:
+    enum class Type
+    {
+        QUAD_COMMAND,
+        CUSTOM_COMMAND,
+    };
+
+    /** Returns the type of the command, used by the Renderer to dispatch it */
+    inline Type getType() const { return _type; }
+
+protected:
+    RenderCommand(Type type);
+    virtual ~RenderCommand();
+
+    Type _type;
+};
+
+// end of renderer group
+/// @}
+
+NS_CC_END
+
+#endif // __CCRENDERCOMMAND_H__
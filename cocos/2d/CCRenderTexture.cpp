@@ -37,6 +37,7 @@ THE SOFTWARE.
 #include "CCNotificationCenter.h"
 #include "CCEventType.h"
 #include "CCGrid.h"
+#include "CCRenderer.h"
 // extern
 #include "kazmath/GL/matrix.h"
 
@@ -298,12 +299,15 @@ bool RenderTexture::initWithWidthAndHeight(int w, int h, Texture2D::PixelFormat
 
 void RenderTexture::begin()
 {
+    Director *director = Director::getInstance();
+    // draw what was recorded so far in the current frame buffer
+    director->getRenderer()->render();
+
     kmGLMatrixMode(KM_GL_PROJECTION);
 	kmGLPushMatrix();
 	kmGLMatrixMode(KM_GL_MODELVIEW);
     kmGLPushMatrix();
     
-    Director *director = Director::getInstance();
     director->setProjection(director->getProjection());
 
     const Size& texSize = _texture->getContentSizeInPixels();
@@ -399,6 +403,8 @@ void RenderTexture::beginWithClear(float r, float g, float b, float a, float dep
 void RenderTexture::end()
 {
     Director *director = Director::getInstance();
+    // draw what was recorded between begin() and end() into the texture
+    director->getRenderer()->render();
     
     glBindFramebuffer(GL_FRAMEBUFFER, _oldFBO);
 
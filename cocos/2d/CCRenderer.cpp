@@ -0,0 +1,365 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+ 
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "CCRenderer.h"
+#include "CCQuadCommand.h"
+#include "CCCustomCommand.h"
+#include "CCGLProgram.h"
+#include "ccGLStateCache.h"
+#include "ccMacros.h"
+#include "CCNotificationCenter.h"
+#include "CCEventType.h"
+#include "kazmath/GL/matrix.h"
+#include <stddef.h>
+
+#define kQuadSize sizeof(V3F_C4B_T2F)
+
+NS_CC_BEGIN
+
+Renderer::Renderer()
+: _quadVAO(0)
+, _isRendering(false)
+, _glViewAssigned(false)
+{
+    _buffersVBO[0] = _buffersVBO[1] = 0;
+    _renderQueue.reserve(256);
+    _queuedQuads.reserve(VBO_SIZE);
+}
+
+Renderer::~Renderer()
+{
+    _renderQueue.clear();
+
+    if (_glViewAssigned)
+    {
+        glDeleteBuffers(2, _buffersVBO);
+#if CC_TEXTURE_ATLAS_USE_VAO
+        glDeleteVertexArrays(1, &_quadVAO);
+        GL::bindVAO(0);
+#endif
+    }
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    NotificationCenter::getInstance()->removeObserver(this, EVNET_COME_TO_FOREGROUND);
+#endif
+}
+
+void Renderer::initGLView()
+{
+    if (_glViewAssigned)
+        return;
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    // listen the event when app go to foreground
+    NotificationCenter::getInstance()->addObserver(this,
+                                                   callfuncO_selector(Renderer::listenBackToForeground),
+                                                   EVNET_COME_TO_FOREGROUND,
+                                                   nullptr);
+#endif
+
+    setupIndices();
+    setupBuffer();
+
+    _glViewAssigned = true;
+}
+
+void Renderer::listenBackToForeground(Object *obj)
+{
+    CC_UNUSED_PARAM(obj);
+    // the GL context was recreated: the old buffer names are gone
+    setupBuffer();
+}
+
+void Renderer::setupIndices()
+{
+    for( int i=0; i < VBO_SIZE; i++)
+    {
+        _indices[i*6+0] = (GLushort) (i*4+0);
+        _indices[i*6+1] = (GLushort) (i*4+1);
+        _indices[i*6+2] = (GLushort) (i*4+2);
+        _indices[i*6+3] = (GLushort) (i*4+3);
+        _indices[i*6+4] = (GLushort) (i*4+2);
+        _indices[i*6+5] = (GLushort) (i*4+1);
+    }
+}
+
+void Renderer::setupBuffer()
+{
+#if CC_TEXTURE_ATLAS_USE_VAO
+    setupVBOAndVAO();
+#else
+    setupVBO();
+#endif
+}
+
+#if CC_TEXTURE_ATLAS_USE_VAO
+void Renderer::setupVBOAndVAO()
+{
+    glGenVertexArrays(1, &_quadVAO);
+    GL::bindVAO(_quadVAO);
+
+    glGenBuffers(2, &_buffersVBO[0]);
+
+    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(V3F_C4B_T2F_Quad) * VBO_SIZE, nullptr, GL_DYNAMIC_DRAW);
+
+    // vertices
+    glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_POSITION);
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof( V3F_C4B_T2F, vertices));
+
+    // colors
+    glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_COLOR);
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, kQuadSize, (GLvoid*) offsetof( V3F_C4B_T2F, colors));
+
+    // tex coords
+    glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_TEX_COORDS);
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 2, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof( V3F_C4B_T2F, texCoords));
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * VBO_SIZE * 6, _indices, GL_STATIC_DRAW);
+
+    // Must unbind the VAO before changing the element buffer.
+    GL::bindVAO(0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    CHECK_GL_ERROR_DEBUG();
+}
+#else // CC_TEXTURE_ATLAS_USE_VAO
+void Renderer::setupVBO()
+{
+    glGenBuffers(2, &_buffersVBO[0]);
+
+    mapBuffers();
+}
+#endif // ! CC_TEXTURE_ATLAS_USE_VAO
+
+void Renderer::mapBuffers()
+{
+    // Avoid changing the element buffer for whatever VAO might be bound.
+    GL::bindVAO(0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(V3F_C4B_T2F_Quad) * VBO_SIZE, nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * VBO_SIZE * 6, _indices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    CHECK_GL_ERROR_DEBUG();
+}
+
+static inline void transformVertex(const kmMat4& mv, const Vertex3F& in, Vertex3F* out)
+{
+    const float* m = mv.mat;
+    out->x = in.x * m[0] + in.y * m[4] + in.z * m[8] + m[12];
+    out->y = in.x * m[1] + in.y * m[5] + in.z * m[9] + m[13];
+    out->z = in.x * m[2] + in.y * m[6] + in.z * m[10] + m[14];
+}
+
+void Renderer::addCommand(RenderCommand* command)
+{
+    CCASSERT(command, "command should not be null");
+
+    QueuedCommand item;
+    item.command = command;
+    item.textureID = 0;
+    item.shader = nullptr;
+    item.blendType = BlendFunc::DISABLE;
+    item.quadStart = _queuedQuads.size();
+    item.quadCount = 0;
+
+    // Nodes reuse their command, which may be changed and added again before the queue is flushed
+    // (e.g. a node visited several times), so everything that changes per visit is copied here.
+    switch (command->getType())
+    {
+        case RenderCommand::Type::QUAD_COMMAND:
+            {
+                auto quadCommand = static_cast<QuadCommand*>(command);
+                item.textureID = quadCommand->getTextureID();
+                item.shader = quadCommand->getShader();
+                item.blendType = quadCommand->getBlendType();
+                item.quadCount = quadCommand->getQuadCount();
+
+                const kmMat4& mv = quadCommand->getModelView();
+                const V3F_C4B_T2F_Quad* quads = quadCommand->getQuads();
+
+                _queuedQuads.resize(item.quadStart + item.quadCount);
+                for (size_t i = 0; i < item.quadCount; ++i)
+                {
+                    const V3F_C4B_T2F_Quad& src = quads[i];
+                    V3F_C4B_T2F_Quad& dst = _queuedQuads[item.quadStart + i];
+
+                    dst = src;
+                    transformVertex(mv, src.bl.vertices, &dst.bl.vertices);
+                    transformVertex(mv, src.br.vertices, &dst.br.vertices);
+                    transformVertex(mv, src.tl.vertices, &dst.tl.vertices);
+                    transformVertex(mv, src.tr.vertices, &dst.tr.vertices);
+                }
+            }
+            break;
+        case RenderCommand::Type::CUSTOM_COMMAND:
+            kmMat4Assign(&item.mv, &static_cast<CustomCommand*>(command)->getModelView());
+            break;
+        default:
+            break;
+    }
+
+    _renderQueue.push_back(item);
+}
+
+void Renderer::render()
+{
+    // Commands executed by the queue may issue immediate-mode draws which try to flush it again
+    if (_isRendering || _renderQueue.empty())
+        return;
+
+    CCASSERT(_glViewAssigned, "Renderer::initGLView() should be called before rendering");
+
+    _isRendering = true;
+
+    // Consecutive quad commands have consecutive quads in _queuedQuads,
+    // so a batch is the range [batchStart, batchEnd) drawn with the material of _renderQueue[batchItem].
+    size_t batchItem = 0;
+    size_t batchStart = 0;
+    size_t batchEnd = 0;
+
+    auto drawBatch = [&]() {
+        if (batchEnd > batchStart)
+        {
+            drawQuads(_renderQueue[batchItem], batchStart, batchEnd - batchStart);
+        }
+        batchStart = batchEnd;
+    };
+
+    // Don't use iterators: a custom command is allowed to record new commands
+    for (size_t i = 0; i < _renderQueue.size(); ++i)
+    {
+        switch (_renderQueue[i].command->getType())
+        {
+            case RenderCommand::Type::QUAD_COMMAND:
+                if (batchEnd > batchStart && !_renderQueue[batchItem].hasSameMaterial(_renderQueue[i]))
+                {
+                    drawBatch();
+                }
+                if (batchEnd == batchStart)
+                {
+                    batchStart = _renderQueue[i].quadStart;
+                }
+                batchItem = i;
+                batchEnd = _renderQueue[i].quadStart + _renderQueue[i].quadCount;
+                break;
+            case RenderCommand::Type::CUSTOM_COMMAND:
+                {
+                    drawBatch();
+
+                    // copied since the command may add new ones to the queue
+                    kmMat4 mv = _renderQueue[i].mv;
+                    drawCustomCommand(static_cast<CustomCommand*>(_renderQueue[i].command), mv);
+                }
+                break;
+            default:
+                CCLOGERROR("Renderer: unknown render command type");
+                break;
+        }
+    }
+
+    drawBatch();
+
+    _renderQueue.clear();
+    _queuedQuads.clear();
+    _isRendering = false;
+}
+
+void Renderer::drawQuads(const QueuedCommand& material, size_t start, size_t count)
+{
+    // the quads are already in world space
+    kmMat4 identity;
+    kmMat4Identity(&identity);
+
+    material.shader->use();
+    material.shader->setUniformsForBuiltins(identity);
+    GL::bindTexture2D(material.textureID);
+    GL::blendFunc(material.blendType.src, material.blendType.dst);
+
+    for (size_t offset = 0; offset < count; offset += VBO_SIZE)
+    {
+        size_t numQuads = MIN(count - offset, (size_t)VBO_SIZE);
+        drawBatchedQuads(&_queuedQuads[start + offset], numQuads);
+    }
+}
+
+void Renderer::drawBatchedQuads(const V3F_C4B_T2F_Quad* quads, size_t numQuads)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
+    // orphan the previous contents so the driver doesn't have to wait for the previous draw
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quads[0]) * numQuads, quads, GL_DYNAMIC_DRAW);
+    CC_INCREMENT_GL_UPLOADED_BYTES(sizeof(quads[0]) * numQuads);
+
+#if CC_TEXTURE_ATLAS_USE_VAO
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    GL::bindVAO(_quadVAO);
+#if CC_REBIND_INDICES_BUFFER
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
+#endif
+    glDrawElements(GL_TRIANGLES, (GLsizei) numQuads*6, GL_UNSIGNED_SHORT, 0);
+#if CC_REBIND_INDICES_BUFFER
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+#endif
+#else
+    GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX);
+
+    // vertices
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, vertices));
+    // colors
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, colors));
+    // tex coords
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 2, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, texCoords));
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
+    glDrawElements(GL_TRIANGLES, (GLsizei) numQuads*6, GL_UNSIGNED_SHORT, 0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+#endif
+
+    CC_INCREMENT_GL_DRAWS(1);
+    CC_INCREMENT_GL_QUADS(numQuads);
+
+    CHECK_GL_ERROR_DEBUG();
+}
+
+void Renderer::drawCustomCommand(CustomCommand* command, const kmMat4& mv)
+{
+    kmGLPushMatrix();
+    kmGLLoadMatrix(&mv);
+
+    command->execute();
+
+    kmGLPopMatrix();
+}
+
+NS_CC_END
@@ -0,0 +1,145 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+ 
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CCRENDERER_H__
+#define __CCRENDERER_H__
+
+#include "CCObject.h"
+#include "ccConfig.h"
+#include "ccTypes.h"
+#include "CCGL.h"
+#include "CCRenderCommand.h"
+#include "kazmath/mat4.h"
+#include <vector>
+
+NS_CC_BEGIN
+
+class QuadCommand;
+class CustomCommand;
+class GLProgram;
+
+/**
+ * @addtogroup renderer
+ * @{
+ */
+
+/** @brief Renderer collects the commands recorded while the scene graph is visited and
+ executes them in order when render() is called.
+ 
+ Consecutive QuadCommands that use the same texture, shader program and blend function are
+ merged: their quads are transformed to world space on the CPU and drawn with a single call.
+ Any other command ends the current batch.
+ 
+ Director::drawScene() flushes the queue once per frame, after the running scene, the
+ notification node and the stats have been visited. Nodes that change GL state around their
+ children (ClippingNode, RenderTexture, grids, scissor clipping...) flush it themselves before
+ changing that state, and so does any immediate-mode draw that goes through GLProgram::use(),
+ so draw() overrides that still issue GL calls straight away keep their paint order.
+ @since v3.0
+ */
+class CC_DLL Renderer : public Object
+{
+public:
+    /** number of quads the vertex buffer of the renderer can hold */
+    static const int VBO_SIZE = 65536 / 6;
+
+    Renderer();
+    virtual ~Renderer();
+
+    /** creates the GL buffers. Should be called once the GL context has been created */
+    void initGLView();
+
+    /** adds a command to the end of the queue. The command is not retained, but its quads and
+     model-view matrix are copied, so the command can be changed and added again right away */
+    void addCommand(RenderCommand* command);
+
+    /** executes and clears all the queued commands */
+    void render();
+
+    /** returns whether there are commands waiting to be rendered */
+    inline bool hasPendingCommands() const { return !_renderQueue.empty(); }
+
+    /** returns whether the renderer is executing its queue */
+    inline bool isRendering() const { return _isRendering; }
+
+    /** called when the application comes back to the foreground */
+    void listenBackToForeground(Object *obj);
+
+protected:
+    void setupIndices();
+    void setupBuffer();
+#if CC_TEXTURE_ATLAS_USE_VAO
+    void setupVBOAndVAO();
+#else
+    void setupVBO();
+#endif
+    void mapBuffers();
+
+    /** A queued command, with a copy of the state it had when it was added */
+    struct QueuedCommand
+    {
+        RenderCommand* command;
+        // material of a quad command
+        GLuint textureID;
+        GLProgram* shader;
+        BlendFunc blendType;
+        // quads of a quad command in _queuedQuads, already transformed to world space
+        size_t quadStart;
+        size_t quadCount;
+        // model-view matrix of a custom command
+        kmMat4 mv;
+
+        inline bool hasSameMaterial(const QueuedCommand& other) const
+        {
+            return textureID == other.textureID
+                && shader == other.shader
+                && blendType.src == other.blendType.src
+                && blendType.dst == other.blendType.dst;
+        }
+    };
+
+    void drawQuads(const QueuedCommand& material, size_t start, size_t count);
+    void drawBatchedQuads(const V3F_C4B_T2F_Quad* quads, size_t numQuads);
+    void drawCustomCommand(CustomCommand* command, const kmMat4& mv);
+
+    std::vector<QueuedCommand> _renderQueue;
+
+    // quads of all the queued quad commands
+    std::vector<V3F_C4B_T2F_Quad> _queuedQuads;
+
+    GLushort _indices[6 * VBO_SIZE];
+    GLuint _quadVAO;
+    GLuint _buffersVBO[2]; //0: vertex  1: indices
+
+    bool _isRendering;
+    bool _glViewAssigned;
+};
+
+// end of renderer group
+/// @}
+
+NS_CC_END
+
+#endif // __CCRENDERER_H__
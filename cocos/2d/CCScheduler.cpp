@@ -27,47 +27,16 @@ THE SOFTWARE.
 #include "CCScheduler.h"
 #include "ccMacros.h"
 #include "CCDirector.h"
-#include "utlist.h"
 #include "ccCArray.h"
 #include "CCArray.h"
 #include "CCScriptSupport.h"
 
+#include <algorithm>
+
 using namespace std;
 
 NS_CC_BEGIN
 
-// data structures
-
-// A list double-linked list used for "updates with priority"
-typedef struct _listEntry
-{
-    struct _listEntry   *prev, *next;
-    Object            *target;        // not retained (retained by hashUpdateEntry)
-    int                 priority;
-    bool                paused;
-    bool                markedForDeletion; // selector will no longer be called and entry will be removed at end of the next tick
-} tListEntry;
-
-typedef struct _hashUpdateEntry
-{
-    tListEntry          **list;        // Which list does it belong to ?
-    tListEntry          *entry;        // entry in the list
-    Object            *target;        // hash key (retained)
-    UT_hash_handle      hh;
-} tHashUpdateEntry;
-
-// Hash Element used for "selectors with interval"
-typedef struct _hashSelectorEntry
-{
-    ccArray             *timers;
-    Object            *target;    // hash key (retained)
-    int        timerIndex;
-    Timer             *currentTimer;
-    bool                currentTimerSalvaged;
-    bool                paused;
-    UT_hash_handle      hh;
-} tHashTimerEntry;
-
 // implementation Timer
 
 Timer::Timer()
@@ -248,39 +217,80 @@ const int Scheduler::PRIORITY_NON_SYSTEM_MIN = PRIORITY_SYSTEM + 1;
 
 Scheduler::Scheduler(void)
 : _timeScale(1.0f)
-, _updatesNegList(NULL)
-, _updates0List(NULL)
-, _updatesPosList(NULL)
-, _hashForUpdates(NULL)
-, _hashForTimers(NULL)
-, _currentTarget(NULL)
+, _removedUpdateEntries(0)
+, _markedUpdateEntries(0)
+, _removedTimerTargets(0)
+, _currentTarget(-1)
 , _currentTargetSalvaged(false)
 , _updateHashLocked(false)
 , _scriptHandlerEntries(NULL)
+, _performHead(&_performStub)
+, _performTail(&_performStub)
+, _performQueueSize(0)
+, _performFunctionTimeBudget(0.004f)
+, _performQueueMaxLatency(0.0f)
+, _performQueueAverageLatency(0.0f)
 {
-
+    _performStub.next.store(NULL, std::memory_order_relaxed);
 }
 
 Scheduler::~Scheduler(void)
 {
     unscheduleAll();
     CC_SAFE_RELEASE(_scriptHandlerEntries);
+
+    // the functions which were never performed are dropped
+    PerformNode *node;
+    while ((node = popPerformNode()) != NULL)
+    {
+        delete node;
+    }
 }
 
-void Scheduler::removeHashElement(_hashSelectorEntry *element)
+Scheduler::TimerTarget* Scheduler::findTimerTarget(const Object *target, int *index)
 {
+    auto it = _timerTargetIndices.find(target);
+    if (it == _timerTargetIndices.end())
+    {
+        return NULL;
+    }
 
-	cocos2d::Object *target = element->target;
+    if (index)
+    {
+        *index = it->second;
+    }
+    return &_timerTargets[it->second];
+}
 
-    ccArrayFree(element->timers);
-    HASH_DEL(_hashForTimers, element);
-    free(element);
+void Scheduler::removeTimerTarget(int index)
+{
+    TimerTarget& element = _timerTargets[index];
+    Object *target = element.target;
+
+    ccArrayFree(element.timers);
+    element.timers = NULL;
+    element.target = NULL;
+    _timerTargetIndices.erase(target);
+    ++_removedTimerTargets;
 
-    // make sure the target is released after we have removed the hash element
+    // make sure the target is released after we have removed the element
     // otherwise we access invalid memory when the release call deletes the target
     // and the target calls removeAllSelectors() during its destructor
     target->release();
+}
+
+void Scheduler::compactTimerTargets()
+{
+    auto end = std::remove_if(_timerTargets.begin(), _timerTargets.end(), [](const TimerTarget& element){
+        return element.target == NULL;
+    });
+    _timerTargets.erase(end, _timerTargets.end());
+    _removedTimerTargets = 0;
 
+    for (int i = 0; i < (int)_timerTargets.size(); ++i)
+    {
+        _timerTargetIndices[_timerTargets[i].target] = i;
+    }
 }
 
 void Scheduler::scheduleSelector(SEL_SCHEDULE selector, Object *target, float interval, bool paused)
@@ -293,21 +303,22 @@ void Scheduler::scheduleSelector(SEL_SCHEDULE selector, Object *target, float in
     CCASSERT(selector, "Argument selector must be non-NULL");
     CCASSERT(target, "Argument target must be non-NULL");
 
-    tHashTimerEntry *element = NULL;
-    HASH_FIND_PTR(_hashForTimers, &target, element);
+    TimerTarget *element = findTimerTarget(target);
 
     if (! element)
     {
-        element = (tHashTimerEntry *)calloc(sizeof(*element), 1);
-        element->target = target;
-        if (target)
-        {
-            target->retain();
-        }
-        HASH_ADD_PTR(_hashForTimers, target, element);
+        TimerTarget newElement;
+        memset(&newElement, 0, sizeof(newElement));
+        newElement.target = target;
+        target->retain();
 
         // Is this the 1st element ? Then set the pause level to all the selectors of this target
-        element->paused = paused;
+        newElement.paused = paused;
+
+        // may grow the array during a tick: the tick loop only keeps indices
+        _timerTargetIndices[target] = (int)_timerTargets.size();
+        _timerTargets.push_back(newElement);
+        element = &_timerTargets.back();
     }
     else
     {
@@ -351,8 +362,8 @@ void Scheduler::unscheduleSelector(SEL_SCHEDULE selector, Object *target)
     //CCASSERT(target);
     //CCASSERT(selector);
 
-    tHashTimerEntry *element = NULL;
-    HASH_FIND_PTR(_hashForTimers, &target, element);
+    int index = -1;
+    TimerTarget *element = findTimerTarget(target, &index);
 
     if (element)
     {
@@ -378,13 +389,13 @@ void Scheduler::unscheduleSelector(SEL_SCHEDULE selector, Object *target)
 
                 if (element->timers->num == 0)
                 {
-                    if (_currentTarget == element)
+                    if (_currentTarget == index)
                     {
                         _currentTargetSalvaged = true;
                     }
                     else
                     {
-                        removeHashElement(element);
+                        removeTimerTarget(index);
                     }
                 }
 
@@ -394,112 +405,113 @@ void Scheduler::unscheduleSelector(SEL_SCHEDULE selector, Object *target)
     }
 }
 
-void Scheduler::priorityIn(tListEntry **list, Object *target, int priority, bool paused)
+void Scheduler::scheduleUpdateForTarget(Object *target, int priority, bool paused)
 {
-    tListEntry *listElement = (tListEntry *)malloc(sizeof(*listElement));
-
-    listElement->target = target;
-    listElement->priority = priority;
-    listElement->paused = paused;
-    listElement->next = listElement->prev = NULL;
-    listElement->markedForDeletion = false;
-
-    // empty list ?
-    if (! *list)
-    {
-        DL_APPEND(*list, listElement);
-    }
-    else
+    UpdateEntry *entry = findUpdateEntry(target);
+    if (entry)
     {
-        bool bAdded = false;
+#if COCOS2D_DEBUG >= 1
+        CCASSERT(entry->markedForDeletion,"");
+#endif
+        // TODO: check if priority has changed!
 
-        for (tListEntry *element = *list; element; element = element->next)
+        if (entry->markedForDeletion)
         {
-            if (priority < element->priority)
-            {
-                if (element == *list)
-                {
-                    DL_PREPEND(*list, listElement);
-                }
-                else
-                {
-                    listElement->next = element;
-                    listElement->prev = element->prev;
+            entry->markedForDeletion = false;
+            --_markedUpdateEntries;
+        }
+        return;
+    }
 
-                    element->prev->next = listElement;
-                    element->prev = listElement;
-                }
+    // the new entry is sorted in _updateEntries at the beginning of the next tick,
+    // so the array is never resized while it is being iterated
+    UpdateEntry newEntry;
+    newEntry.target = target;
+    newEntry.priority = priority;
+    newEntry.paused = paused;
+    newEntry.markedForDeletion = false;
+    target->retain();
 
-                bAdded = true;
-                break;
-            }
-        }
+    _scheduledUpdates.push_back(newEntry);
+    _updateEntryIndices[target] = -(int)_scheduledUpdates.size();
+}
 
-        // Not added? priority has the higher value. Append it.
-        if (! bAdded)
-        {
-            DL_APPEND(*list, listElement);
-        }
+Scheduler::UpdateEntry* Scheduler::findUpdateEntry(const Object *target)
+{
+    auto it = _updateEntryIndices.find(target);
+    if (it == _updateEntryIndices.end())
+    {
+        return NULL;
     }
 
-    // update hash entry for quick access
-    tHashUpdateEntry *pHashElement = (tHashUpdateEntry *)calloc(sizeof(*pHashElement), 1);
-    pHashElement->target = target;
-    target->retain();
-    pHashElement->list = list;
-    pHashElement->entry = listElement;
-    HASH_ADD_PTR(_hashForUpdates, target, pHashElement);
+    return it->second >= 0 ? &_updateEntries[it->second] : &_scheduledUpdates[-it->second - 1];
 }
 
-void Scheduler::appendIn(_listEntry **list, Object *target, bool paused)
+void Scheduler::removeUpdateEntry(const Object *target)
 {
-    tListEntry *listElement = (tListEntry *)malloc(sizeof(*listElement));
+    auto it = _updateEntryIndices.find(target);
+    if (it == _updateEntryIndices.end())
+    {
+        return;
+    }
 
-    listElement->target = target;
-    listElement->paused = paused;
-    listElement->markedForDeletion = false;
+    UpdateEntry& entry = it->second >= 0 ? _updateEntries[it->second] : _scheduledUpdates[-it->second - 1];
+    Object *retainedTarget = entry.target;
 
-    DL_APPEND(*list, listElement);
+    if (entry.markedForDeletion)
+    {
+        --_markedUpdateEntries;
+    }
+    entry.target = NULL;
+    if (it->second >= 0)
+    {
+        ++_removedUpdateEntries;
+    }
+    _updateEntryIndices.erase(it);
 
-    // update hash entry for quicker access
-    tHashUpdateEntry *pHashElement = (tHashUpdateEntry *)calloc(sizeof(*pHashElement), 1);
-    pHashElement->target = target;
-    target->retain();
-    pHashElement->list = list;
-    pHashElement->entry = listElement;
-    HASH_ADD_PTR(_hashForUpdates, target, pHashElement);
+    // target#release should be the last one to prevent
+    // a possible double-free. eg: If the [target dealloc] might want to remove it itself from there
+    retainedTarget->release();
 }
 
-void Scheduler::scheduleUpdateForTarget(Object *target, int priority, bool paused)
+void Scheduler::flushUpdateEntries()
 {
+    CCASSERT(! _updateHashLocked, "the update entries can't be moved during a tick");
 
-    tHashUpdateEntry *pHashElement = NULL;
-    HASH_FIND_PTR(_hashForUpdates, &target, pHashElement);
-    if (pHashElement)
+    // a few removed entries are cheaper to skip than to compact away
+    bool compact = _removedUpdateEntries > 0 && _removedUpdateEntries * 8 >= (int)_updateEntries.size();
+    if (_scheduledUpdates.empty() && ! compact)
     {
-#if COCOS2D_DEBUG >= 1
-        CCASSERT(pHashElement->entry->markedForDeletion,"");
-#endif
-        // TODO: check if priority has changed!
-
-        pHashElement->entry->markedForDeletion = false;
         return;
     }
 
-    // most of the updates are going to be 0, that's way there
-    // is an special list for updates with priority 0
-    if (priority == 0)
-    {
-        appendIn(&_updates0List, target, paused);
-    }
-    else if (priority < 0)
+    auto isRemoved = [](const UpdateEntry& entry){ return entry.target == NULL; };
+    auto byPriority = [](const UpdateEntry& a, const UpdateEntry& b){ return a.priority < b.priority; };
+
+    // the entries before the first removed or merged one keep their index
+    auto firstRemoved = std::find_if(_updateEntries.begin(), _updateEntries.end(), isRemoved);
+    int firstMoved = (int)(firstRemoved - _updateEntries.begin());
+    _updateEntries.erase(std::remove_if(firstRemoved, _updateEntries.end(), isRemoved), _updateEntries.end());
+    _removedUpdateEntries = 0;
+
+    _scheduledUpdates.erase(std::remove_if(_scheduledUpdates.begin(), _scheduledUpdates.end(), isRemoved), _scheduledUpdates.end());
+    if (! _scheduledUpdates.empty())
     {
-        priorityIn(&_updatesNegList, target, priority, paused);
+        std::stable_sort(_scheduledUpdates.begin(), _scheduledUpdates.end(), byPriority);
+
+        // the entries already scheduled stay before the new ones of the same priority
+        auto firstMerged = std::upper_bound(_updateEntries.begin(), _updateEntries.end(), _scheduledUpdates.front(), byPriority);
+        firstMoved = std::min(firstMoved, (int)(firstMerged - _updateEntries.begin()));
+
+        size_t scheduledStart = _updateEntries.size();
+        _updateEntries.insert(_updateEntries.end(), _scheduledUpdates.begin(), _scheduledUpdates.end());
+        std::inplace_merge(_updateEntries.begin() + firstMoved, _updateEntries.begin() + scheduledStart, _updateEntries.end(), byPriority);
+        _scheduledUpdates.clear();
     }
-    else
+
+    for (int i = firstMoved; i < (int)_updateEntries.size(); ++i)
     {
-        // priority > 0
-        priorityIn(&_updatesPosList, target, priority, paused);
+        _updateEntryIndices[_updateEntries[i].target] = i;
     }
 }
 
@@ -508,8 +520,7 @@ bool Scheduler::isScheduledForTarget(SEL_SCHEDULE selector, Object *target)
     CCASSERT(selector, "Argument selector must be non-NULL");
     CCASSERT(target, "Argument target must be non-NULL");
     
-    tHashTimerEntry *element = NULL;
-    HASH_FIND_PTR(_hashForTimers, &target, element);
+    TimerTarget *element = findTimerTarget(target);
     
     if (!element)
     {
@@ -537,28 +548,6 @@ bool Scheduler::isScheduledForTarget(SEL_SCHEDULE selector, Object *target)
     return false;  // should never get here
 }
 
-void Scheduler::removeUpdateFromHash(struct _listEntry *entry)
-{
-    tHashUpdateEntry *element = NULL;
-
-    HASH_FIND_PTR(_hashForUpdates, &entry->target, element);
-    if (element)
-    {
-        // list entry
-        DL_DELETE(*element->list, element->entry);
-        free(element->entry);
-
-        // hash entry
-        Object* target = element->target;
-        HASH_DEL(_hashForUpdates, element);
-        free(element);
-
-        // target#release should be the last one to prevent
-        // a possible double-free. eg: If the [target dealloc] might want to remove it itself from there
-        target->release();
-    }
-}
-
 void Scheduler::unscheduleUpdateForTarget(const Object *target)
 {
     if (target == NULL)
@@ -566,17 +555,20 @@ void Scheduler::unscheduleUpdateForTarget(const Object *target)
         return;
     }
 
-    tHashUpdateEntry *element = NULL;
-    HASH_FIND_PTR(_hashForUpdates, &target, element);
-    if (element)
+    UpdateEntry *entry = findUpdateEntry(target);
+    if (entry)
     {
         if (_updateHashLocked)
         {
-            element->entry->markedForDeletion = true;
+            if (! entry->markedForDeletion)
+            {
+                entry->markedForDeletion = true;
+                ++_markedUpdateEntries;
+            }
         }
         else
         {
-            this->removeUpdateFromHash(element->entry);
+            this->removeUpdateEntry(target);
         }
     }
 }
@@ -588,45 +580,44 @@ void Scheduler::unscheduleAll(void)
 
 void Scheduler::unscheduleAllWithMinPriority(int nMinPriority)
 {
+    // the targets are kept alive until the end, since unscheduling one of them may release another one
+    std::vector<Object*> targets;
+    targets.reserve(_timerTargets.size());
+
     // Custom Selectors
-    tHashTimerEntry *element = NULL;
-    tHashTimerEntry *pNextElement = NULL;
-    for (element = _hashForTimers; element != NULL;)
+    for (const auto& element : _timerTargets)
     {
-        // element may be removed in unscheduleAllSelectorsForTarget
-        pNextElement = (tHashTimerEntry *)element->hh.next;
-        unscheduleAllForTarget(element->target);
+        if (element.target)
+        {
+            element.target->retain();
+            targets.push_back(element.target);
+        }
+    }
 
-        element = pNextElement;
+    for (auto target : targets)
+    {
+        unscheduleAllForTarget(target);
+        target->release();
     }
+    targets.clear();
 
     // Updates selectors
-    tListEntry *entry, *tmp;
-    if(nMinPriority < 0) 
+    for (const auto& entries : { &_updateEntries, &_scheduledUpdates })
     {
-        DL_FOREACH_SAFE(_updatesNegList, entry, tmp)
+        for (const auto& entry : *entries)
         {
-            if(entry->priority >= nMinPriority)
+            if (entry.target && entry.priority >= nMinPriority)
             {
-                unscheduleUpdateForTarget(entry->target);
+                entry.target->retain();
+                targets.push_back(entry.target);
             }
         }
     }
 
-    if(nMinPriority <= 0) 
-    {
-        DL_FOREACH_SAFE(_updates0List, entry, tmp)
-        {
-            unscheduleUpdateForTarget(entry->target);
-        }
-    }
-
-    DL_FOREACH_SAFE(_updatesPosList, entry, tmp)
+    for (auto target : targets)
     {
-        if(entry->priority >= nMinPriority)
-        {
-            unscheduleUpdateForTarget(entry->target);
-        }
+        unscheduleUpdateForTarget(target);
+        target->release();
     }
 
     if (_scriptHandlerEntries)
@@ -644,8 +635,8 @@ void Scheduler::unscheduleAllForTarget(Object *target)
     }
 
     // Custom Selectors
-    tHashTimerEntry *element = NULL;
-    HASH_FIND_PTR(_hashForTimers, &target, element);
+    int index = -1;
+    TimerTarget *element = findTimerTarget(target, &index);
 
     if (element)
     {
@@ -657,13 +648,13 @@ void Scheduler::unscheduleAllForTarget(Object *target)
         }
         ccArrayRemoveAllObjects(element->timers);
 
-        if (_currentTarget == element)
+        if (_currentTarget == index)
         {
             _currentTargetSalvaged = true;
         }
         else
         {
-            removeHashElement(element);
+            removeTimerTarget(index);
         }
     }
 
@@ -701,20 +692,17 @@ void Scheduler::resumeTarget(Object *target)
     CCASSERT(target != NULL, "");
 
     // custom selectors
-    tHashTimerEntry *element = NULL;
-    HASH_FIND_PTR(_hashForTimers, &target, element);
+    TimerTarget *element = findTimerTarget(target);
     if (element)
     {
         element->paused = false;
     }
 
     // update selector
-    tHashUpdateEntry *elementUpdate = NULL;
-    HASH_FIND_PTR(_hashForUpdates, &target, elementUpdate);
-    if (elementUpdate)
+    UpdateEntry *entry = findUpdateEntry(target);
+    if (entry)
     {
-        CCASSERT(elementUpdate->entry != NULL, "");
-        elementUpdate->entry->paused = false;
+        entry->paused = false;
     }
 }
 
@@ -723,20 +711,17 @@ void Scheduler::pauseTarget(Object *target)
     CCASSERT(target != NULL, "");
 
     // custom selectors
-    tHashTimerEntry *element = NULL;
-    HASH_FIND_PTR(_hashForTimers, &target, element);
+    TimerTarget *element = findTimerTarget(target);
     if (element)
     {
         element->paused = true;
     }
 
     // update selector
-    tHashUpdateEntry *elementUpdate = NULL;
-    HASH_FIND_PTR(_hashForUpdates, &target, elementUpdate);
-    if (elementUpdate)
+    UpdateEntry *entry = findUpdateEntry(target);
+    if (entry)
     {
-        CCASSERT(elementUpdate->entry != NULL, "");
-        elementUpdate->entry->paused = true;
+        entry->paused = true;
     }
 }
 
@@ -745,19 +730,17 @@ bool Scheduler::isTargetPaused(Object *target)
     CCASSERT( target != NULL, "target must be non nil" );
 
     // Custom selectors
-    tHashTimerEntry *element = NULL;
-    HASH_FIND_PTR(_hashForTimers, &target, element);
+    TimerTarget *element = findTimerTarget(target);
     if( element )
     {
         return element->paused;
     }
     
     // We should check update selectors if target does not have custom selectors
-	tHashUpdateEntry *elementUpdate = NULL;
-	HASH_FIND_PTR(_hashForUpdates, &target, elementUpdate);
-	if ( elementUpdate )
+    UpdateEntry *entry = findUpdateEntry(target);
+    if ( entry )
     {
-		return elementUpdate->entry->paused;
+        return entry->paused;
     }
     
     return false;  // should never get here
@@ -774,45 +757,28 @@ Set* Scheduler::pauseAllTargetsWithMinPriority(int nMinPriority)
     idsWithSelectors->autorelease();
 
     // Custom Selectors
-    for(tHashTimerEntry *element = _hashForTimers; element != NULL;
-        element = (tHashTimerEntry*)element->hh.next)
+    for (auto& element : _timerTargets)
     {
-        element->paused = true;
-        idsWithSelectors->addObject(element->target);
+        if (element.target)
+        {
+            element.paused = true;
+            idsWithSelectors->addObject(element.target);
+        }
     }
 
     // Updates selectors
-    tListEntry *entry, *tmp;
-    if(nMinPriority < 0) 
+    for (const auto& entries : { &_updateEntries, &_scheduledUpdates })
     {
-        DL_FOREACH_SAFE( _updatesNegList, entry, tmp ) 
+        for (auto& entry : *entries)
         {
-            if(entry->priority >= nMinPriority) 
+            if (entry.target && entry.priority >= nMinPriority)
             {
-                entry->paused = true;
-                idsWithSelectors->addObject(entry->target);
+                entry.paused = true;
+                idsWithSelectors->addObject(entry.target);
             }
         }
     }
 
-    if(nMinPriority <= 0) 
-    {
-        DL_FOREACH_SAFE( _updates0List, entry, tmp )
-        {
-            entry->paused = true;
-            idsWithSelectors->addObject(entry->target);
-        }
-    }
-
-    DL_FOREACH_SAFE( _updatesPosList, entry, tmp ) 
-    {
-        if(entry->priority >= nMinPriority) 
-        {
-            entry->paused = true;
-            idsWithSelectors->addObject(entry->target);
-        }
-    }
-
     return idsWithSelectors;
 }
 
@@ -828,6 +794,9 @@ void Scheduler::resumeTargets(Set* targetsToResume)
 // main loop
 void Scheduler::update(float dt)
 {
+    // sort the updates scheduled since the last tick
+    flushUpdateEntries();
+
     _updateHashLocked = true;
 
     if (_timeScale != 1.0f)
@@ -835,52 +804,42 @@ void Scheduler::update(float dt)
         dt *= _timeScale;
     }
 
-    // Iterate over all the Updates' selectors
-    tListEntry *entry, *tmp;
-
-    // updates with priority < 0
-    DL_FOREACH_SAFE(_updatesNegList, entry, tmp)
-    {
-        if ((! entry->paused) && (! entry->markedForDeletion))
-        {
-            entry->target->update(dt);
-        }
-    }
-
-    // updates with priority == 0
-    DL_FOREACH_SAFE(_updates0List, entry, tmp)
+    // Iterate over all the Updates' selectors, by priority.
+    // _updateEntries isn't resized while locked: new updates go to _scheduledUpdates and unscheduled ones are only marked
+    for (int i = 0, count = (int)_updateEntries.size(); i < count; ++i)
     {
-        if ((! entry->paused) && (! entry->markedForDeletion))
+        const UpdateEntry& entry = _updateEntries[i];
+        if (entry.target && (! entry.paused) && (! entry.markedForDeletion))
         {
-            entry->target->update(dt);
+            entry.target->update(dt);
         }
     }
 
-    // updates with priority > 0
-    DL_FOREACH_SAFE(_updatesPosList, entry, tmp)
+    // Iterate over all the custom selectors.
+    // _timerTargets may grow while inside this loop, so elements are accessed by index only
+    for (int i = 0; i < (int)_timerTargets.size(); ++i)
     {
-        if ((! entry->paused) && (! entry->markedForDeletion))
+        if (! _timerTargets[i].target)
         {
-            entry->target->update(dt);
+            continue;
         }
-    }
 
-    // Iterate over all the custom selectors
-    for (tHashTimerEntry *elt = _hashForTimers; elt != NULL; )
-    {
-        _currentTarget = elt;
+        _currentTarget = i;
         _currentTargetSalvaged = false;
 
-        if (! _currentTarget->paused)
+        if (! _timerTargets[i].paused)
         {
             // The 'timers' array may change while inside this loop
-            for (elt->timerIndex = 0; elt->timerIndex < elt->timers->num; ++(elt->timerIndex))
+            for (_timerTargets[i].timerIndex = 0; _timerTargets[i].timerIndex < _timerTargets[i].timers->num; ++(_timerTargets[i].timerIndex))
             {
-                elt->currentTimer = (Timer*)(elt->timers->arr[elt->timerIndex]);
+                TimerTarget *elt = &_timerTargets[i];
+                Timer *timer = (Timer*)(elt->timers->arr[elt->timerIndex]);
+                elt->currentTimer = timer;
                 elt->currentTimerSalvaged = false;
 
-                elt->currentTimer->update(dt);
+                timer->update(dt);
 
+                elt = &_timerTargets[i];
                 if (elt->currentTimerSalvaged)
                 {
                     // The currentTimer told the remove itself. To prevent the timer from
@@ -893,17 +852,21 @@ void Scheduler::update(float dt)
             }
         }
 
-        // elt, at this moment, is still valid
-        // so it is safe to ask this here (issue #490)
-        elt = (tHashTimerEntry *)elt->hh.next;
-
         // only delete currentTarget if no actions were scheduled during the cycle (issue #481)
-        if (_currentTargetSalvaged && _currentTarget->timers->num == 0)
+        if (_currentTargetSalvaged && _timerTargets[i].timers->num == 0)
         {
-            removeHashElement(_currentTarget);
+            _currentTarget = -1;
+            removeTimerTarget(i);
         }
     }
 
+    _currentTarget = -1;
+
+    if (_removedTimerTargets > 0 && _removedTimerTargets * 8 >= (int)_timerTargets.size())
+    {
+        compactTimerTargets();
+    }
+
     // Iterate over all the script callbacks
     if (_scriptHandlerEntries)
     {
@@ -922,37 +885,123 @@ void Scheduler::update(float dt)
     }
 
     // delete all updates that are marked for deletion
-    // updates with priority < 0
-    DL_FOREACH_SAFE(_updatesNegList, entry, tmp)
+    if (_markedUpdateEntries > 0)
     {
-        if (entry->markedForDeletion)
+        for (int i = 0; i < (int)_updateEntries.size(); ++i)
+        {
+            if (_updateEntries[i].target && _updateEntries[i].markedForDeletion)
+            {
+                this->removeUpdateEntry(_updateEntries[i].target);
+            }
+        }
+        for (int i = 0; i < (int)_scheduledUpdates.size(); ++i)
         {
-            this->removeUpdateFromHash(entry);
+            if (_scheduledUpdates[i].target && _scheduledUpdates[i].markedForDeletion)
+            {
+                this->removeUpdateEntry(_scheduledUpdates[i].target);
+            }
         }
     }
 
-    // updates with priority == 0
-    DL_FOREACH_SAFE(_updates0List, entry, tmp)
+    _updateHashLocked = false;
+
+    // Run the functions queued by the other threads
+    runPerformFunctions();
+}
+
+void Scheduler::performFunctionInCocosThread(const std::function<void ()> &function)
+{
+    PerformNode *node = new PerformNode();
+    node->next.store(NULL, std::memory_order_relaxed);
+    node->function = function;
+    node->queuedTime = std::chrono::steady_clock::now();
+
+    // counted before the node is linked, so the size never underflows on the cocos2d thread
+    _performQueueSize.fetch_add(1, std::memory_order_relaxed);
+
+    PerformNode *prev = _performHead.exchange(node, std::memory_order_acq_rel);
+    // between the exchange and this store the queue is "broken": the consumer sees its end early and retries next frame
+    prev->next.store(node, std::memory_order_release);
+}
+
+Scheduler::PerformNode* Scheduler::popPerformNode()
+{
+    PerformNode *tail = _performTail;
+    PerformNode *next = tail->next.load(std::memory_order_acquire);
+
+    if (tail == &_performStub)
     {
-        if (entry->markedForDeletion)
+        if (next == NULL)
         {
-            this->removeUpdateFromHash(entry);
+            return NULL;
         }
+        _performTail = next;
+        tail = next;
+        next = next->next.load(std::memory_order_acquire);
     }
 
-    // updates with priority > 0
-    DL_FOREACH_SAFE(_updatesPosList, entry, tmp)
+    if (next != NULL)
     {
-        if (entry->markedForDeletion)
-        {
-            this->removeUpdateFromHash(entry);
-        }
+        _performTail = next;
+        return tail;
     }
 
-    _updateHashLocked = false;
+    if (tail != _performHead.load(std::memory_order_acquire))
+    {
+        // a producer is linking a new node
+        return NULL;
+    }
 
-    _currentTarget = NULL;
+    // tail is the last node, put the stub back behind it so that it can be popped
+    _performStub.next.store(NULL, std::memory_order_relaxed);
+    PerformNode *prev = _performHead.exchange(&_performStub, std::memory_order_acq_rel);
+    prev->next.store(&_performStub, std::memory_order_release);
+
+    next = tail->next.load(std::memory_order_acquire);
+    if (next != NULL)
+    {
+        _performTail = next;
+        return tail;
+    }
+    return NULL;
 }
 
+void Scheduler::runPerformFunctions()
+{
+    _performQueueMaxLatency = 0.0f;
+
+    // the functions queued by the functions run below wait for the next frame
+    int count = _performQueueSize.load(std::memory_order_acquire);
+    if (count == 0)
+    {
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < count; ++i)
+    {
+        PerformNode *node = popPerformNode();
+        if (node == NULL)
+        {
+            break;
+        }
+        _performQueueSize.fetch_sub(1, std::memory_order_relaxed);
+
+        auto now = std::chrono::steady_clock::now();
+        float latency = std::chrono::duration<float>(now - node->queuedTime).count();
+        _performQueueMaxLatency = std::max(_performQueueMaxLatency, latency);
+        _performQueueAverageLatency += (latency - _performQueueAverageLatency) * 0.05f;
+
+        node->function();
+        delete node;
+
+        if (_performFunctionTimeBudget > 0 &&
+            std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count() >= _performFunctionTimeBudget)
+        {
+            break;
+        }
+    }
+}
 
 NS_CC_END
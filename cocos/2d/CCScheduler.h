@@ -29,6 +29,11 @@ THE SOFTWARE.
 
 #include "CCObject.h"
 #include "uthash.h"
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <atomic>
+#include <chrono>
 
 NS_CC_BEGIN
 
@@ -101,9 +106,7 @@ protected:
 //
 // Scheduler
 //
-struct _listEntry;
-struct _hashSelectorEntry;
-struct _hashUpdateEntry;
+struct _ccArray;
 
 class Array;
 
@@ -257,14 +260,79 @@ public:
       */
     void resumeTargets(Set* targetsToResume);
 
+    /** Calls a function on the cocos2d thread. Useful when you need to call a cocos2d function from another thread.
+     This function is thread safe and lock free. The functions are run at the end of the next Scheduler::update(), in the order
+     they were queued, until the budget set by setPerformFunctionTimeBudget() is spent. The remaining ones wait for the next frame.
+     @since v3.0
+     */
+    void performFunctionInCocosThread(const std::function<void()> &function);
+
+    /** Sets the time, in seconds, spent running the queued functions per frame. At least one function is run per frame.
+     0 runs all the functions queued before the frame. The default is 4ms.
+     @since v3.0
+     */
+    void setPerformFunctionTimeBudget(float seconds) { _performFunctionTimeBudget = seconds; }
+    float getPerformFunctionTimeBudget() const { return _performFunctionTimeBudget; }
+
+    /** Returns the number of functions waiting to be run on the cocos2d thread. Can be called from any thread.
+     @since v3.0
+     */
+    int getPerformQueueSize() const { return _performQueueSize.load(std::memory_order_relaxed); }
+
+    /** Returns the longest time, in seconds, a function run during the last frame waited in the queue.
+     @since v3.0
+     */
+    float getPerformQueueMaxLatency() const { return _performQueueMaxLatency; }
+
+    /** Returns the moving average of the time, in seconds, the functions waited in the queue.
+     @since v3.0
+     */
+    float getPerformQueueAverageLatency() const { return _performQueueAverageLatency; }
+
+protected:
+    // "update" selector of a target
+    struct UpdateEntry
+    {
+        Object *target;          // retained. NULL once unscheduled, the entry is then dropped by the next compaction
+        int priority;
+        bool paused;
+        bool markedForDeletion;  // selector will no longer be called and entry will be removed at end of the next tick
+    };
+
+    // "selectors with interval" of a target
+    struct TimerTarget
+    {
+        Object *target;          // retained. NULL once removed, the entry is then dropped by the next compaction
+        struct _ccArray *timers;
+        int timerIndex;
+        Timer *currentTimer;
+        bool currentTimerSalvaged;
+        bool paused;
+    };
+
+    // function queued by performFunctionInCocosThread()
+    struct PerformNode
+    {
+        std::atomic<PerformNode*> next;
+        std::function<void()> function;
+        std::chrono::steady_clock::time_point queuedTime;
+    };
+
 private:
-    void removeHashElement(struct _hashSelectorEntry *pElement);
-    void removeUpdateFromHash(struct _listEntry *entry);
+    UpdateEntry* findUpdateEntry(const Object *target);
+    void removeUpdateEntry(const Object *target);
+    // merges _scheduledUpdates into _updateEntries and drops the removed entries
+    void flushUpdateEntries();
 
-    // update specific
+    TimerTarget* findTimerTarget(const Object *target, int *index = NULL);
+    void removeTimerTarget(int index);
+    void compactTimerTargets();
 
-    void priorityIn(struct _listEntry **ppList, Object *target, int nPriority, bool bPaused);
-    void appendIn(struct _listEntry **ppList, Object *target, bool bPaused);
+    // pops the oldest queued function, or returns NULL if the queue is empty or a producer is in the middle of a push.
+    // Only called on the cocos2d thread, the returned node is owned by the caller
+    PerformNode* popPerformNode();
+    // runs the functions queued before the call, within _performFunctionTimeBudget
+    void runPerformFunctions();
 
 protected:
     float _timeScale;
@@ -272,18 +340,37 @@ protected:
     //
     // "updates with priority" stuff
     //
-    struct _listEntry *_updatesNegList;        // list of priority < 0
-    struct _listEntry *_updates0List;            // list priority == 0
-    struct _listEntry *_updatesPosList;        // list priority > 0
-    struct _hashUpdateEntry *_hashForUpdates; // hash used to fetch quickly the list entries for pause,delete,etc
-
-    // Used for "selectors with interval"
-    struct _hashSelectorEntry *_hashForTimers;
-    struct _hashSelectorEntry *_currentTarget;
+    // sorted by priority, in scheduling order for a same priority. Never resized during a tick
+    std::vector<UpdateEntry> _updateEntries;
+    // scheduled since the last flush, in scheduling order. Updated from the next tick
+    std::vector<UpdateEntry> _scheduledUpdates;
+    // index in _updateEntries, or -(index + 1) in _scheduledUpdates
+    std::unordered_map<const Object*, int> _updateEntryIndices;
+    int _removedUpdateEntries;
+    int _markedUpdateEntries;
+
+    // Used for "selectors with interval", in scheduling order
+    std::vector<TimerTarget> _timerTargets;
+    std::unordered_map<const Object*, int> _timerTargetIndices;
+    int _removedTimerTargets;
+    // index in _timerTargets of the target being ticked, -1 outside of the tick
+    int _currentTarget;
     bool _currentTargetSalvaged;
-    // If true unschedule will not remove anything from a hash. Elements will only be marked for deletion.
+    // If true unschedule will not remove anything. Elements will only be marked for deletion.
     bool _updateHashLocked;
     Array* _scriptHandlerEntries;
+
+    //
+    // functions performed in the cocos2d thread, intrusive MPSC queue: the producers exchange _performHead,
+    // the cocos2d thread consumes from _performTail. _performStub keeps the queue non empty
+    //
+    std::atomic<PerformNode*> _performHead;
+    PerformNode* _performTail;
+    PerformNode _performStub;
+    std::atomic<int> _performQueueSize;
+    float _performFunctionTimeBudget;
+    float _performQueueMaxLatency;
+    float _performQueueAverageLatency;
 };
 
 // end of global group
@@ -44,6 +44,7 @@ THE SOFTWARE.
 #include "CCAffineTransform.h"
 #include "TransformUtils.h"
 #include "CCProfiling.h"
+#include "CCRenderer.h"
 // external
 #include "kazmath/GL/matrix.h"
 
@@ -554,38 +555,8 @@ void Sprite::draw(void)
 
     CCASSERT(!_batchNode, "If Sprite is being rendered by SpriteBatchNode, Sprite#draw SHOULD NOT be called");
 
-    CC_NODE_DRAW_SETUP();
-    
-    GL::blendFunc( _blendFunc.src, _blendFunc.dst );
-
-    GL::bindTexture2D( _texture->getName() );
-    GL::enableVertexAttribs( GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX );
-
-#define kQuadSize sizeof(_quad.bl)
-#ifdef EMSCRIPTEN
-    long offset = 0;
-    setGLBufferData(&_quad, 4 * kQuadSize, 0);
-#else
-    long offset = (long)&_quad;
-#endif // EMSCRIPTEN
-
-    // vertex
-    int diff = offsetof( V3F_C4B_T2F, vertices);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, kQuadSize, (void*) (offset + diff));
-
-    // texCoods
-    diff = offsetof( V3F_C4B_T2F, texCoords);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 2, GL_FLOAT, GL_FALSE, kQuadSize, (void*)(offset + diff));
-    
-    // color
-    diff = offsetof( V3F_C4B_T2F, colors);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, kQuadSize, (void*)(offset + diff));
-
-
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-
-    CHECK_GL_ERROR_DEBUG();
-
+    _quadCommand.init(_texture ? _texture->getName() : 0, _shaderProgram, _blendFunc, &_quad, 1, _modelViewTransform);
+    Director::getInstance()->getRenderer()->addCommand(&_quadCommand);
 
 #if CC_SPRITE_DEBUG_DRAW == 1
     // draw bounding box
@@ -607,8 +578,6 @@ void Sprite::draw(void)
     ccDrawPoly(vertices, 4, true);
 #endif // CC_SPRITE_DEBUG_DRAW
 
-    CC_INCREMENT_GL_DRAWS(1);
-
     CC_PROFILER_STOP_CATEGORY(kProfilerCategorySprite, "CCSprite - draw");
 }
 
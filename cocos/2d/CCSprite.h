@@ -37,6 +37,7 @@ THE SOFTWARE.
 #include "CCGLBufferedNode.h"
 #endif // EMSCRIPTEN
 #include "CCPhysicsBody.h"
+#include "CCQuadCommand.h"
 
 NS_CC_BEGIN
 
@@ -571,6 +572,9 @@ protected:
     // vertex coords, texture coords and color info
     V3F_C4B_T2F_Quad _quad;
 
+    // command recorded into the renderer when the sprite is self-rendered
+    QuadCommand _quadCommand;
+
     // opacity and RGB protocol
     bool _opacityModifyRGB;
 
@@ -42,11 +42,17 @@ THE SOFTWARE.
 #include "CCProfiling.h"
 #include "CCLayer.h"
 #include "CCScene.h"
+#include "CCRenderer.h"
 // external
 #include "kazmath/GL/matrix.h"
 
 NS_CC_BEGIN
 
+// Batches with at most this number of quads send them to the renderer, which can merge them with
+// the sprites and small batches drawn around them (labels, 9-slice sprites...). Bigger batches
+// keep drawing the VBO of their texture atlas, which is only uploaded when it changes.
+static const int kMaxQuadsToMerge = 128;
+
 /*
 * creation with Texture2D
 */
@@ -121,6 +127,7 @@ bool SpriteBatchNode::initWithFile(const char* fileImage, long capacity)
 SpriteBatchNode::SpriteBatchNode()
 : _textureAtlas(NULL)
 {
+    _customCommand.func = CC_CALLBACK_0(SpriteBatchNode::onDraw, this);
 }
 
 SpriteBatchNode::~SpriteBatchNode()
@@ -389,18 +396,35 @@ void SpriteBatchNode::reorderBatch(bool reorder)
 // draw
 void SpriteBatchNode::draw(void)
 {
-    CC_PROFILER_START("CCSpriteBatchNode - draw");
-
     // Optimization: Fast Dispatch
     if( _textureAtlas->getTotalQuads() == 0 )
     {
         return;
     }
 
-    CC_NODE_DRAW_SETUP();
-
     arrayMakeObjectsPerformSelector(_children, updateTransform, Sprite*);
 
+    Renderer *renderer = Director::getInstance()->getRenderer();
+    int totalQuads = _textureAtlas->getTotalQuads();
+
+    if (totalQuads <= kMaxQuadsToMerge)
+    {
+        _quadCommand.init(_textureAtlas->getTexture()->getName(), _shaderProgram, _blendFunc, _textureAtlas->getQuads(), totalQuads, _modelViewTransform);
+        renderer->addCommand(&_quadCommand);
+    }
+    else
+    {
+        _customCommand.init(_modelViewTransform);
+        renderer->addCommand(&_customCommand);
+    }
+}
+
+void SpriteBatchNode::onDraw()
+{
+    CC_PROFILER_START("CCSpriteBatchNode - draw");
+
+    CC_NODE_DRAW_SETUP();
+
     GL::blendFunc( _blendFunc.src, _blendFunc.dst );
 
     _textureAtlas->drawQuads();
@@ -34,6 +34,8 @@ THE SOFTWARE.
 #include "CCProtocols.h"
 #include "CCTextureAtlas.h"
 #include "ccMacros.h"
+#include "CCCustomCommand.h"
+#include "CCQuadCommand.h"
 
 NS_CC_BEGIN
 
@@ -183,6 +185,7 @@ protected:
     void updateAtlasIndex(Sprite* sprite, int* curIndex);
     void swap(int oldIndex, int newIndex);
     void updateBlendFunc();
+    void onDraw();
 
     TextureAtlas *_textureAtlas;
     BlendFunc _blendFunc;
@@ -191,6 +194,9 @@ protected:
     // There is not need to retain/release these objects, since they are already retained by _children
     // So, using std::vector<Sprite*> is slightly faster than using cocos2d::Array for this particular case
     std::vector<Sprite*> _descendants;
+
+    CustomCommand _customCommand;
+    QuadCommand _quadCommand;
 };
 
 // end of sprite_nodes group
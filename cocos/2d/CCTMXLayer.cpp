@@ -33,8 +33,16 @@ THE SOFTWARE.
 #include "ccCArray.h"
 #include "CCDirector.h"
 
+#include <algorithm>
+#include <vector>
+
 NS_CC_BEGIN
 
+// width and height of the chunks of tiles, in tiles
+static const int TMX_CHUNK_SIZE = 16;
+// the atlas only contains the quads of the visible chunks, so it doesn't need to be as big as the layer
+static const int TMX_MAX_INITIAL_CAPACITY = 1024;
+
 
 // TMXLayer - init & alloc & dealloc
 
@@ -53,7 +61,7 @@ bool TMXLayer::initWithTilesetInfo(TMXTilesetInfo *tilesetInfo, TMXLayerInfo *la
     // XXX: is 35% a good estimate ?
     Size size = layerInfo->_layerSize;
     float totalNumberOfTiles = size.width * size.height;
-    float capacity = totalNumberOfTiles * 0.35f + 1; // 35 percent is occupied ?
+    float capacity = MIN(totalNumberOfTiles * 0.35f + 1, (float)TMX_MAX_INITIAL_CAPACITY); // 35 percent is occupied ?
 
     Texture2D *texture = NULL;
     if( tilesetInfo )
@@ -85,7 +93,7 @@ bool TMXLayer::initWithTilesetInfo(TMXTilesetInfo *tilesetInfo, TMXLayerInfo *la
         Point offset = this->calculateLayerOffset(layerInfo->_offset);
         this->setPosition(CC_POINT_PIXELS_TO_POINTS(offset));
 
-        _atlasIndexArray = ccCArrayNew((unsigned int)totalNumberOfTiles);
+        _atlasIndexArray = ccCArrayNew((unsigned int)capacity);
 
         this->setContentSize(CC_SIZE_PIXELS_TO_POINTS(Size(_layerSize.width * _mapTileSize.width, _layerSize.height * _mapTileSize.height)));
 
@@ -113,6 +121,11 @@ TMXLayer::TMXLayer()
 ,_tileSet(NULL)
 ,_layerOrientation(TMXOrientationOrtho)
 ,_properties(NULL)
+,_chunkMinX(0)
+,_chunkMinY(0)
+,_chunkMaxX(-1)
+,_chunkMaxY(-1)
+,_useChunks(true)
 {}
 
 TMXLayer::~TMXLayer()
@@ -132,6 +145,13 @@ TMXLayer::~TMXLayer()
 
 void TMXLayer::releaseMap()
 {
+    // the quads can't be rebuilt without the map anymore
+    if (_tiles && _useChunks)
+    {
+        setupChunks(0, 0, ((int)_layerSize.width - 1) / TMX_CHUNK_SIZE, ((int)_layerSize.height - 1) / TMX_CHUNK_SIZE);
+        _useChunks = false;
+    }
+
     if (_tiles)
     {
         delete [] _tiles;
@@ -163,28 +183,24 @@ void TMXLayer::setupTiles()
     // Parse cocos2d properties
     this->parseInternalProperties();
 
-    for (unsigned int y=0; y < _layerSize.height; y++) 
+    // The quads are only created for the visible chunks, when the layer is drawn
+    unsigned int totalNumberOfTiles = (unsigned int)(_layerSize.width * _layerSize.height);
+    for (unsigned int pos = 0; pos < totalNumberOfTiles; pos++)
     {
-        for (unsigned int x=0; x < _layerSize.width; x++) 
-        {
-            unsigned int pos = (unsigned int)(x + _layerSize.width * y);
-            unsigned int gid = _tiles[ pos ];
+        unsigned int gid = _tiles[ pos ];
 
-            // gid are stored in little endian.
-            // if host is big endian, then swap
-            //if( o == CFByteOrderBigEndian )
-            //    gid = CFSwapInt32( gid );
-            /* We support little endian.*/
-
-            // XXX: gid == 0 --> empty tile
-            if (gid != 0) 
-            {
-                this->appendTileForGID(gid, Point(x, y));
+        // gid are stored in little endian.
+        // if host is big endian, then swap
+        //if( o == CFByteOrderBigEndian )
+        //    gid = CFSwapInt32( gid );
+        /* We support little endian.*/
 
-                // Optimization: update min and max GID rendered by the layer
-                _minGID = MIN(gid, _minGID);
-                _maxGID = MAX(gid, _maxGID);
-            }
+        // XXX: gid == 0 --> empty tile
+        if (gid != 0) 
+        {
+            // Optimization: update min and max GID rendered by the layer
+            _minGID = MIN(gid, _minGID);
+            _maxGID = MAX(gid, _maxGID);
         }
     }
 
@@ -343,6 +359,12 @@ Sprite * TMXLayer::getTileAt(const Point& pos)
             tile->setAnchorPoint(Point::ZERO);
             tile->setOpacity(_opacity);
 
+            // the tile is out of the visible chunks
+            if (! hasQuadForZ(z))
+            {
+                insertTileForGID(_tiles[z], pos);
+            }
+
             unsigned int indexForZ = atlasIndexForExistantZ(z);
             this->addSpriteWithoutQuad(tile, indexForZ, z);
             tile->release();
@@ -431,33 +453,6 @@ Sprite * TMXLayer::updateTileForGID(unsigned int gid, const Point& pos)
     return tile;
 }
 
-// used only when parsing the map. useless after the map was parsed
-// since lot's of assumptions are no longer true
-Sprite * TMXLayer::appendTileForGID(unsigned int gid, const Point& pos)
-{
-    Rect rect = _tileSet->rectForGID(gid);
-    rect = CC_RECT_PIXELS_TO_POINTS(rect);
-
-    intptr_t z = (intptr_t)(pos.x + pos.y * _layerSize.width);
-
-    Sprite *tile = reusedTileWithRect(rect);
-
-    setupTileSprite(tile ,pos ,gid);
-
-    // optimization:
-    // The difference between appendTileForGID and insertTileforGID is that append is faster, since
-    // it appends the tile at the end of the texture atlas
-    unsigned int indexForZ = _atlasIndexArray->num;
-
-    // don't add it using the "standard" way.
-    insertQuadFromSprite(tile, indexForZ);
-
-    // append should be after addQuadFromSprite since it modifies the quantity values
-    ccCArrayInsertValueAtIndex(_atlasIndexArray, (void*)z, indexForZ);
-
-    return tile;
-}
-
 // TMXLayer - atlasIndex and Z
 static inline int compareInts(const void * a, const void * b)
 {
@@ -473,6 +468,12 @@ unsigned int TMXLayer::atlasIndexForExistantZ(unsigned int z)
     int index = ((size_t)item - (size_t)_atlasIndexArray->arr) / sizeof(void*);
     return index;
 }
+bool TMXLayer::hasQuadForZ(unsigned int z)
+{
+    int key=z;
+    return bsearch((void*)&key, (void*)&_atlasIndexArray->arr[0], _atlasIndexArray->num, sizeof(void*), compareInts) != NULL;
+}
+
 unsigned int TMXLayer::atlasIndexForNewZ(int z)
 {
     // XXX: This can be improved with a sort of binary search
@@ -513,17 +514,28 @@ void TMXLayer::setTileGID(unsigned int gid, const Point& pos, ccTMXTileFlags fla
         {
             removeTileAt(pos);
         }
-        // empty tile. create a new one
+        // empty tile. create a new one, unless it isn't visible
         else if (currentGID == 0)
         {
-            insertTileForGID(gidAndFlags, pos);
+            if (isInChunks(pos))
+            {
+                insertTileForGID(gidAndFlags, pos);
+            }
+            else
+            {
+                _tiles[(int)(pos.x + pos.y * _layerSize.width)] = gidAndFlags;
+            }
         }
         // modifying an existing tile with a non-empty tile
         else 
         {
             unsigned int z = (unsigned int)(pos.x + pos.y * _layerSize.width);
             Sprite *sprite = static_cast<Sprite*>(getChildByTag(z));
-            if (sprite)
+            if (! sprite && ! hasQuadForZ(z))
+            {
+                _tiles[z] = gidAndFlags;
+            }
+            else if (sprite)
             {
                 Rect rect = _tileSet->rectForGID(gid);
                 rect = CC_RECT_PIXELS_TO_POINTS(rect);
@@ -579,6 +591,14 @@ void TMXLayer::removeTileAt(const Point& pos)
     if (gid) 
     {
         unsigned int z = (unsigned int)(pos.x + pos.y * _layerSize.width);
+
+        // the tile isn't visible, it has no quad
+        if (! hasQuadForZ(z))
+        {
+            _tiles[z] = 0;
+            return;
+        }
+
         unsigned int atlasIndex = atlasIndexForExistantZ(z);
 
         // remove tile from GID map
@@ -618,6 +638,256 @@ void TMXLayer::removeTileAt(const Point& pos)
     }
 }
 
+// TMXLayer - chunks
+void TMXLayer::draw()
+{
+    if (_useChunks)
+    {
+        updateVisibleChunks();
+    }
+
+    SpriteBatchNode::draw();
+}
+
+bool TMXLayer::isInChunks(const Point& pos) const
+{
+    if (! _useChunks)
+    {
+        return true;
+    }
+
+    int x = (int)pos.x / TMX_CHUNK_SIZE;
+    int y = (int)pos.y / TMX_CHUNK_SIZE;
+    return x >= _chunkMinX && x <= _chunkMaxX && y >= _chunkMinY && y <= _chunkMaxY;
+}
+
+void TMXLayer::updateVisibleChunks()
+{
+    int width = (int)_layerSize.width;
+    int height = (int)_layerSize.height;
+    if (width == 0 || height == 0)
+    {
+        return;
+    }
+
+    // visible rect of the director, in the space of the layer
+    Director *director = Director::getInstance();
+    Point origin = director->getVisibleOrigin();
+    Size size = director->getVisibleSize();
+    AffineTransform worldToNode = getWorldToNodeTransform();
+    Point corners[4] = {
+        origin,
+        Point(origin.x + size.width, origin.y),
+        Point(origin.x, origin.y + size.height),
+        Point(origin.x + size.width, origin.y + size.height)
+    };
+
+    // tile coordinates of the corners. They are linear functions of the position, so the corners bound the visible tiles
+    float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+    for (int i = 0; i < 4; ++i)
+    {
+        Point pos = CC_POINT_POINTS_TO_PIXELS(PointApplyAffineTransform(corners[i], worldToNode));
+        float x = 0, y = 0;
+        switch (_layerOrientation)
+        {
+        case TMXOrientationOrtho:
+            x = pos.x / _mapTileSize.width;
+            y = _layerSize.height - pos.y / _mapTileSize.height;
+            break;
+        case TMXOrientationIso:
+            {
+                // inverse of getPositionForIsoAt()
+                float diff = pos.x * 2 / _mapTileSize.width - _layerSize.width + 1;
+                float sum = _layerSize.height * 2 - 2 - pos.y * 2 / _mapTileSize.height;
+                x = (sum + diff) / 2;
+                y = (sum - diff) / 2;
+            }
+            break;
+        case TMXOrientationHex:
+            x = pos.x / (_mapTileSize.width * 3 / 4);
+            y = _layerSize.height - pos.y / _mapTileSize.height;
+            break;
+        }
+        minX = MIN(minX, x);
+        maxX = MAX(maxX, x);
+        minY = MIN(minY, y);
+        maxY = MAX(maxY, y);
+    }
+
+    // the tiles of the tileset may be bigger than the tiles of the map, and overlap the next ones
+    int margin = 1 + (int)ceilf(MAX(_tileSet->_tileSize.width / _mapTileSize.width, _tileSet->_tileSize.height / _mapTileSize.height));
+    int tileMinX = MAX(0, (int)floorf(clampf(minX, -1, (float)width)) - margin);
+    int tileMinY = MAX(0, (int)floorf(clampf(minY, -1, (float)height)) - margin);
+    int tileMaxX = MIN(width - 1, (int)floorf(clampf(maxX, -1, (float)width)) + margin);
+    int tileMaxY = MIN(height - 1, (int)floorf(clampf(maxY, -1, (float)height)) + margin);
+
+    int chunkMinX = 0, chunkMinY = 0, chunkMaxX = -1, chunkMaxY = -1;
+    if (tileMinX <= tileMaxX && tileMinY <= tileMaxY)
+    {
+        chunkMinX = tileMinX / TMX_CHUNK_SIZE;
+        chunkMinY = tileMinY / TMX_CHUNK_SIZE;
+        chunkMaxX = tileMaxX / TMX_CHUNK_SIZE;
+        chunkMaxY = tileMaxY / TMX_CHUNK_SIZE;
+    }
+
+    if (chunkMinX != _chunkMinX || chunkMinY != _chunkMinY || chunkMaxX != _chunkMaxX || chunkMaxY != _chunkMaxY)
+    {
+        setupChunks(chunkMinX, chunkMinY, chunkMaxX, chunkMaxY);
+    }
+}
+
+void TMXLayer::setupChunks(int minX, int minY, int maxX, int maxY)
+{
+    _chunkMinX = minX;
+    _chunkMinY = minY;
+    _chunkMaxX = maxX;
+    _chunkMaxY = maxY;
+
+    int width = (int)_layerSize.width;
+    int tileMinX = minX * TMX_CHUNK_SIZE;
+    int tileMinY = minY * TMX_CHUNK_SIZE;
+    int tileMaxX = MIN(width - 1, (maxX + 1) * TMX_CHUNK_SIZE - 1);
+    int tileMaxY = MIN((int)_layerSize.height - 1, (maxY + 1) * TMX_CHUNK_SIZE - 1);
+
+    // the tiles which became a sprite keep their quad, wherever they are
+    std::vector<std::pair<unsigned int, Sprite*> > sprites;
+    if (_children)
+    {
+        sprites.reserve(_children->count());
+        Object* pObject = nullptr;
+        CCARRAY_FOREACH(_children, pObject)
+        {
+            Sprite* child = static_cast<Sprite*>(pObject);
+            sprites.push_back(std::make_pair((unsigned int)child->getTag(), child));
+        }
+        std::sort(sprites.begin(), sprites.end());
+    }
+
+    long maxQuads = (long)sprites.size();
+    if (tileMinX <= tileMaxX && tileMinY <= tileMaxY)
+    {
+        maxQuads += (long)(tileMaxX - tileMinX + 1) * (tileMaxY - tileMinY + 1);
+    }
+    if (maxQuads > _textureAtlas->getCapacity())
+    {
+        _textureAtlas->resizeCapacity(maxQuads * 4 / 3);
+    }
+    ccCArrayRemoveAllValues(_atlasIndexArray);
+    ccCArrayEnsureExtraCapacity(_atlasIndexArray, maxQuads + 1);
+    _textureAtlas->removeAllQuads();
+
+    // the quads are sorted by z, like the atlas index array
+    V3F_C4B_T2F_Quad *quads = _textureAtlas->getQuads();
+    long count = 0;
+    size_t nextSprite = 0;
+    auto appendSprite = [&] () {
+        Sprite *sprite = sprites[nextSprite].second;
+        quads[count] = sprite->getQuad();
+        sprite->setAtlasIndex(count);
+        sprite->setDirty(true);
+        ccCArrayAppendValue(_atlasIndexArray, (void*)(intptr_t)sprites[nextSprite].first);
+        ++count;
+        ++nextSprite;
+    };
+
+    for (int y = tileMinY; y <= tileMaxY; ++y)
+    {
+        for (int x = tileMinX; x <= tileMaxX; ++x)
+        {
+            unsigned int z = (unsigned int)(x + y * width);
+            while (nextSprite < sprites.size() && sprites[nextSprite].first < z)
+            {
+                appendSprite();
+            }
+
+            if (nextSprite < sprites.size() && sprites[nextSprite].first == z)
+            {
+                appendSprite();
+            }
+            else if (_tiles[z] != 0)
+            {
+                setupTileQuad(&quads[count], _tiles[z], Point(x, y));
+                ccCArrayAppendValue(_atlasIndexArray, (void*)(intptr_t)z);
+                ++count;
+            }
+        }
+    }
+    while (nextSprite < sprites.size())
+    {
+        appendSprite();
+    }
+
+    _textureAtlas->increaseTotalQuadsWith(count);
+    _textureAtlas->setDirty(true);
+}
+
+// same quad as the one of a Sprite set up by setupTileSprite()
+void TMXLayer::setupTileQuad(V3F_C4B_T2F_Quad *quad, unsigned int gid, const Point& pos)
+{
+    Texture2D *texture = _textureAtlas->getTexture();
+    Rect rect = _tileSet->rectForGID(gid);
+
+    float atlasWidth = (float)texture->getPixelsWide();
+    float atlasHeight = (float)texture->getPixelsHigh();
+#if CC_FIX_ARTIFACTS_BY_STRECHING_TEXEL
+    float left      = (2*rect.origin.x+1)/(2*atlasWidth);
+    float right     = left + (rect.size.width*2-2)/(2*atlasWidth);
+    float top       = (2*rect.origin.y+1)/(2*atlasHeight);
+    float bottom    = top + (rect.size.height*2-2)/(2*atlasHeight);
+#else
+    float left      = rect.origin.x/atlasWidth;
+    float right     = (rect.origin.x + rect.size.width) / atlasWidth;
+    float top       = rect.origin.y/atlasHeight;
+    float bottom    = (rect.origin.y + rect.size.height) / atlasHeight;
+#endif // CC_FIX_ARTIFACTS_BY_STRECHING_TEXEL
+
+    // The diagonal flag rotates the tile, see setupTileSprite(). Corner (x, y) of the quad,
+    // from the top left one, shows the texel (u, v) of the tile
+    bool diagonal = (gid & kTMXTileDiagonalFlag) != 0;
+    bool horizontal = (gid & kTMXTileHorizontalFlag) != 0;
+    bool vertical = (gid & kTMXTileVerticalFlag) != 0;
+    auto texCoords = [&] (int x, int y) -> Tex2F {
+        int u, v;
+        if (diagonal)
+        {
+            u = vertical ? 1 - y : y;
+            v = horizontal ? 1 - x : x;
+        }
+        else
+        {
+            u = horizontal ? 1 - x : x;
+            v = vertical ? 1 - y : y;
+        }
+        return Tex2F(u ? right : left, v ? bottom : top);
+    };
+    quad->tl.texCoords = texCoords(0, 0);
+    quad->bl.texCoords = texCoords(0, 1);
+    quad->tr.texCoords = texCoords(1, 0);
+    quad->br.texCoords = texCoords(1, 1);
+
+    Size size = CC_SIZE_PIXELS_TO_POINTS(rect.size);
+    if (diagonal)
+    {
+        std::swap(size.width, size.height);
+    }
+    Point origin = getPositionAt(pos);
+    float vertexZ = (float)getVertexZForPos(pos);
+    quad->bl.vertices = Vertex3F(origin.x, origin.y, vertexZ);
+    quad->br.vertices = Vertex3F(origin.x + size.width, origin.y, vertexZ);
+    quad->tl.vertices = Vertex3F(origin.x, origin.y + size.height, vertexZ);
+    quad->tr.vertices = Vertex3F(origin.x + size.width, origin.y + size.height, vertexZ);
+
+    Color4B color(255, 255, 255, _opacity);
+    if (texture->hasPremultipliedAlpha())
+    {
+        color = Color4B(_opacity, _opacity, _opacity, _opacity);
+    }
+    quad->bl.colors = color;
+    quad->br.colors = color;
+    quad->tl.colors = color;
+    quad->tr.colors = color;
+}
+
 //CCTMXLayer - obtaining positions, offset
 Point TMXLayer::calculateLayerOffset(const Point& pos)
 {
@@ -47,6 +47,10 @@ struct _ccCArray;
 
 It is a subclass of SpriteBatchNode. By default the tiles are rendered using a TextureAtlas.
 If you modify a tile on runtime, then, that tile will become a Sprite, otherwise no Sprite objects are created.
+
+The layer is split in chunks of tiles, and the TextureAtlas only contains the quads of the chunks which intersect
+the visible rect of the Director (and of the tiles which became a Sprite). The quads are rebuilt when the view scrolls
+to other chunks. The tiles which are off screen are only stored as GIDs.
 The benefits of using Sprite objects as tiles are:
 - tiles (Sprite) can be rotated/scaled/moved with a nice API
 
@@ -93,6 +97,7 @@ public:
     /** dealloc the map that contains the tile position from memory.
     Unless you want to know at runtime the tiles positions, you can safely call this method.
     If you are going to call layer->tileGIDAt() then, don't release the map
+    Since the quads can't be rebuilt without the map, the quads of all the tiles are created first: don't call it on big layers.
     */
     void releaseMap();
 
@@ -189,6 +194,7 @@ public:
     virtual void addChild(Node * child, int zOrder, int tag) override;
     // super method
     void removeChild(Node* child, bool cleanup) override;
+    virtual void draw(void) override;
 
 
 private:
@@ -199,7 +205,6 @@ private:
     Point calculateLayerOffset(const Point& offset);
 
     /* optimization methods */
-    Sprite* appendTileForGID(unsigned int gid, const Point& pos);
     Sprite* insertTileForGID(unsigned int gid, const Point& pos);
     Sprite* updateTileForGID(unsigned int gid, const Point& pos);
 
@@ -212,6 +217,17 @@ private:
     // index
     unsigned int atlasIndexForExistantZ(unsigned int z);
     unsigned int atlasIndexForNewZ(int z);
+    // whether the tile has a quad in the atlas
+    bool hasQuadForZ(unsigned int z);
+    // whether the tile is in the chunks which have their quads in the atlas
+    bool isInChunks(const Point& pos) const;
+
+    /* chunks */
+    // rebuilds the quads if the chunks intersecting the visible rect changed
+    void updateVisibleChunks();
+    // fills the atlas with the quads of the tiles of the chunks, and of the tiles which are children
+    void setupChunks(int minX, int minY, int maxX, int maxY);
+    void setupTileQuad(V3F_C4B_T2F_Quad *quad, unsigned int gid, const Point& pos);
     
 protected:
     //! name of the layer
@@ -245,6 +261,14 @@ protected:
     unsigned int _layerOrientation;
     /** properties from the layer. They can be added using Tiled */
     Dictionary* _properties;
+
+    //! chunks whose tiles have a quad in the atlas, in chunks. Empty when _chunkMinX > _chunkMaxX
+    int _chunkMinX;
+    int _chunkMinY;
+    int _chunkMaxX;
+    int _chunkMaxY;
+    //! false once all the tiles have a quad, the chunks aren't updated anymore
+    bool _useChunks;
 };
 
 // end of tilemap_parallax_nodes group
@@ -31,8 +31,10 @@ THE SOFTWARE.
 #include "CCTMXTiledMap.h"
 #include "ccMacros.h"
 #include "platform/CCFileUtils.h"
-#include "ZipUtils.h"
-#include "base64.h"
+
+#include <unordered_map>
+#include <vector>
+#include <zlib.h>
 
 using namespace std;
 
@@ -47,6 +49,181 @@ static const char* valueForKey(const char *key, std::map<std::string, std::strin
     }
     return "";
 }
+
+// Decodes the base64, and optionally zlib or gzip compressed, layer data as it is parsed.
+// The text is decoded by small chunks, and inflated straight into the tiles of the layer
+struct TMXTileDataDecoder
+{
+    TMXTileDataDecoder(unsigned char *out, unsigned long outLength, bool compressed)
+    : _out(out)
+    , _outLength(outLength)
+    , _outPosition(0)
+    , _compressed(compressed)
+    , _streamEnded(false)
+    , _error(false)
+    , _bits(0)
+    , _charCount(0)
+    , _padded(false)
+    , _chunkLength(0)
+    {
+        static const unsigned char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        memset(_decoder, 0xff, sizeof(_decoder));
+        for (int i = 0; i < 64; ++i)
+        {
+            _decoder[alphabet[i]] = (unsigned char)i;
+        }
+
+        if (_compressed)
+        {
+            memset(&_stream, 0, sizeof(_stream));
+            // 15 window bits, +32 to detect zlib or gzip headers
+            _error = inflateInit2(&_stream, 15 + 32) != Z_OK;
+        }
+    }
+
+    ~TMXTileDataDecoder()
+    {
+        if (_compressed)
+        {
+            inflateEnd(&_stream);
+        }
+    }
+
+    void write(const char *text, int length)
+    {
+        for (int i = 0; i < length && ! _padded; ++i)
+        {
+            unsigned char c = (unsigned char)text[i];
+            if (c == '=')
+            {
+                _padded = true;
+                break;
+            }
+            if (_decoder[c] == 0xff)
+            {
+                // white spaces
+                continue;
+            }
+
+            _bits = (_bits << 6) | _decoder[c];
+            if (++_charCount == 4)
+            {
+                append((unsigned char)(_bits >> 16));
+                append((unsigned char)(_bits >> 8));
+                append((unsigned char)_bits);
+                _bits = 0;
+                _charCount = 0;
+            }
+        }
+    }
+
+    // returns the number of bytes written into the output, or -1 on errors
+    long finish()
+    {
+        switch (_charCount)
+        {
+        case 0:
+            break;
+        case 2:
+            append((unsigned char)(_bits >> 4));
+            break;
+        case 3:
+            append((unsigned char)(_bits >> 10));
+            append((unsigned char)(_bits >> 2));
+            break;
+        default:
+            CCLOG("cocos2d: TiledMap: base64 encoding incomplete");
+            _error = true;
+            break;
+        }
+        flush();
+
+        if (_compressed && ! _streamEnded)
+        {
+            _error = true;
+        }
+        return _error ? -1 : (long)_outPosition;
+    }
+
+private:
+    void append(unsigned char byte)
+    {
+        _chunk[_chunkLength++] = byte;
+        if (_chunkLength == sizeof(_chunk))
+        {
+            flush();
+        }
+    }
+
+    void flush()
+    {
+        if (_error || _chunkLength == 0)
+        {
+            _chunkLength = 0;
+            return;
+        }
+
+        if (! _compressed)
+        {
+            if (_outPosition + _chunkLength > _outLength)
+            {
+                _error = true;
+            }
+            else
+            {
+                memcpy(_out + _outPosition, _chunk, _chunkLength);
+                _outPosition += _chunkLength;
+            }
+        }
+        else if (! _streamEnded)
+        {
+            _stream.next_in = _chunk;
+            _stream.avail_in = (uInt)_chunkLength;
+            while (_stream.avail_in > 0)
+            {
+                _stream.next_out = _out + _outPosition;
+                _stream.avail_out = (uInt)(_outLength - _outPosition);
+                int err = inflate(&_stream, Z_NO_FLUSH);
+                _outPosition = _outLength - _stream.avail_out;
+
+                if (err == Z_STREAM_END)
+                {
+                    _streamEnded = true;
+                    break;
+                }
+                if (err != Z_OK)
+                {
+                    // includes Z_BUF_ERROR: the layer is smaller than the inflated data
+                    _error = true;
+                    break;
+                }
+            }
+        }
+        _chunkLength = 0;
+    }
+
+    unsigned char *_out;
+    unsigned long _outLength;
+    unsigned long _outPosition;
+
+    bool _compressed;
+    z_stream _stream;
+    bool _streamEnded;
+    bool _error;
+
+    unsigned char _decoder[256];
+    unsigned int _bits;
+    int _charCount;
+    bool _padded;
+
+    unsigned char _chunk[4096];
+    unsigned long _chunkLength;
+};
+
+// decoded tiles of the base64 layers, by "full path of the map:index of the layer"
+static bool s_tileDataCacheEnabled = false;
+static std::unordered_map<std::string, std::vector<unsigned int> > s_tileDataCache;
+
 // implementation TMXLayerInfo
 TMXLayerInfo::TMXLayerInfo()
 : _name("")
@@ -192,6 +369,7 @@ TMXMapInfo::TMXMapInfo()
 , _properties(NULL)
 , _tileProperties(NULL)
 , _currentFirstGID(0)
+, _tileDataDecoder(NULL)
 {
 }
 
@@ -203,6 +381,7 @@ TMXMapInfo::~TMXMapInfo()
     CC_SAFE_RELEASE(_properties);
     CC_SAFE_RELEASE(_tileProperties);
     CC_SAFE_RELEASE(_objectGroups);
+    CC_SAFE_DELETE(_tileDataDecoder);
 }
 
 bool TMXMapInfo::parseXMLString(const std::string& xmlString)
@@ -480,7 +659,6 @@ void TMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
         {
             int layerAttribs = pTMXMapInfo->getLayerAttribs();
             pTMXMapInfo->setLayerAttribs(layerAttribs | TMXLayerAttribBase64);
-            pTMXMapInfo->setStoringCharacters(true);
 
             if( compression == "gzip" )
             {
@@ -493,6 +671,34 @@ void TMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
                 pTMXMapInfo->setLayerAttribs(layerAttribs | TMXLayerAttribZlib);
             }
             CCASSERT( compression == "" || compression == "gzip" || compression == "zlib", "TMX: unsupported compression method" );
+
+            TMXLayerInfo* layer = (TMXLayerInfo*)pTMXMapInfo->getLayers()->getLastObject();
+            Size layerSize = layer->_layerSize;
+            int tilesAmount = layerSize.width * layerSize.height;
+
+            // tiles are decoded straight into the layer, while the text is parsed
+            layer->_tiles = new unsigned int[tilesAmount]();
+
+            bool isCached = false;
+            if (s_tileDataCacheEnabled && ! _TMXFileName.empty())
+            {
+                char key[16];
+                snprintf(key, sizeof(key), ":%d", (int)pTMXMapInfo->getLayers()->count() - 1);
+                auto it = s_tileDataCache.find(_TMXFileName + key);
+                if (it != s_tileDataCache.end() && it->second.size() == (size_t)tilesAmount)
+                {
+                    memcpy(layer->_tiles, it->second.data(), tilesAmount * sizeof(unsigned int));
+                    isCached = true;
+                }
+            }
+
+            CC_SAFE_DELETE(_tileDataDecoder);
+            if (! isCached)
+            {
+                _tileDataDecoder = new TMXTileDataDecoder((unsigned char*)layer->_tiles, tilesAmount * sizeof(unsigned int),
+                                                          compression == "gzip" || compression == "zlib");
+                pTMXMapInfo->setStoringCharacters(true);
+            }
         }
 
     } 
@@ -738,47 +944,36 @@ void TMXMapInfo::endElement(void *ctx, const char *name)
         if (pTMXMapInfo->getLayerAttribs() & TMXLayerAttribBase64)
         {
             pTMXMapInfo->setStoringCharacters(false);
-            
-            TMXLayerInfo* layer = (TMXLayerInfo*)pTMXMapInfo->getLayers()->getLastObject();
-            
-            std::string currentString = pTMXMapInfo->getCurrentString();
-            unsigned char *buffer;
-            len = base64Decode((unsigned char*)currentString.c_str(), (unsigned int)currentString.length(), &buffer);
-            if( ! buffer )
+
+            // the tiles of the layer were found in the cache
+            if (! _tileDataDecoder)
             {
-                CCLOG("cocos2d: TiledMap: decode data error");
                 return;
             }
-            
-            if( pTMXMapInfo->getLayerAttribs() & (TMXLayerAttribGzip | TMXLayerAttribZlib) )
+
+            TMXLayerInfo* layer = (TMXLayerInfo*)pTMXMapInfo->getLayers()->getLastObject();
+            Size layerSize = layer->_layerSize;
+            int tilesAmount = layerSize.width * layerSize.height;
+
+            len = (int)_tileDataDecoder->finish();
+            CC_SAFE_DELETE(_tileDataDecoder);
+
+            if (len < 0)
             {
-                unsigned char *deflated;
-                Size s = layer->_layerSize;
-                // int sizeHint = s.width * s.height * sizeof(uint32_t);
-                int sizeHint = (int)(s.width * s.height * sizeof(unsigned int));
-                
-                int inflatedLen = ZipUtils::ccInflateMemoryWithHint(buffer, len, &deflated, sizeHint);
-                CCASSERT(inflatedLen == sizeHint, "");
-                
-                inflatedLen = (size_t)&inflatedLen; // XXX: to avoid warnings in compiler
-                
-                delete [] buffer;
-                buffer = NULL;
-                
-                if( ! deflated )
-                {
-                    CCLOG("cocos2d: TiledMap: inflate data error");
-                    return;
-                }
-                
-                layer->_tiles = (unsigned int*) deflated;
+                CCLOG("cocos2d: TiledMap: decode data error");
+                // like before the tiles were decoded while parsing, a layer which failed to decode has no tiles
+                delete [] layer->_tiles;
+                layer->_tiles = NULL;
+                return;
             }
-            else
+            CCASSERT(len == (int)(tilesAmount * sizeof(unsigned int)), "TMX: invalid layer data size");
+
+            if (s_tileDataCacheEnabled && ! _TMXFileName.empty())
             {
-                layer->_tiles = (unsigned int*) buffer;
+                char key[16];
+                snprintf(key, sizeof(key), ":%d", (int)pTMXMapInfo->getLayers()->count() - 1);
+                s_tileDataCache[_TMXFileName + key].assign(layer->_tiles, layer->_tiles + tilesAmount);
             }
-            
-            pTMXMapInfo->setCurrentString("");
         }
         else if (pTMXMapInfo->getLayerAttribs() & TMXLayerAttribNone)
         {
@@ -820,15 +1015,31 @@ void TMXMapInfo::textHandler(void *ctx, const char *ch, int len)
 {
     CC_UNUSED_PARAM(ctx);
     TMXMapInfo *pTMXMapInfo = this;
-    std::string pText((char*)ch,0,len);
 
-    if (pTMXMapInfo->isStoringCharacters())
+    if (pTMXMapInfo->isStoringCharacters() && _tileDataDecoder)
+    {
+        _tileDataDecoder->write(ch, len);
+    }
+}
+
+void TMXMapInfo::setTileDataCacheEnabled(bool enabled)
+{
+    s_tileDataCacheEnabled = enabled;
+    if (! enabled)
     {
-        std::string currentString = pTMXMapInfo->getCurrentString();
-        currentString += pText;
-        pTMXMapInfo->setCurrentString(currentString.c_str());
+        purgeTileDataCache();
     }
 }
 
+bool TMXMapInfo::isTileDataCacheEnabled()
+{
+    return s_tileDataCacheEnabled;
+}
+
+void TMXMapInfo::purgeTileDataCache()
+{
+    s_tileDataCache.clear();
+}
+
 NS_CC_END
 
@@ -38,6 +38,7 @@ THE SOFTWARE.
 NS_CC_BEGIN
 
 class TMXObjectGroup;
+struct TMXTileDataDecoder;
 
 /** @file
 * Internal TMX parser
@@ -190,6 +191,17 @@ public:
     bool initWithXML(const std::string& tmxString, const std::string& resourcePath);
     /** initializes parsing of an XML file, either a tmx (Map) file or tsx (Tileset) file */
     bool parseXMLFile(const std::string& xmlFilename);
+
+    /** Keeps a copy of the decoded tiles of the base64 layers of the maps loaded from a file, so that loading the maps again
+     skips the decoding and the decompression of the layers. Disabled by default.
+     @since v3.0
+     */
+    static void setTileDataCacheEnabled(bool enabled);
+    static bool isTileDataCacheEnabled();
+    /** Removes the tiles kept by the cache. Called by Director::purgeCachedData()
+     @since v3.0
+     */
+    static void purgeTileDataCache();
     /* initializes parsing of an XML string, either a tmx (Map) string or tsx (Tileset) string */
     bool parseXMLString(const std::string& xmlString);
 
@@ -318,6 +330,8 @@ protected:
     //! tile properties
     Dictionary* _tileProperties;
     unsigned int _currentFirstGID;
+    //! decodes the base64 layer data being parsed straight into the tiles of the layer
+    TMXTileDataDecoder* _tileDataDecoder;
 };
 
 // end of tilemap_parallax_nodes group
@@ -26,6 +26,7 @@ THE SOFTWARE.
 
 #include "CCDirector.h"
 #include "CCEGLView.h"
+#include "CCRenderer.h"
 
 NS_CC_BEGIN
 
@@ -257,6 +258,8 @@ void TextFieldTTF::draw()
     Color3B color = getColor();
     setColor(_colorSpaceHolder);
     LabelTTF::draw();
+    // the quad is read when the renderer is flushed, draw it before restoring its color
+    Director::getInstance()->getRenderer()->render();
     setColor(color);
 }
 
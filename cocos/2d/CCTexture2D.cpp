@@ -47,6 +47,24 @@ THE SOFTWARE.
     #include "CCTextureCache.h"
 #endif
 
+#include <string.h>
+
+// SIMD versions of the RGBA8888 conversions, chosen at compile time. They can still be
+// turned off at runtime with Texture2D::setVectorizedConversionEnabled(false).
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define CC_TEXTURE_CONVERT_SSE2 1
+    #include <emmintrin.h>
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON)) && !defined(__ARMEB__)
+    #define CC_TEXTURE_CONVERT_NEON 1
+    #include <arm_neon.h>
+#endif
+
+#if defined(CC_TEXTURE_CONVERT_SSE2) || defined(CC_TEXTURE_CONVERT_NEON)
+    #define CC_TEXTURE_CONVERT_SIMD 1
+#else
+    #define CC_TEXTURE_CONVERT_SIMD 0
+#endif
+
 NS_CC_BEGIN
 
 namespace {
@@ -115,6 +133,172 @@ static Texture2D::PixelFormat g_defaultAlphaPixelFormat = Texture2D::PixelFormat
 
 static bool _PVRHaveAlphaPremultiplied = false;
 
+static bool g_vectorizedConversion = CC_TEXTURE_CONVERT_SIMD != 0;
+
+//////////////////////////////////////////////////////////////////////////
+//vectorized conventer function
+//
+// Each function converts as many pixels as it can in whole vectors and returns how many it did;
+// the scalar loops below finish the remaining pixels. They return 0 when SIMD is not available or disabled.
+// RGBA8888 pixels are read as little-endian 32 bit words: 0xAABBGGRR.
+
+namespace {
+
+#if CC_TEXTURE_CONVERT_SIMD
+
+#if defined(CC_TEXTURE_CONVERT_SSE2)
+typedef __m128i PixelLanes;
+
+static inline PixelLanes lanesAnd(PixelLanes v, unsigned int mask) { return _mm_and_si128(v, _mm_set1_epi32((int)mask)); }
+static inline PixelLanes lanesOr(PixelLanes a, PixelLanes b) { return _mm_or_si128(a, b); }
+#define CC_LANES_SHL(v, n) _mm_slli_epi32((v), (n))
+#define CC_LANES_SHR(v, n) _mm_srli_epi32((v), (n))
+#else
+typedef uint32x4_t PixelLanes;
+
+static inline PixelLanes lanesAnd(PixelLanes v, unsigned int mask) { return vandq_u32(v, vdupq_n_u32(mask)); }
+static inline PixelLanes lanesOr(PixelLanes a, PixelLanes b) { return vorrq_u32(a, b); }
+#define CC_LANES_SHL(v, n) vshlq_n_u32((v), (n))
+#define CC_LANES_SHR(v, n) vshrq_n_u32((v), (n))
+#endif
+
+// RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRGGGGBBBBAAAA
+struct RGBA4444Lanes
+{
+    static inline PixelLanes convert(PixelLanes p)
+    {
+        return lanesOr(lanesOr(CC_LANES_SHL(lanesAnd(p, 0x000000F0), 8), CC_LANES_SHR(lanesAnd(p, 0x0000F000), 4)),
+                       lanesOr(CC_LANES_SHR(lanesAnd(p, 0x00F00000), 16), CC_LANES_SHR(p, 28)));
+    }
+};
+
+// RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRRGGGGGGBBBBB
+struct RGB565Lanes
+{
+    static inline PixelLanes convert(PixelLanes p)
+    {
+        return lanesOr(lanesOr(CC_LANES_SHL(lanesAnd(p, 0x000000F8), 8), CC_LANES_SHR(lanesAnd(p, 0x0000FC00), 5)),
+                       CC_LANES_SHR(lanesAnd(p, 0x00F80000), 19));
+    }
+};
+
+// RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRRGGGGGBBBBBA
+struct RGB5A1Lanes
+{
+    static inline PixelLanes convert(PixelLanes p)
+    {
+        return lanesOr(lanesOr(CC_LANES_SHL(lanesAnd(p, 0x000000F8), 8), CC_LANES_SHR(lanesAnd(p, 0x0000F800), 5)),
+                       lanesOr(CC_LANES_SHR(lanesAnd(p, 0x00F80000), 18), CC_LANES_SHR(p, 31)));
+    }
+};
+
+#undef CC_LANES_SHL
+#undef CC_LANES_SHR
+
+// converts 8 RGBA8888 pixels per iteration into 16 bit pixels
+template <typename Lanes>
+long convertRGBA8888To16Bits(const unsigned char* data, long pixels, unsigned short* out16)
+{
+    long i = 0;
+    for (; i + 8 <= pixels; i += 8)
+    {
+#if defined(CC_TEXTURE_CONVERT_SSE2)
+        __m128i lo = Lanes::convert(_mm_loadu_si128((const __m128i*)(data + i * 4)));
+        __m128i hi = Lanes::convert(_mm_loadu_si128((const __m128i*)(data + i * 4 + 16)));
+        // every lane holds a 16 bit value: sign extend it so the saturating pack keeps its bits
+        lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+        hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+        _mm_storeu_si128((__m128i*)(out16 + i), _mm_packs_epi32(lo, hi));
+#else
+        uint32x4_t lo = Lanes::convert(vld1q_u32((const uint32_t*)(data + i * 4)));
+        uint32x4_t hi = Lanes::convert(vld1q_u32((const uint32_t*)(data + i * 4 + 16)));
+        vst1q_u16(out16 + i, vcombine_u16(vmovn_u32(lo), vmovn_u32(hi)));
+#endif
+    }
+    return i;
+}
+
+// RRRRRRRRGGGGGGGGBBBBBBBB -> RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA
+long convertRGB888ToRGBA8888Vectorized(const unsigned char* data, long pixels, unsigned char* outData)
+{
+    long i = 0;
+#if defined(CC_TEXTURE_CONVERT_SSE2)
+    // SSE2 has no byte shuffle, so expand 4 pixels (3 words) at a time in general purpose registers
+    for (; i + 4 <= pixels; i += 4)
+    {
+        unsigned int in[3];
+        memcpy(in, data + i * 3, sizeof(in));
+        unsigned int out[4] = {
+            in[0] | 0xFF000000,
+            (in[0] >> 24) | (in[1] << 8) | 0xFF000000,
+            (in[1] >> 16) | (in[2] << 16) | 0xFF000000,
+            (in[2] >> 8) | 0xFF000000,
+        };
+        memcpy(outData + i * 4, out, sizeof(out));
+    }
+#else
+    for (; i + 16 <= pixels; i += 16)
+    {
+        uint8x16x3_t rgb = vld3q_u8(data + i * 3);
+        uint8x16x4_t rgba;
+        rgba.val[0] = rgb.val[0];
+        rgba.val[1] = rgb.val[1];
+        rgba.val[2] = rgb.val[2];
+        rgba.val[3] = vdupq_n_u8(0xFF);
+        vst4q_u8(outData + i * 4, rgba);
+    }
+#endif
+    return i;
+}
+
+#endif // CC_TEXTURE_CONVERT_SIMD
+
+inline long vectorizedRGBA8888ToRGBA4444(const unsigned char* data, long dataLen, unsigned short* out16)
+{
+#if CC_TEXTURE_CONVERT_SIMD
+    if (g_vectorizedConversion)
+    {
+        return convertRGBA8888To16Bits<RGBA4444Lanes>(data, dataLen / 4, out16);
+    }
+#endif
+    return 0;
+}
+
+inline long vectorizedRGBA8888ToRGB565(const unsigned char* data, long dataLen, unsigned short* out16)
+{
+#if CC_TEXTURE_CONVERT_SIMD
+    if (g_vectorizedConversion)
+    {
+        return convertRGBA8888To16Bits<RGB565Lanes>(data, dataLen / 4, out16);
+    }
+#endif
+    return 0;
+}
+
+inline long vectorizedRGBA8888ToRGB5A1(const unsigned char* data, long dataLen, unsigned short* out16)
+{
+#if CC_TEXTURE_CONVERT_SIMD
+    if (g_vectorizedConversion)
+    {
+        return convertRGBA8888To16Bits<RGB5A1Lanes>(data, dataLen / 4, out16);
+    }
+#endif
+    return 0;
+}
+
+inline long vectorizedRGB888ToRGBA8888(const unsigned char* data, long dataLen, unsigned char* outData)
+{
+#if CC_TEXTURE_CONVERT_SIMD
+    if (g_vectorizedConversion)
+    {
+        return convertRGB888ToRGBA8888Vectorized(data, dataLen / 3, outData);
+    }
+#endif
+    return 0;
+}
+
+} // namespace
+
 //////////////////////////////////////////////////////////////////////////
 //conventer function
 
@@ -272,7 +456,9 @@ void Texture2D::convertAI88ToI8(const unsigned char* data, long dataLen, unsigne
 // RRRRRRRRGGGGGGGGBBBBBBBB -> RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA
 void Texture2D::convertRGB888ToRGBA8888(const unsigned char* data, long dataLen, unsigned char* outData)
 {
-    for (int i = 0, l = dataLen - 2; i < l; i += 3)
+    long done = vectorizedRGB888ToRGBA8888(data, dataLen, outData);
+    outData += done * 4;
+    for (long i = done * 3, l = dataLen - 2; i < l; i += 3)
     {
         *outData++ = data[i];         //R
         *outData++ = data[i + 1];     //G
@@ -308,7 +494,9 @@ void Texture2D::convertRGB888ToRGB565(const unsigned char* data, long dataLen, u
 void Texture2D::convertRGBA8888ToRGB565(const unsigned char* data, long dataLen, unsigned char* outData)
 {
     unsigned short* out16 = (unsigned short*)outData;
-    for (int i = 0, l = dataLen - 3; i < l; i += 4)
+    long done = vectorizedRGBA8888ToRGB565(data, dataLen, out16);
+    out16 += done;
+    for (long i = done * 4, l = dataLen - 3; i < l; i += 4)
     {
         *out16++ = (data[i] & 0x00F8) << 8    //R
             | (data[i + 1] & 0x00FC) << 3     //G
@@ -381,7 +569,9 @@ void Texture2D::convertRGB888ToRGBA4444(const unsigned char* data, long dataLen,
 void Texture2D::convertRGBA8888ToRGBA4444(const unsigned char* data, long dataLen, unsigned char* outData)
 {
     unsigned short* out16 = (unsigned short*)outData;
-    for (int i = 0, l = dataLen - 3; i < l; i += 4)
+    long done = vectorizedRGBA8888ToRGBA4444(data, dataLen, out16);
+    out16 += done;
+    for (long i = done * 4, l = dataLen - 3; i < l; i += 4)
     {
         *out16++ = (data[i] & 0x00F0) << 8    //R
         | (data[i + 1] & 0x00F0) << 4         //G
@@ -407,7 +597,9 @@ void Texture2D::convertRGB888ToRGB5A1(const unsigned char* data, long dataLen, u
 void Texture2D::convertRGBA8888ToRGB5A1(const unsigned char* data, long dataLen, unsigned char* outData)
 {
     unsigned short* out16 = (unsigned short*)outData;
-    for (long i = 0, l = dataLen - 2; i < l; i += 4)
+    long done = vectorizedRGBA8888ToRGB5A1(data, dataLen, out16);
+    out16 += done;
+    for (long i = done * 4, l = dataLen - 2; i < l; i += 4)
     {
         *out16++ = (data[i] & 0x00F8) << 8    //R
             | (data[i + 1] & 0x00F8) << 3     //G
@@ -1235,6 +1427,16 @@ void Texture2D::PVRImagesHavePremultipliedAlpha(bool haveAlphaPremultiplied)
     _PVRHaveAlphaPremultiplied = haveAlphaPremultiplied;
 }
 
+void Texture2D::setVectorizedConversionEnabled(bool enabled)
+{
+    g_vectorizedConversion = enabled && CC_TEXTURE_CONVERT_SIMD;
+}
+
+bool Texture2D::isVectorizedConversionEnabled()
+{
+    return g_vectorizedConversion;
+}
+
     
 //
 // Use to apply MIN/MAG filter
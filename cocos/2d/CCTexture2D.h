@@ -184,6 +184,21 @@ public:
      @since v0.99.5
      */
     static void PVRImagesHavePremultipliedAlpha(bool haveAlphaPremultiplied);
+
+    /** enables (or not) the SSE2 / NEON versions of the pixel format conversions, used when an image is
+     converted to the default alpha pixel format.
+
+     They are available when the engine is built for x86 with SSE2 or for ARM with NEON, and enabled by default in that case.
+     Otherwise the scalar version is always used.
+
+     @since v3.0
+     */
+    static void setVectorizedConversionEnabled(bool enabled);
+
+    /** returns whether the SSE2 / NEON versions of the pixel format conversions are used
+     @since v3.0
+     */
+    static bool isVectorizedConversionEnabled();
     
 public:
     /**
@@ -351,16 +366,16 @@ public:
     
 public:
     static const PixelFormatInfoMap& getPixelFormatInfoMap();
-    
-private:
-
-    /**convert functions*/
 
     /**
     Convert the format to the format param you specified, if the format is PixelFormat::Automatic, it will detect it automatically and convert to the closest format for you.
     It will return the converted format to you. if the outData != data, you must delete it manually.
     */
     static PixelFormat convertDataToFormat(const unsigned char* data, long dataLen, PixelFormat originFormat, PixelFormat format, unsigned char** outData, int* outDataLen);
+    
+private:
+
+    /**convert functions*/
 
     static PixelFormat convertI8ToFormat(const unsigned char* data, long dataLen, PixelFormat format, unsigned char** outData, int* outDataLen);
     static PixelFormat convertAI88ToFormat(const unsigned char* data, long dataLen, PixelFormat format, unsigned char** outData, int* outDataLen);
@@ -45,12 +45,22 @@ THE SOFTWARE.
 
 NS_CC_BEGIN
 
+// the indices follow the vertex buffers in _buffersVBO
+static const int kIndicesVBO = CC_TEXTURE_ATLAS_VBO_COUNT;
+
 TextureAtlas::TextureAtlas()
     :_indices(NULL)
+    ,_currentVBO(0)
     ,_dirty(false)
     ,_texture(NULL)
     ,_quads(NULL)
-{}
+{
+    memset(_buffersVBO, 0, sizeof(_buffersVBO));
+#if CC_TEXTURE_ATLAS_USE_VAO
+    memset(_VAOnames, 0, sizeof(_VAOnames));
+#endif
+    clearDirtyQuads();
+}
 
 TextureAtlas::~TextureAtlas()
 {
@@ -59,10 +69,10 @@ TextureAtlas::~TextureAtlas()
     CC_SAFE_FREE(_quads);
     CC_SAFE_FREE(_indices);
 
-    glDeleteBuffers(2, _buffersVBO);
+    glDeleteBuffers(CC_TEXTURE_ATLAS_VBO_COUNT + 1, _buffersVBO);
 
 #if CC_TEXTURE_ATLAS_USE_VAO
-    glDeleteVertexArrays(1, &_VAOname);
+    glDeleteVertexArrays(CC_TEXTURE_ATLAS_VBO_COUNT, _VAOnames);
     GL::bindVAO(0);
 #endif
     CC_SAFE_RELEASE(_texture);
@@ -97,10 +107,56 @@ void TextureAtlas::setTexture(Texture2D * var)
 V3F_C4B_T2F_Quad* TextureAtlas::getQuads()
 {
     //if someone accesses the quads directly, presume that changes will be made
-    _dirty = true;
+    markQuadsDirty(0, _capacity);
     return _quads;
 }
 
+void TextureAtlas::setDirty(bool bDirty)
+{
+    if (bDirty)
+    {
+        markQuadsDirty(0, _capacity);
+    }
+    else
+    {
+        clearDirtyQuads();
+    }
+}
+
+void TextureAtlas::markQuadsDirty(long index, long amount)
+{
+    if (amount <= 0)
+    {
+        return;
+    }
+
+    for (int i = 0; i < CC_TEXTURE_ATLAS_VBO_COUNT; i++)
+    {
+        if (_dirtyStart[i] >= _dirtyEnd[i])
+        {
+            _dirtyStart[i] = index;
+            _dirtyEnd[i] = index + amount;
+        }
+        else
+        {
+            _dirtyStart[i] = MIN(_dirtyStart[i], index);
+            _dirtyEnd[i] = MAX(_dirtyEnd[i], index + amount);
+        }
+    }
+
+    _dirty = true;
+}
+
+void TextureAtlas::clearDirtyQuads()
+{
+    for (int i = 0; i < CC_TEXTURE_ATLAS_VBO_COUNT; i++)
+    {
+        _dirtyStart[i] = _dirtyEnd[i] = 0;
+    }
+
+    _dirty = false;
+}
+
 void TextureAtlas::setQuads(V3F_C4B_T2F_Quad* quads)
 {
     _quads = quads;
@@ -197,8 +253,6 @@ bool TextureAtlas::initWithTexture(Texture2D *texture, long capacity)
     setupVBO();
 #endif
 
-    _dirty = true;
-
     return true;
 }
 
@@ -209,9 +263,6 @@ void TextureAtlas::listenBackToForeground(Object *obj)
 #else    
     setupVBO();
 #endif
-    
-    // set _dirty to true to force it rebinding buffer
-    _dirty = true;
 }
 
 const char* TextureAtlas::description() const
@@ -252,42 +303,53 @@ void TextureAtlas::setupIndices()
 #if CC_TEXTURE_ATLAS_USE_VAO
 void TextureAtlas::setupVBOandVAO()
 {
-    glGenVertexArrays(1, &_VAOname);
-    GL::bindVAO(_VAOname);
+    glGenVertexArrays(CC_TEXTURE_ATLAS_VBO_COUNT, _VAOnames);
 
 #define kQuadSize sizeof(_quads[0].bl)
 
-    glGenBuffers(2, &_buffersVBO[0]);
+    glGenBuffers(CC_TEXTURE_ATLAS_VBO_COUNT + 1, &_buffersVBO[0]);
 
-    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(_quads[0]) * _capacity, _quads, GL_DYNAMIC_DRAW);
+    // one VAO per vertex buffer, they share the indices
+    for (int i = 0; i < CC_TEXTURE_ATLAS_VBO_COUNT; i++)
+    {
+        GL::bindVAO(_VAOnames[i]);
 
-    // vertices
-    glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_POSITION);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof( V3F_C4B_T2F, vertices));
+        glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[i]);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(_quads[0]) * _capacity, _quads, GL_DYNAMIC_DRAW);
 
-    // colors
-    glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_COLOR);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, kQuadSize, (GLvoid*) offsetof( V3F_C4B_T2F, colors));
+        // vertices
+        glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_POSITION);
+        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof( V3F_C4B_T2F, vertices));
 
-    // tex coords
-    glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_TEX_COORDS);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 2, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof( V3F_C4B_T2F, texCoords));
+        // colors
+        glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_COLOR);
+        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, kQuadSize, (GLvoid*) offsetof( V3F_C4B_T2F, colors));
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * _capacity * 6, _indices, GL_STATIC_DRAW);
+        // tex coords
+        glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_TEX_COORDS);
+        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 2, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof( V3F_C4B_T2F, texCoords));
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[kIndicesVBO]);
+        if (i == 0)
+        {
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * _capacity * 6, _indices, GL_STATIC_DRAW);
+        }
+    }
 
     // Must unbind the VAO before changing the element buffer.
     GL::bindVAO(0);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 
+    // the buffers hold the quads
+    clearDirtyQuads();
+
     CHECK_GL_ERROR_DEBUG();
 }
 #else // CC_TEXTURE_ATLAS_USE_VAO
 void TextureAtlas::setupVBO()
 {
-    glGenBuffers(2, &_buffersVBO[0]);
+    glGenBuffers(CC_TEXTURE_ATLAS_VBO_COUNT + 1, &_buffersVBO[0]);
 
     mapBuffers();
 }
@@ -298,17 +360,56 @@ void TextureAtlas::mapBuffers()
     // Avoid changing the element buffer for whatever VAO might be bound.
 	GL::bindVAO(0);
     
-    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(_quads[0]) * _capacity, _quads, GL_DYNAMIC_DRAW);
+    for (int i = 0; i < CC_TEXTURE_ATLAS_VBO_COUNT; i++)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[i]);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(_quads[0]) * _capacity, _quads, GL_DYNAMIC_DRAW);
+    }
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[kIndicesVBO]);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * _capacity * 6, _indices, GL_STATIC_DRAW);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
+    // the buffers hold the quads
+    clearDirtyQuads();
+
     CHECK_GL_ERROR_DEBUG();
 }
 
+void TextureAtlas::uploadDirtyQuads(long end)
+{
+    // the buffer drawn last is drawn again until the quads change, then the next one is updated,
+    // rather than this one which the GPU may still be reading
+    if (MIN(_dirtyEnd[_currentVBO], end) <= _dirtyStart[_currentVBO])
+    {
+        return;
+    }
+
+    _currentVBO = (_currentVBO + 1) % CC_TEXTURE_ATLAS_VBO_COUNT;
+
+    int start = _dirtyStart[_currentVBO];
+    int uploadEnd = MIN(_dirtyEnd[_currentVBO], end);
+    if (start < uploadEnd)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[_currentVBO]);
+        glBufferSubData(GL_ARRAY_BUFFER, sizeof(_quads[0]) * start, sizeof(_quads[0]) * (uploadEnd - start), &_quads[start]);
+        CC_INCREMENT_GL_UPLOADED_BYTES(sizeof(_quads[0]) * (uploadEnd - start));
+    }
+
+    // the quads which are not drawn are uploaded later
+    if (_dirtyEnd[_currentVBO] > end)
+    {
+        _dirtyStart[_currentVBO] = MAX(start, end);
+    }
+    else
+    {
+        _dirtyStart[_currentVBO] = _dirtyEnd[_currentVBO] = 0;
+    }
+
+    _dirty = _dirtyStart[_currentVBO] < _dirtyEnd[_currentVBO];
+}
+
 // TextureAtlas - Update, Insert, Move & Remove
 
 void TextureAtlas::updateQuad(V3F_C4B_T2F_Quad *quad, long index)
@@ -320,7 +421,7 @@ void TextureAtlas::updateQuad(V3F_C4B_T2F_Quad *quad, long index)
     _quads[index] = *quad;    
 
 
-    _dirty = true;
+    markQuadsDirty(index, 1);
 
 }
 
@@ -344,7 +445,7 @@ void TextureAtlas::insertQuad(V3F_C4B_T2F_Quad *quad, long index)
     _quads[index] = *quad;
 
 
-    _dirty = true;
+    markQuadsDirty(index, MAX(_totalQuads, index + 1) - index);
 
 }
 
@@ -367,6 +468,8 @@ void TextureAtlas::insertQuads(V3F_C4B_T2F_Quad* quads, long index, long amount)
     }
 
 
+    markQuadsDirty(index, MAX(_totalQuads, index + amount) - index);
+
     int max = index + amount;
     int j = 0;
     for (int i = index; i < max ; i++)
@@ -375,8 +478,6 @@ void TextureAtlas::insertQuads(V3F_C4B_T2F_Quad* quads, long index, long amount)
         index++;
         j++;
     }
-
-    _dirty = true;
 }
 
 void TextureAtlas::insertQuadFromIndex(long oldIndex, long newIndex)
@@ -405,7 +506,7 @@ void TextureAtlas::insertQuadFromIndex(long oldIndex, long newIndex)
     _quads[newIndex] = quadsBackup;
 
 
-    _dirty = true;
+    markQuadsDirty(MIN(oldIndex, newIndex), howMany + 1);
 }
 
 void TextureAtlas::removeQuadAtIndex(long index)
@@ -424,7 +525,7 @@ void TextureAtlas::removeQuadAtIndex(long index)
     _totalQuads--;
 
 
-    _dirty = true;
+    markQuadsDirty(index, _totalQuads - index);
 }
 
 void TextureAtlas::removeQuadsAtIndex(long index, long amount)
@@ -440,7 +541,7 @@ void TextureAtlas::removeQuadsAtIndex(long index, long amount)
         memmove( &_quads[index], &_quads[index+amount], sizeof(_quads[0]) * remaining );
     }
 
-    _dirty = true;
+    markQuadsDirty(index, remaining);
 }
 
 void TextureAtlas::removeAllQuads()
@@ -518,8 +619,6 @@ bool TextureAtlas::resizeCapacity(long newCapacity)
     setupIndices();
     mapBuffers();
 
-    _dirty = true;
-
     return true;
 }
 
@@ -558,7 +657,7 @@ void TextureAtlas::moveQuadsFromIndex(long oldIndex, long amount, long newIndex)
 
     free(tempQuads);
 
-    _dirty = true;
+    markQuadsDirty(MIN(oldIndex, newIndex), MAX(oldIndex, newIndex) + amount - MIN(oldIndex, newIndex));
 }
 
 void TextureAtlas::moveQuadsFromIndex(long index, long newIndex)
@@ -567,6 +666,8 @@ void TextureAtlas::moveQuadsFromIndex(long index, long newIndex)
     CCASSERT(newIndex + (_totalQuads - index) <= _capacity, "moveQuadsFromIndex move is out of bounds");
 
     memmove(_quads + newIndex,_quads + index, (_totalQuads - index) * sizeof(_quads[0]));
+
+    markQuadsDirty(MIN(index, newIndex), MAX(index, newIndex) + (_totalQuads - index) - MIN(index, newIndex));
 }
 
 void TextureAtlas::fillWithEmptyQuadsFromIndex(long index, long amount)
@@ -580,6 +681,8 @@ void TextureAtlas::fillWithEmptyQuadsFromIndex(long index, long amount)
     {
         _quads[i] = quad;
     }
+
+    markQuadsDirty(index, amount);
 }
 
 // TextureAtlas - Drawing
@@ -613,28 +716,14 @@ void TextureAtlas::drawNumberOfQuads(long numberOfQuads, long start)
     // XXX: update is done in draw... perhaps it should be done in a timer
     if (_dirty) 
     {
-        glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-        // option 1: subdata
-        //glBufferSubData(GL_ARRAY_BUFFER, sizeof(_quads[0])*start, sizeof(_quads[0]) * n , &_quads[start] );
-		
-		// option 2: data
-        //		glBufferData(GL_ARRAY_BUFFER, sizeof(quads_[0]) * (n-start), &quads_[start], GL_DYNAMIC_DRAW);
-		
-		// option 3: orphaning + glMapBuffer
-		glBufferData(GL_ARRAY_BUFFER, sizeof(_quads[0]) * (numberOfQuads-start), NULL, GL_DYNAMIC_DRAW);
-		void *buf = glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
-		memcpy(buf, _quads, sizeof(_quads[0])* (numberOfQuads-start));
-		glUnmapBuffer(GL_ARRAY_BUFFER);
-		
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-        _dirty = false;
+        uploadDirtyQuads(start + numberOfQuads);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
     }
 
-    GL::bindVAO(_VAOname);
+    GL::bindVAO(_VAOnames[_currentVBO]);
 
 #if CC_REBIND_INDICES_BUFFER
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[kIndicesVBO]);
 #endif
 
 #if CC_TEXTURE_ATLAS_USE_TRIANGLE_STRIP
@@ -656,15 +745,15 @@ void TextureAtlas::drawNumberOfQuads(long numberOfQuads, long start)
     //
 
 #define kQuadSize sizeof(_quads[0].bl)
-    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
 
     // XXX: update is done in draw... perhaps it should be done in a timer
     if (_dirty) 
     {
-        glBufferSubData(GL_ARRAY_BUFFER, sizeof(_quads[0])*start, sizeof(_quads[0]) * numberOfQuads , &_quads[start] );
-        _dirty = false;
+        uploadDirtyQuads(start + numberOfQuads);
     }
 
+    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[_currentVBO]);
+
     GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX);
 
     // vertices
@@ -676,7 +765,7 @@ void TextureAtlas::drawNumberOfQuads(long numberOfQuads, long start)
     // tex coords
     glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 2, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, texCoords));
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[kIndicesVBO]);
 
 #if CC_TEXTURE_ATLAS_USE_TRIANGLE_STRIP
     glDrawElements(GL_TRIANGLE_STRIP, (GLsizei)numberOfQuads*6, GL_UNSIGNED_SHORT, (GLvoid*) (start*6*sizeof(_indices[0])));
@@ -690,6 +779,7 @@ void TextureAtlas::drawNumberOfQuads(long numberOfQuads, long start)
 #endif // CC_TEXTURE_ATLAS_USE_VAO
 
     CC_INCREMENT_GL_DRAWS(1);
+    CC_INCREMENT_GL_QUADS(numberOfQuads);
     CHECK_GL_ERROR_DEBUG();
 }
 
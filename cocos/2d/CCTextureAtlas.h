@@ -188,8 +188,14 @@ public:
 
     /** whether or not the array buffer of the VBO needs to be updated*/
     inline bool isDirty(void) { return _dirty; }
-    /** specify if the array buffer of the VBO needs to be updated */
-    inline void setDirty(bool bDirty) { _dirty = bDirty; }
+    /** specify if the array buffer of the VBO needs to be updated, all the quads are uploaded again when set */
+    void setDirty(bool bDirty);
+
+    /** marks an amount of quads starting from index as changed.
+     Only the changed quads are uploaded to the VBO, the methods updating the quads mark them already.
+     @since v3.0
+     */
+    void markQuadsDirty(long index, long amount);
     /**
      * @js NA
      * @lua NA
@@ -217,6 +223,9 @@ public:
 private:
     void setupIndices();
     void mapBuffers();
+    void clearDirtyQuads();
+    // uploads the changed quads, below end, to the vertex buffer drawn next
+    void uploadDirtyQuads(long end);
 #if CC_TEXTURE_ATLAS_USE_VAO
     void setupVBOandVAO();
 #else
@@ -226,9 +235,13 @@ private:
 protected:
     GLushort*           _indices;
 #if CC_TEXTURE_ATLAS_USE_VAO
-    GLuint              _VAOname;
+    GLuint              _VAOnames[CC_TEXTURE_ATLAS_VBO_COUNT];
 #endif
-    GLuint              _buffersVBO[2]; //0: vertex  1: indices
+    GLuint              _buffersVBO[CC_TEXTURE_ATLAS_VBO_COUNT + 1]; //vertex buffers used in turn, then indices
+    int                 _currentVBO; //the vertex buffer drawn last
+    /** quads which changed since each vertex buffer was uploaded, from start to end - 1 */
+    int                 _dirtyStart[CC_TEXTURE_ATLAS_VBO_COUNT];
+    int                 _dirtyEnd[CC_TEXTURE_ATLAS_VBO_COUNT];
     bool                _dirty; //indicates whether or not the array buffer of the VBO needs to be updated
     /** quantity of quads that are going to be drawn */
     int _totalQuads;
@@ -28,6 +28,8 @@ THE SOFTWARE.
 #include <stack>
 #include <cctype>
 #include <list>
+#include <chrono>
+#include <algorithm>
 
 #include "CCTextureCache.h"
 #include "CCTexture2D.h"
@@ -57,12 +59,19 @@ TextureCache * TextureCache::getInstance()
 }
 
 TextureCache::TextureCache()
-: _loadingThread(nullptr)
+: _loadingThreadCount(1)
 , _asyncStructQueue(nullptr)
-, _imageInfoQueue(nullptr)
 , _needQuit(false)
 , _asyncRefCount(0)
+, _uploadTimeBudget(4)
+, _uploadBytesBudget(0)
+, _uploadFrame(0)
+, _uploadedBytes(0)
+, _uploadedTexture(false)
 {
+    // keep a core for the main thread
+    int cores = (int)std::thread::hardware_concurrency();
+    _loadingThreadCount = std::max(1, std::min(4, cores - 1));
 }
 
 TextureCache::~TextureCache()
@@ -72,7 +81,8 @@ TextureCache::~TextureCache()
     for( auto it=_textures.begin(); it!=_textures.end(); ++it)
         (it->second)->release();
 
-    CC_SAFE_DELETE(_loadingThread);
+    for (auto it = _loadingThreads.begin(); it != _loadingThreads.end(); ++it)
+        delete *it;
 }
 
 void TextureCache::destroyInstance()
@@ -96,7 +106,7 @@ const char* TextureCache::description() const
 //    return pRet;
 //}
 
-void TextureCache::addImageAsync(const std::string &path, Object *target, SEL_CallFuncO selector)
+void TextureCache::addImageAsync(const std::string &path, Object *target, SEL_CallFuncO selector, int priority)
 {
     Texture2D *texture = NULL;
 
@@ -115,18 +125,21 @@ void TextureCache::addImageAsync(const std::string &path, Object *target, SEL_Ca
     // lazy init
     if (_asyncStructQueue == NULL)
     {             
-        _asyncStructQueue = new queue<AsyncStruct*>();
-        _imageInfoQueue   = new queue<ImageInfo*>();        
-
-        // create a new thread to load images
-        _loadingThread = new std::thread(&TextureCache::loadImage, this);
+        _asyncStructQueue = new deque<AsyncStruct*>();
 
         _needQuit = false;
+
+        // create the threads decoding the images
+        for (int i = 0; i < _loadingThreadCount; ++i)
+        {
+            _loadingThreads.push_back(new std::thread(&TextureCache::loadImage, this));
+        }
     }
 
+    // the pending requests keep the cache alive, the decoded images are handed over to it on the next frames
     if (0 == _asyncRefCount)
     {
-        Director::getInstance()->getScheduler()->scheduleSelector(schedule_selector(TextureCache::addImageAsyncCallBack), this, 0, false);
+        retain();
     }
 
     ++_asyncRefCount;
@@ -137,16 +150,68 @@ void TextureCache::addImageAsync(const std::string &path, Object *target, SEL_Ca
     }
 
     // generate async struct
-    AsyncStruct *data = new AsyncStruct(fullpath, target, selector);
+    AsyncStruct *data = new AsyncStruct(fullpath, target, selector, priority);
+    _asyncStructs.push_back(data);
 
-    // add async struct into queue
+    // add async struct into queue, after the requests with the same or a higher priority
     _asyncStructQueueMutex.lock();
-    _asyncStructQueue->push(data);
+    auto pos = std::find_if(_asyncStructQueue->begin(), _asyncStructQueue->end(), [priority](AsyncStruct *other) {
+        return other->priority < priority;
+    });
+    _asyncStructQueue->insert(pos, data);
     _asyncStructQueueMutex.unlock();
 
     _sleepCondition.notify_one();
 }
 
+void TextureCache::cancelImageAsync(const std::string &path)
+{
+    std::string fullpath = FileUtils::getInstance()->fullPathForFilename(path.c_str());
+
+    // the requests are discarded when they come back from the loading threads
+    for (auto it = _asyncStructs.begin(); it != _asyncStructs.end(); ++it)
+    {
+        if ((*it)->filename == fullpath)
+        {
+            (*it)->cancelled = true;
+        }
+    }
+}
+
+void TextureCache::cancelAllImageAsync()
+{
+    for (auto it = _asyncStructs.begin(); it != _asyncStructs.end(); ++it)
+    {
+        (*it)->cancelled = true;
+    }
+}
+
+bool TextureCache::isLoadingImageAsync(const std::string &path)
+{
+    std::string fullpath = FileUtils::getInstance()->fullPathForFilename(path.c_str());
+
+    for (auto it = _asyncStructs.begin(); it != _asyncStructs.end(); ++it)
+    {
+        if ((*it)->filename == fullpath && !(*it)->cancelled)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void TextureCache::setAsyncLoadingThreadCount(int count)
+{
+    CCASSERT(_loadingThreads.empty(), "TextureCache: the loading threads are already running");
+    _loadingThreadCount = std::max(1, count);
+}
+
+void TextureCache::setAsyncUploadBudget(float milliseconds, long bytes)
+{
+    _uploadTimeBudget = milliseconds;
+    _uploadBytesBudget = bytes;
+}
+
 void TextureCache::loadImage()
 {
     AsyncStruct *asyncStruct = nullptr;
@@ -157,111 +222,121 @@ void TextureCache::loadImage()
         Thread thread;
         thread.createAutoreleasePool();
 
-        std::queue<AsyncStruct*> *pQueue = _asyncStructQueue;
-        _asyncStructQueueMutex.lock();
-        if (pQueue->empty())
         {
-            _asyncStructQueueMutex.unlock();
-            if (_needQuit) {
+            std::unique_lock<std::mutex> lk(_asyncStructQueueMutex);
+            _sleepCondition.wait(lk, [this] { return _needQuit || !_asyncStructQueue->empty(); });
+
+            if (_needQuit)
+            {
                 break;
             }
-            else {
-                std::unique_lock<std::mutex> lk(_sleepMutex);
-                _sleepCondition.wait(lk);
-                continue;
-            }
+
+            asyncStruct = _asyncStructQueue->front();
+            _asyncStructQueue->pop_front();
         }
-        else
-        {
-            asyncStruct = pQueue->front();
-            pQueue->pop();
-            _asyncStructQueueMutex.unlock();
-        }        
 
         const char *filename = asyncStruct->filename.c_str();
         
-        // generate image            
-        Image *image = new Image();
-        if (image && !image->initWithImageFileThreadSafe(filename))
+        // generate image, unless the load was cancelled
+        Image *image = nullptr;
+        if (!asyncStruct->cancelled)
         {
-            CC_SAFE_RELEASE(image);
-            CCLOG("can not load %s", filename);
-            continue;
+            image = new Image();
+            if (image && !image->initWithImageFileThreadSafe(filename))
+            {
+                CC_SAFE_RELEASE_NULL(image);
+                CCLOG("can not load %s", filename);
+            }
         }
 
-        // generate image info
-        ImageInfo *imageInfo = new ImageInfo();
-        imageInfo->asyncStruct = asyncStruct;
-        imageInfo->image = image;
-
-        // put the image info into the queue
-        _imageInfoMutex.lock();
-        _imageInfoQueue->push(imageInfo);
-        _imageInfoMutex.unlock();
-    }
-    
-	if(_asyncStructQueue != nullptr)
-    {
-        delete _asyncStructQueue;
-	    _asyncStructQueue = nullptr;
-        delete _imageInfoQueue;
-	    _imageInfoQueue = nullptr;
+        // The request is handed back to the main thread even if the image couldn't be created, so that its target gets released
+        Director::getInstance()->getScheduler()->performFunctionInCocosThread([this, asyncStruct, image] {
+            addImageAsyncCallBack(asyncStruct, image);
+        });
     }
 }
 
-void TextureCache::addImageAsyncCallBack(float dt)
+void TextureCache::addImageAsyncCallBack(AsyncStruct *asyncStruct, Image *image)
 {
     // the image is generated in loading thread
-    std::queue<ImageInfo*> *imagesQueue = _imageInfoQueue;
+    Object *target = asyncStruct->target;
+    SEL_CallFuncO selector = asyncStruct->selector;
+    const char* filename = asyncStruct->filename.c_str();
 
-    _imageInfoMutex.lock();
-    if (imagesQueue->empty())
-    {
-        _imageInfoMutex.unlock();
-    }
-    else
+    if (image && !asyncStruct->cancelled)
     {
-        ImageInfo *imageInfo = imagesQueue->front();
-        imagesQueue->pop();
-        _imageInfoMutex.unlock();
+        Texture2D *texture = nullptr;
 
-        AsyncStruct *asyncStruct = imageInfo->asyncStruct;
-        Image *image = imageInfo->image;
+        // the same file may have been loaded in the meantime
+        auto it = _textures.find(asyncStruct->filename);
+        if (it != _textures.end())
+        {
+            texture = it->second;
+        }
+        else
+        {
+            Director *director = Director::getInstance();
+            if (_uploadFrame != director->getTotalFrames())
+            {
+                _uploadFrame = director->getTotalFrames();
+                _uploadStart = std::chrono::steady_clock::now();
+                _uploadedBytes = 0;
+                _uploadedTexture = false;
+            }
 
-        Object *target = asyncStruct->target;
-        SEL_CallFuncO selector = asyncStruct->selector;
-        const char* filename = asyncStruct->filename.c_str();
+            // once the budget of the frame is spent, wait for the next one. At least one texture is created per frame
+            if (_uploadedTexture)
+            {
+                float elapsed = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - _uploadStart).count();
+                if ((_uploadTimeBudget > 0 && elapsed >= _uploadTimeBudget) ||
+                    (_uploadBytesBudget > 0 && _uploadedBytes >= _uploadBytesBudget))
+                {
+                    director->getScheduler()->performFunctionInCocosThread([this, asyncStruct, image] {
+                        addImageAsyncCallBack(asyncStruct, image);
+                    });
+                    return;
+                }
+            }
 
-        // generate texture in render thread
-        Texture2D *texture = new Texture2D();
+            // generate texture in render thread
+            texture = new Texture2D();
 
-        texture->initWithImage(image);
+            texture->initWithImage(image);
+            _uploadedBytes += image->getDataLen();
+            _uploadedTexture = true;
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
-       // cache the texture file name
-       VolatileTextureMgr::addImageTexture(texture, filename);
+            // cache the texture file name
+            VolatileTextureMgr::addImageTexture(texture, filename);
 #endif
-        // cache the texture. retain it, since it is added in the map
-        _textures.insert( std::make_pair(filename, texture) );
-        texture->retain();
+            // cache the texture. retain it, since it is added in the map
+            _textures.insert( std::make_pair(filename, texture) );
+            texture->retain();
 
-        texture->autorelease();
+            texture->autorelease();
+        }
 
         if (target && selector)
         {
             (target->*selector)(texture);
-            target->release();
-        }        
+        }
+    }
+
+    CC_SAFE_RELEASE(image);
+    removeAsyncStruct(asyncStruct);
+}
 
-        image->release();
-        delete asyncStruct;
-        delete imageInfo;
+void TextureCache::removeAsyncStruct(AsyncStruct *asyncStruct)
+{
+    CC_SAFE_RELEASE(asyncStruct->target);
 
-        --_asyncRefCount;
-        if (0 == _asyncRefCount)
-        {
-            Director::getInstance()->getScheduler()->unscheduleSelector(schedule_selector(TextureCache::addImageAsyncCallBack), this);
-        }
+    _asyncStructs.erase(std::find(_asyncStructs.begin(), _asyncStructs.end(), asyncStruct));
+    delete asyncStruct;
+
+    --_asyncRefCount;
+    if (0 == _asyncRefCount)
+    {
+        release();
     }
 }
 
@@ -425,10 +500,38 @@ void TextureCache::reloadAllTextures()
 
 void TextureCache::waitForQuit()
 {
-    // notify sub thread to quick
+    // notify sub threads to quit
+    _asyncStructQueueMutex.lock();
     _needQuit = true;
-    _sleepCondition.notify_one();
-    if (_loadingThread) _loadingThread->join();
+    _asyncStructQueueMutex.unlock();
+    _sleepCondition.notify_all();
+
+    for (auto it = _loadingThreads.begin(); it != _loadingThreads.end(); ++it)
+    {
+        (*it)->join();
+        delete *it;
+    }
+    _loadingThreads.clear();
+
+    // drop the requests which were not decoded yet. The decoded ones are waiting in the queue of the scheduler,
+    // they are cancelled and dropped when they come back
+    if (_asyncStructQueue != nullptr)
+    {
+        for (auto it = _asyncStructs.begin(); it != _asyncStructs.end(); ++it)
+        {
+            (*it)->cancelled = true;
+        }
+
+        std::deque<AsyncStruct*> pending;
+        pending.swap(*_asyncStructQueue);
+        delete _asyncStructQueue;
+        _asyncStructQueue = nullptr;
+
+        for (auto it = pending.begin(); it != pending.end(); ++it)
+        {
+            removeAsyncStruct(*it);
+        }
+    }
 }
 
 void TextureCache::dumpCachedTextureInfo() const
@@ -602,10 +705,9 @@ void VolatileTextureMgr::reloadAllTextures()
         case VolatileTexture::kImageFile:
             {
                 Image* image = new Image();
-                long size = 0;
-                unsigned char* pBuffer = FileUtils::getInstance()->getFileData(vt->_fileName.c_str(), "rb", &size);
+                FileView* view = FileUtils::getInstance()->openFileView(vt->_fileName);
                 
-                if (image && image->initWithImageData(pBuffer, size))
+                if (image && view && image->initWithImageData(view->getBytes(), view->getSize()))
                 {
                     Texture2D::PixelFormat oldPixelFormat = Texture2D::getDefaultAlphaPixelFormat();
                     Texture2D::setDefaultAlphaPixelFormat(vt->_pixelFormat);
@@ -613,7 +715,7 @@ void VolatileTextureMgr::reloadAllTextures()
                     Texture2D::setDefaultAlphaPixelFormat(oldPixelFormat);
                 }
                 
-                CC_SAFE_DELETE_ARRAY(pBuffer);
+                CC_SAFE_RELEASE(view);
                 CC_SAFE_RELEASE(image);
             }
             break;
@@ -32,6 +32,10 @@ THE SOFTWARE.
 #include <thread>
 #include <condition_variable>
 #include <queue>
+#include <deque>
+#include <vector>
+#include <atomic>
+#include <chrono>
 #include <string>
 #include <unordered_map>
 
@@ -108,10 +112,42 @@ public:
     * If the file image was not previously loaded, it will create a new Texture2D object and it will return it.
     * Otherwise it will load a texture in a new thread, and when the image is loaded, the callback will be called with the Texture2D as a parameter.
     * The callback will be called from the main thread, so it is safe to create any cocos2d object from the callback.
+    * The images are decoded by a pool of threads (see setAsyncLoadingThreadCount()), the ones with the highest priority first.
+    * The textures are then created on the main thread, through Scheduler::performFunctionInCocosThread(), within the budget set by setAsyncUploadBudget().
     * Supported image extensions: .png, .jpg
     * @since v0.8
     */
-    virtual void addImageAsync(const std::string &filepath, Object *target, SEL_CallFuncO selector);
+    virtual void addImageAsync(const std::string &filepath, Object *target, SEL_CallFuncO selector, int priority = 0);
+
+    /** Cancels the asynchronous loads of an image: the callbacks won't be called and the texture won't be created.
+    * @since v3.0
+    */
+    void cancelImageAsync(const std::string &filepath);
+
+    /** Cancels all the asynchronous loads
+    * @since v3.0
+    */
+    void cancelAllImageAsync();
+
+    /** Returns whether an image is being loaded by addImageAsync(), and was not cancelled
+    * @since v3.0
+    */
+    bool isLoadingImageAsync(const std::string &filepath);
+
+    /** Sets the number of threads decoding the images loaded by addImageAsync().
+    * It has to be set before the first call to addImageAsync(). The default value depends on the number of cores, up to 4.
+    * @since v3.0
+    */
+    void setAsyncLoadingThreadCount(int count);
+    int getAsyncLoadingThreadCount() const { return _loadingThreadCount; }
+
+    /** Sets how many textures loaded by addImageAsync() are created per frame.
+    * Once at least one texture has been created during a frame, no other texture is created during that frame once
+    * the creation of textures took more than 'milliseconds' or the data of the created images exceeds 'bytes'.
+    * 0 means no limit. The default is 4 milliseconds and no limit of bytes.
+    * @since v3.0
+    */
+    void setAsyncUploadBudget(float milliseconds, long bytes);
 
     /** Returns a Texture2D object given an Image.
     * If the image was not previously loaded, it will create a new Texture2D object and it will return it.
@@ -164,42 +200,53 @@ public:
     void waitForQuit();
 
 private:
-    void addImageAsyncCallBack(float dt);
     void loadImage();
 
 public:
     struct AsyncStruct
     {
     public:
-        AsyncStruct(const std::string& fn, Object *t, SEL_CallFuncO s) : filename(fn), target(t), selector(s) {}
+        AsyncStruct(const std::string& fn, Object *t, SEL_CallFuncO s, int p) : filename(fn), target(t), selector(s), priority(p), cancelled(false) {}
 
         std::string filename;
         Object *target;
         SEL_CallFuncO selector;
+        int priority;
+        // set on the main thread, read by the loading threads to skip the decoding
+        std::atomic<bool> cancelled;
     };
 
 protected:
-    typedef struct _ImageInfo
-    {
-        AsyncStruct *asyncStruct;
-        Image        *image;
-    } ImageInfo;
-    
-    std::thread* _loadingThread;
+    // creates the texture of a decoded image, run on the main thread. Called again the next frame once the budget is spent
+    void addImageAsyncCallBack(AsyncStruct *asyncStruct, Image *image);
+    // releases the target of a request and forgets it
+    void removeAsyncStruct(AsyncStruct *asyncStruct);
+
+    std::vector<std::thread*> _loadingThreads;
+    int _loadingThreadCount;
 
-    std::queue<AsyncStruct*>* _asyncStructQueue;
-    std::queue<ImageInfo*>* _imageInfoQueue;
+    // sorted by decreasing priority
+    std::deque<AsyncStruct*>* _asyncStructQueue;
+    // all the requests not handed over to their target yet, only used on the main thread
+    std::vector<AsyncStruct*> _asyncStructs;
 
+    // protects _asyncStructQueue and _needQuit, the loading threads wait for _sleepCondition with it
     std::mutex _asyncStructQueueMutex;
-    std::mutex _imageInfoMutex;
 
-    std::mutex _sleepMutex;
     std::condition_variable _sleepCondition;
 
     bool _needQuit;
 
     int _asyncRefCount;
 
+    float _uploadTimeBudget;
+    long _uploadBytesBudget;
+    // what was spent of the budget during the frame _uploadFrame
+    unsigned int _uploadFrame;
+    std::chrono::steady_clock::time_point _uploadStart;
+    long _uploadedBytes;
+    bool _uploadedTexture;
+
     std::unordered_map<std::string, Texture2D*> _textures;
 };
 
@@ -29,6 +29,16 @@ THE SOFTWARE.
 
 #if (CC_TARGET_PLATFORM != CC_PLATFORM_IOS && CC_TARGET_PLATFORM != CC_PLATFORM_ANDROID)
 
+#include <stdio.h>
+#include <unordered_map>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+#include <windows.h>
+#endif
+
 // root name of xml
 #define USERDEFAULT_ROOT_NAME    "userDefaultRoot"
 
@@ -39,101 +49,218 @@ using namespace std;
 NS_CC_BEGIN
 
 /**
- * define the functions here because we don't want to
- * export xmlNodePtr and other types in "CCUserDefault.h"
+ * The values are kept in memory, in a hash map loaded once from the xml file.
+ * Changes mark the map dirty and wake up a writer thread, which saves a snapshot of the map,
+ * so several changes made in a row are written at once and never on the caller's thread.
+ * flush() writes the pending changes right away.
+ *
+ * The file is written to a temporary file first and then renamed, so it is never left half-written.
+ *
+ * These are defined here because we don't want to export them in "CCUserDefault.h"
  */
 
-static tinyxml2::XMLElement* getXMLNodeForKey(const char* pKey, tinyxml2::XMLElement** rootNode, tinyxml2::XMLDocument **doc)
+typedef unordered_map<string, string> ValueMap;
+
+static ValueMap s_values;
+static bool s_valuesLoaded = false;
+static bool s_dirty = false;
+static bool s_needQuit = false;
+// protects s_values, s_dirty and s_needQuit
+static std::mutex s_valuesMutex;
+static std::condition_variable s_sleepCondition;
+// serializes the writes of the file, so that an older snapshot never overwrites a newer one
+static std::mutex s_fileMutex;
+
+static std::thread* s_writerThread = nullptr;
+
+static void loadValues()
 {
-    tinyxml2::XMLElement* curNode = NULL;
+    if (s_valuesLoaded)
+    {
+        return;
+    }
+    s_valuesLoaded = true;
 
-    // check the key value
+    long size = 0;
+    const char* xmlBuffer = (const char*)FileUtils::getInstance()->getFileData(UserDefault::getXMLFilePath().c_str(), "rb", &size);
+    if (NULL == xmlBuffer)
+    {
+        CCLOG("can not read xml file");
+        return;
+    }
+
+    tinyxml2::XMLDocument doc;
+    doc.Parse(xmlBuffer, size);
+    delete[] xmlBuffer;
+
+    tinyxml2::XMLElement* rootNode = doc.RootElement();
+    if (NULL == rootNode)
+    {
+        CCLOG("read root node error");
+        return;
+    }
+
+    for (tinyxml2::XMLElement* node = rootNode->FirstChildElement(); node; node = node->NextSiblingElement())
+    {
+        const char* value = node->GetText();
+        s_values[node->Value()] = value ? value : "";
+    }
+}
+
+static bool getValueForKey(const char* pKey, string* value)
+{
     if (! pKey)
     {
-        return NULL;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(s_valuesMutex);
+
+    ValueMap::const_iterator it = s_values.find(pKey);
+    if (it == s_values.end())
+    {
+        return false;
+    }
+
+    *value = it->second;
+    return true;
+}
+
+static bool saveValues(const ValueMap& values)
+{
+    tinyxml2::XMLDocument doc;
+    doc.LinkEndChild(doc.NewDeclaration("1.0"));
+
+    tinyxml2::XMLElement* rootNode = doc.NewElement(USERDEFAULT_ROOT_NAME);
+    doc.LinkEndChild(rootNode);
+
+    for (ValueMap::const_iterator it = values.begin(); it != values.end(); ++it)
+    {
+        tinyxml2::XMLElement* node = doc.NewElement(it->first.c_str());
+        node->LinkEndChild(doc.NewText(it->second.c_str()));
+        rootNode->LinkEndChild(node);
+    }
+
+    const string& filePath = UserDefault::getXMLFilePath();
+    string tmpFilePath = filePath + ".tmp";
+
+    if (tinyxml2::XML_SUCCESS != doc.SaveFile(tmpFilePath.c_str()))
+    {
+        CCLOG("can not write %s", tmpFilePath.c_str());
+        return false;
     }
 
-    do 
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+    // rename() doesn't replace an existing file on Windows
+    bool ret = (MoveFileExA(tmpFilePath.c_str(), filePath.c_str(), MOVEFILE_REPLACE_EXISTING) != 0);
+#else
+    bool ret = (0 == rename(tmpFilePath.c_str(), filePath.c_str()));
+#endif
+    if (! ret)
     {
- 		tinyxml2::XMLDocument* xmlDoc = new tinyxml2::XMLDocument();
-		*doc = xmlDoc;
-		//CCFileData data(UserDefault::getInstance()->getXMLFilePath().c_str(),"rt");
-		long nSize;
-		const char* pXmlBuffer = (const char*)FileUtils::getInstance()->getFileData(UserDefault::getInstance()->getXMLFilePath().c_str(), "rb", &nSize);
-		//const char* pXmlBuffer = (const char*)data.getBuffer();
-		if(NULL == pXmlBuffer)
-		{
-			CCLOG("can not read xml file");
-			break;
-		}
-		xmlDoc->Parse(pXmlBuffer, nSize);
-        delete[] pXmlBuffer;
-		// get root node
-		*rootNode = xmlDoc->RootElement();
-		if (NULL == *rootNode)
-		{
-			CCLOG("read root node error");
-			break;
-		}
-		// find the node
-		curNode = (*rootNode)->FirstChildElement();
-		while (NULL != curNode)
-		{
-			const char* nodeName = curNode->Value();
-			if (!strcmp(nodeName, pKey))
-			{
-				break;
-			}
-
-			curNode = curNode->NextSiblingElement();
-		}
-	} while (0);
-
-	return curNode;
+        CCLOG("can not replace %s", filePath.c_str());
+    }
+
+    return ret;
+}
+
+// writes the values if they have changed since they were last written
+static void flushValues()
+{
+    std::lock_guard<std::mutex> fileLock(s_fileMutex);
+
+    ValueMap snapshot;
+    {
+        std::lock_guard<std::mutex> lock(s_valuesMutex);
+        if (! s_dirty)
+        {
+            return;
+        }
+        snapshot = s_values;
+        s_dirty = false;
+    }
+
+    saveValues(snapshot);
+}
+
+static void writeValues()
+{
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lk(s_valuesMutex);
+            while (! s_needQuit && ! s_dirty)
+            {
+                s_sleepCondition.wait(lk);
+            }
+
+            if (s_needQuit)
+            {
+                break;
+            }
+        }
+
+        flushValues();
+    }
+}
+
+// stops the writer thread and writes what is still pending
+static void stopWriterThread()
+{
+    if (s_writerThread)
+    {
+        {
+            std::lock_guard<std::mutex> lock(s_valuesMutex);
+            s_needQuit = true;
+            s_sleepCondition.notify_one();
+        }
+        s_writerThread->join();
+        CC_SAFE_DELETE(s_writerThread);
+    }
+
+    flushValues();
 }
 
 static void setValueForKey(const char* pKey, const char* pValue)
 {
- 	tinyxml2::XMLElement* rootNode;
-	tinyxml2::XMLDocument* doc;
-	tinyxml2::XMLElement* node;
-	// check the params
-	if (! pKey || ! pValue)
-	{
-		return;
-	}
-	// find the node
-	node = getXMLNodeForKey(pKey, &rootNode, &doc);
-	// if node exist, change the content
-	if (node)
-	{
-        if (node->FirstChild())
+    // check the params
+    if (! pKey || ! pValue)
+    {
+        return;
+    }
+
+    if (s_writerThread == nullptr)
+    {
+        s_needQuit = false;
+        s_writerThread = new std::thread(&writeValues);
+
+        // write the pending changes when the application exits, before the statics above are destroyed
+        static bool s_atExitRegistered = false;
+        if (! s_atExitRegistered)
         {
-            node->FirstChild()->SetValue(pValue);
+            atexit(&stopWriterThread);
+            s_atExitRegistered = true;
         }
-        else
+    }
+
+    std::lock_guard<std::mutex> lock(s_valuesMutex);
+
+    ValueMap::iterator it = s_values.find(pKey);
+    if (it != s_values.end())
+    {
+        if (it->second == pValue)
         {
-            tinyxml2::XMLText* content = doc->NewText(pValue);
-            node->LinkEndChild(content);
+            return;
         }
-	}
-	else
-	{
-		if (rootNode)
-		{
-			tinyxml2::XMLElement* tmpNode = doc->NewElement(pKey);//new tinyxml2::XMLElement(pKey);
-			rootNode->LinkEndChild(tmpNode);
-			tinyxml2::XMLText* content = doc->NewText(pValue);//new tinyxml2::XMLText(pValue);
-			tmpNode->LinkEndChild(content);
-		}	
-	}
+        it->second = pValue;
+    }
+    else
+    {
+        s_values.insert(ValueMap::value_type(pKey, pValue));
+    }
 
-    // save file and free doc
-	if (doc)
-	{
-		doc->SaveFile(UserDefault::getInstance()->getXMLFilePath().c_str());
-		delete doc;
-	}
+    s_dirty = true;
+    s_sleepCondition.notify_one();
 }
 
 /**
@@ -166,27 +293,13 @@ bool UserDefault::getBoolForKey(const char* pKey)
 
 bool UserDefault::getBoolForKey(const char* pKey, bool defaultValue)
 {
-    const char* value = NULL;
-	tinyxml2::XMLElement* rootNode;
-	tinyxml2::XMLDocument* doc;
-	tinyxml2::XMLElement* node;
-	node =  getXMLNodeForKey(pKey, &rootNode, &doc);
-	// find the node
-	if (node && node->FirstChild())
-	{
-        value = (const char*)(node->FirstChild()->Value());
-	}
-
-	bool ret = defaultValue;
-
-	if (value)
-	{
-		ret = (! strcmp(value, "true"));
-	}
-
-    if (doc) delete doc;
+    string value;
+    if (getValueForKey(pKey, &value))
+    {
+        return value == "true";
+    }
 
-	return ret;
+    return defaultValue;
 }
 
 int UserDefault::getIntegerForKey(const char* pKey)
@@ -196,31 +309,13 @@ int UserDefault::getIntegerForKey(const char* pKey)
 
 int UserDefault::getIntegerForKey(const char* pKey, int defaultValue)
 {
-	const char* value = NULL;
-	tinyxml2::XMLElement* rootNode;
-	tinyxml2::XMLDocument* doc;
-	tinyxml2::XMLElement* node;
-	node =  getXMLNodeForKey(pKey, &rootNode, &doc);
-	// find the node
-	if (node && node->FirstChild())
-	{
-        value = (const char*)(node->FirstChild()->Value());
-	}
-
-	int ret = defaultValue;
-
-	if (value)
-	{
-		ret = atoi(value);
-	}
-
-	if(doc)
-	{
-		delete doc;
-	}
-
+    string value;
+    if (getValueForKey(pKey, &value))
+    {
+        return atoi(value.c_str());
+    }
 
-	return ret;
+    return defaultValue;
 }
 
 float UserDefault::getFloatForKey(const char* pKey)
@@ -242,27 +337,13 @@ double  UserDefault::getDoubleForKey(const char* pKey)
 
 double UserDefault::getDoubleForKey(const char* pKey, double defaultValue)
 {
-	const char* value = NULL;
-	tinyxml2::XMLElement* rootNode;
-	tinyxml2::XMLDocument* doc;
-	tinyxml2::XMLElement* node;
-	node =  getXMLNodeForKey(pKey, &rootNode, &doc);
-	// find the node
-	if (node && node->FirstChild())
-	{
-        value = (const char*)(node->FirstChild()->Value());
-	}
-
-	double ret = defaultValue;
-
-	if (value)
-	{
-		ret = atof(value);
-	}
-
-    if (doc) delete doc;
+    string value;
+    if (getValueForKey(pKey, &value))
+    {
+        return atof(value.c_str());
+    }
 
-	return ret;
+    return defaultValue;
 }
 
 std::string UserDefault::getStringForKey(const char* pKey)
@@ -272,27 +353,13 @@ std::string UserDefault::getStringForKey(const char* pKey)
 
 string UserDefault::getStringForKey(const char* pKey, const std::string & defaultValue)
 {
-    const char* value = NULL;
-	tinyxml2::XMLElement* rootNode;
-	tinyxml2::XMLDocument* doc;
-	tinyxml2::XMLElement* node;
-	node =  getXMLNodeForKey(pKey, &rootNode, &doc);
-	// find the node
-	if (node && node->FirstChild())
-	{
-        value = (const char*)(node->FirstChild()->Value());
-	}
-
-	string ret = defaultValue;
-
-	if (value)
-	{
-		ret = string(value);
-	}
-
-    if (doc) delete doc;
+    string value;
+    if (getValueForKey(pKey, &value))
+    {
+        return value;
+    }
 
-	return ret;
+    return defaultValue;
 }
 
 Data* UserDefault::getDataForKey(const char* pKey)
@@ -302,37 +369,24 @@ Data* UserDefault::getDataForKey(const char* pKey)
 
 Data* UserDefault::getDataForKey(const char* pKey, Data* defaultValue)
 {
-    const char* encodedData = NULL;
-	tinyxml2::XMLElement* rootNode;
-	tinyxml2::XMLDocument* doc;
-	tinyxml2::XMLElement* node;
-	node =  getXMLNodeForKey(pKey, &rootNode, &doc);
-	// find the node
-	if (node && node->FirstChild())
-	{
-        encodedData = (const char*)(node->FirstChild()->Value());
-	}
-    
-	Data* ret = defaultValue;
-    
-	if (encodedData)
-	{
+    string encodedData;
+    Data* ret = defaultValue;
+
+    if (getValueForKey(pKey, &encodedData) && ! encodedData.empty())
+    {
         unsigned char * decodedData = NULL;
-        int decodedDataLen = base64Decode((unsigned char*)encodedData, (unsigned int)strlen(encodedData), &decodedData);
+        int decodedDataLen = base64Decode((unsigned char*)encodedData.c_str(), (unsigned int)encodedData.length(), &decodedData);
         
         if (decodedData) {
             ret = Data::create(decodedData, decodedDataLen);
         
             delete decodedData;
         }
-	}
-    
-    if (doc) delete doc;
+    }
     
-	return ret;    
+    return ret;    
 }
 
-
 void UserDefault::setBoolForKey(const char* pKey, bool value)
 {
     // save bool value as string
@@ -413,18 +467,21 @@ void UserDefault::setDataForKey(const char* pKey, const Data& value) {
 
 UserDefault* UserDefault::getInstance()
 {
-    initXMLFilePath();
-
-    // only create xml file one time
-    // the file exists after the program exit
-    if ((! isXMLFileExist()) && (! createXMLFile()))
-    {
-        return NULL;
-    }
-
     if (! _userDefault)
     {
+        initXMLFilePath();
+
+        // only create xml file one time
+        // the file exists after the program exit
+        if ((! isXMLFileExist()) && (! createXMLFile()))
+        {
+            return NULL;
+        }
+
         _userDefault = new UserDefault();
+
+        // the file is read once, the values are then kept in memory
+        loadValues();
     }
 
     return _userDefault;
@@ -432,6 +489,9 @@ UserDefault* UserDefault::getInstance()
 
 void UserDefault::destroyInstance()
 {
+    // write the pending changes
+    stopWriterThread();
+
     _userDefault = NULL;
 }
 
@@ -508,6 +568,7 @@ const string& UserDefault::getXMLFilePath()
 
 void UserDefault::flush()
 {
+    flushValues();
 }
 
 NS_CC_END
@@ -42,6 +42,10 @@ NS_CC_BEGIN
  * 
  * It supports the following base types:
  * bool, int, float, double, string
+ *
+ * On the platforms storing them in an xml file, the values are read once and kept in memory. Changes are written to the file
+ * by a background thread, several changes made in a row being written at once. Call flush() to
+ * write them right away.
  */
 class CC_DLL UserDefault
 {
@@ -151,7 +155,8 @@ public:
      */
     void    setDataForKey(const char* pKey, const Data& value);
     /**
-     @brief Save content to xml file
+     @brief Save content to xml file.
+     Writes the pending changes right away, instead of waiting for the background thread to write them.
      * @js NA
      */
     void    flush();
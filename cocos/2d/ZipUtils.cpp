@@ -29,7 +29,18 @@
 #include "ccMacros.h"
 #include "platform/CCFileUtils.h"
 #include "unzip.h"
-#include <map>
+#include <unordered_map>
+#include <mutex>
+
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define CC_ZIPFILE_USE_MMAP 1
+#else
+#define CC_ZIPFILE_USE_MMAP 0
+#endif
 
 NS_CC_BEGIN
 
@@ -494,6 +505,11 @@ struct ZipEntryInfo
 {
     unz_file_pos pos;
     uLong uncompressed_size;
+    uLong compressed_size;
+    uLong compression_method;
+    uLong flag;
+    // offset of the entry data in the archive, -1 until it is read the first time
+    long long data_offset;
 };
 
 class ZipFilePrivate
@@ -501,15 +517,45 @@ class ZipFilePrivate
 public:
     unzFile zipFile;
     
-    // std::unordered_map is faster if available on the platform
-    typedef std::map<std::string, struct ZipEntryInfo> FileListContainer;
+    typedef std::unordered_map<std::string, struct ZipEntryInfo> FileListContainer;
     FileListContainer fileList;
+
+    // guards zipFile, which is shared by all the reads, and the data offsets of the entries
+    std::mutex mutex;
+
+    // the whole archive mapped in memory, so that entries are read without going through zipFile
+    unsigned char *mapping;
+    long long mappingSize;
 };
 
 ZipFile::ZipFile(const std::string &zipFile, const std::string &filter)
 : _data(new ZipFilePrivate)
 {
     _data->zipFile = unzOpen(zipFile.c_str());
+    _data->mapping = NULL;
+    _data->mappingSize = 0;
+
+#if CC_ZIPFILE_USE_MMAP
+    if (_data->zipFile)
+    {
+        int fd = open(zipFile.c_str(), O_RDONLY);
+        if (fd >= 0)
+        {
+            struct stat st;
+            if (fstat(fd, &st) == 0 && st.st_size > 0)
+            {
+                void *mapping = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+                if (mapping != MAP_FAILED)
+                {
+                    _data->mapping = (unsigned char*)mapping;
+                    _data->mappingSize = st.st_size;
+                }
+            }
+            close(fd);
+        }
+    }
+#endif
+
     setFilter(filter);
 }
 
@@ -520,9 +566,21 @@ ZipFile::~ZipFile()
         unzClose(_data->zipFile);
     }
 
+#if CC_ZIPFILE_USE_MMAP
+    if (_data && _data->mapping)
+    {
+        munmap(_data->mapping, (size_t)_data->mappingSize);
+    }
+#endif
+
     CC_SAFE_DELETE(_data);
 }
 
+bool ZipFile::isOpen() const
+{
+    return _data && _data->zipFile;
+}
+
 bool ZipFile::setFilter(const std::string &filter)
 {
     bool ret = false;
@@ -555,6 +613,10 @@ bool ZipFile::setFilter(const std::string &filter)
                     ZipEntryInfo entry;
                     entry.pos = posInfo;
                     entry.uncompressed_size = (uLong)fileInfo.uncompressed_size;
+                    entry.compressed_size = (uLong)fileInfo.compressed_size;
+                    entry.compression_method = fileInfo.compression_method;
+                    entry.flag = fileInfo.flag;
+                    entry.data_offset = -1;
                     _data->fileList[currentFileName] = entry;
                 }
             }
@@ -582,6 +644,69 @@ bool ZipFile::fileExists(const std::string &fileName) const
     return ret;
 }
 
+const unsigned char *ZipFile::getMappedEntryData(const std::string &fileName, long *compressedSize, bool *compressed)
+{
+    if (!_data->mapping || fileName.empty())
+    {
+        return NULL;
+    }
+
+    ZipFilePrivate::FileListContainer::iterator it = _data->fileList.find(fileName);
+    if (it == _data->fileList.end())
+    {
+        return NULL;
+    }
+
+    ZipEntryInfo &fileInfo = it->second;
+    // encrypted entries, or compressed with something else than deflate, go through unzip
+    if ((fileInfo.flag & 1) || (fileInfo.compression_method != 0 && fileInfo.compression_method != Z_DEFLATED))
+    {
+        return NULL;
+    }
+
+    long long offset;
+    {
+        std::lock_guard<std::mutex> lock(_data->mutex);
+        if (fileInfo.data_offset < 0)
+        {
+            // the size of the local header is only known once it is read
+            if (UNZ_OK == unzGoToFilePos(_data->zipFile, &fileInfo.pos)
+                && UNZ_OK == unzOpenCurrentFile(_data->zipFile))
+            {
+                fileInfo.data_offset = (long long)unzGetCurrentFileZStreamPos64(_data->zipFile);
+                unzCloseCurrentFile(_data->zipFile);
+            }
+        }
+        offset = fileInfo.data_offset;
+    }
+
+    if (offset <= 0 || offset + (long long)fileInfo.compressed_size > _data->mappingSize)
+    {
+        return NULL;
+    }
+
+    *compressedSize = (long)fileInfo.compressed_size;
+    *compressed = fileInfo.compression_method != 0;
+    return _data->mapping + offset;
+}
+
+const unsigned char *ZipFile::getStoredFileData(const std::string &fileName, long *size)
+{
+    long compressedSize = 0;
+    bool compressed = false;
+    const unsigned char *data = getMappedEntryData(fileName, &compressedSize, &compressed);
+    if (!data || compressed)
+    {
+        return NULL;
+    }
+
+    if (size)
+    {
+        *size = compressedSize;
+    }
+    return data;
+}
+
 unsigned char *ZipFile::getFileData(const std::string &fileName, long *pSize)
 {
     unsigned char * pBuffer = NULL;
@@ -589,7 +714,56 @@ unsigned char *ZipFile::getFileData(const std::string &fileName, long *pSize)
     {
         *pSize = 0;
     }
-    
+
+    // read the entry straight from the mapped archive, without locking the shared unzip handle
+    long compressedSize = 0;
+    bool compressed = false;
+    const unsigned char *mappedData = getMappedEntryData(fileName, &compressedSize, &compressed);
+    if (mappedData)
+    {
+        ZipEntryInfo &fileInfo = _data->fileList.find(fileName)->second;
+        long size = (long)fileInfo.uncompressed_size;
+        pBuffer = new unsigned char[size + 1];
+        pBuffer[size] = 0;
+
+        if (!compressed)
+        {
+            memcpy(pBuffer, mappedData, size);
+        }
+        else
+        {
+            z_stream stream;
+            memset(&stream, 0, sizeof(stream));
+            stream.next_in = (Bytef*)mappedData;
+            stream.avail_in = (uInt)compressedSize;
+            stream.next_out = pBuffer;
+            stream.avail_out = (uInt)size;
+
+            // raw deflate data, zip entries have no zlib header
+            int err = inflateInit2(&stream, -MAX_WBITS);
+            if (err == Z_OK)
+            {
+                err = inflate(&stream, Z_FINISH);
+                inflateEnd(&stream);
+            }
+
+            if (err != Z_STREAM_END || (long)stream.total_out != size)
+            {
+                CCLOG("cocos2d: ZipFile: inflate error in %s", fileName.c_str());
+                delete [] pBuffer;
+                return NULL;
+            }
+        }
+
+        if (pSize)
+        {
+            *pSize = size;
+        }
+        return pBuffer;
+    }
+
+    std::lock_guard<std::mutex> lock(_data->mutex);
+
     do
     {
         CC_BREAK_IF(!_data->zipFile);
@@ -606,7 +780,8 @@ unsigned char *ZipFile::getFileData(const std::string &fileName, long *pSize)
         nRet = unzOpenCurrentFile(_data->zipFile);
         CC_BREAK_IF(UNZ_OK != nRet);
         
-        pBuffer = new unsigned char[fileInfo.uncompressed_size];
+        pBuffer = new unsigned char[fileInfo.uncompressed_size + 1];
+        pBuffer[fileInfo.uncompressed_size] = 0;
         int CC_UNUSED nSize = unzReadCurrentFile(_data->zipFile, pBuffer, fileInfo.uncompressed_size);
         CCASSERT(nSize == 0 || nSize == (int)fileInfo.uncompressed_size, "the file size is wrong");
         
@@ -206,6 +206,9 @@ namespace cocos2d
     * It will cache the file list of a particular zip file with positions inside an archive,
     * so it would be much faster to read some particular files or to check their existance.
     *
+    * Where possible the archive is mapped in memory, and getFileData() may then be called
+    * from several threads at once. setFilter() must not be called while files are read.
+    *
     * @since v2.0.5
     */
     class ZipFile
@@ -248,14 +251,35 @@ namespace cocos2d
         * Get resource file data from a zip file.
         * @param fileName File name
         * @param[out] pSize If the file read operation succeeds, it will be the data size, otherwise 0.
-        * @return Upon success, a pointer to the data is returned, otherwise NULL.
+        * @return Upon success, a pointer to the data, followed by a zero byte, is returned, otherwise NULL.
         * @warning Recall: you are responsible for calling delete[] on any Non-NULL pointer returned.
         *
         * @since v2.0.5
         */
         unsigned char *getFileData(const std::string &fileName, long *size);
 
+        /**
+        * Get the data of a file stored without compression, straight from the mapped archive.
+        * @param fileName File name
+        * @param[out] size If the file is found, it will be the data size.
+        * @return The data, valid as long as the ZipFile lives, or NULL if the file is not found,
+        *         is compressed or the archive could not be mapped in memory.
+        *
+        * @since v3.0
+        */
+        const unsigned char *getStoredFileData(const std::string &fileName, long *size);
+
+        /**
+        * Check whether the zip file was opened successfully.
+        *
+        * @since v3.0
+        */
+        bool isOpen() const;
+
     private:
+        const unsigned char *getMappedEntryData(const std::string &fileName, long *compressedSize, bool *compressed);
+
+
         /** Internal data like zip file pointer / file list array and so on */
         ZipFilePrivate *_data;
     };
@@ -191,6 +191,19 @@ Only valid for cocos2d-mac. Not supported on cocos2d-ios.
 #endif
 
 
+/** @def CC_TEXTURE_ATLAS_VBO_COUNT
+ Number of vertex buffers used in turn by each TextureAtlas.
+ When the quads change, they are uploaded to the next buffer rather than to the one the GPU may still be
+ drawing from, which avoids stalling the driver. Each buffer uses the memory of the quads of the atlas.
+
+ To use a single buffer set it to 1. Set to 2 by default.
+
+ @since v3.0
+ */
+#ifndef CC_TEXTURE_ATLAS_VBO_COUNT
+#define CC_TEXTURE_ATLAS_VBO_COUNT 2
+#endif
+
 /** @def CC_USE_LA88_LABELS
  If enabled, it will use LA88 (Luminance Alpha 16-bit textures) for LabelTTF objects.
  If it is disabled, it will use A8 (Alpha 8-bit textures).
@@ -261,6 +274,17 @@ To enable set it to a value different than 0. Disabled by default.
 #define CC_ENABLE_PROFILERS 0
 #endif
 
+/** @def CC_ENABLE_ACTION_POOL
+ If enabled, the actions are allocated from pools of recycled memory blocks instead of the heap,
+ which makes creating and releasing the short-lived actions cheaper.
+ The memory of the pools is kept for reuse. Disable it when looking for memory errors with a memory checker.
+
+ To disable set it to 0. Enabled by default.
+ */
+#ifndef CC_ENABLE_ACTION_POOL
+#define CC_ENABLE_ACTION_POOL 1
+#endif
+
 /** Enable Lua engine debug log */
 #ifndef CC_LUA_ENGINE_DEBUG
 #define CC_LUA_ENGINE_DEBUG 0
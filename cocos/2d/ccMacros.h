@@ -249,6 +249,21 @@ It should work same as apples CFSwapInt32LittleToHost(..)
 extern unsigned int CC_DLL g_uNumberOfDraws;
 #define CC_INCREMENT_GL_DRAWS(__n__) g_uNumberOfDraws += __n__
 
+/** @def CC_INCREMENT_GL_QUADS
+ Increments the number of quads sent to the GPU.
+ The number of quads per frame is displayed on the screen when the Director's stats are enabled.
+ */
+extern unsigned int CC_DLL g_uNumberOfQuads;
+#define CC_INCREMENT_GL_QUADS(__n__) g_uNumberOfQuads += __n__
+
+/** @def CC_INCREMENT_GL_UPLOADED_BYTES
+ Increments the number of vertex bytes uploaded to the GPU.
+ The number of KB uploaded per frame is displayed on the screen when the Director's stats are enabled.
+ @since v3.0
+ */
+extern unsigned int CC_DLL g_uNumberOfUploadedBytes;
+#define CC_INCREMENT_GL_UPLOADED_BYTES(__n__) g_uNumberOfUploadedBytes += __n__
+
 /*******************/
 /** Notifications **/
 /*******************/
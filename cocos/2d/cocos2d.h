@@ -75,6 +75,12 @@ THE SOFTWARE.
 #include "CCDrawingPrimitives.h"
 #include "CCDrawNode.h"
 
+// renderer
+#include "CCRenderer.h"
+#include "CCRenderCommand.h"
+#include "CCQuadCommand.h"
+#include "CCCustomCommand.h"
+
 // effects
 #include "CCGrabber.h"
 #include "CCGrid.h"
@@ -29,7 +29,17 @@ THE SOFTWARE.
 #include "CCSAXParser.h"
 #include "tinyxml2.h"
 #include "unzip.h"
+#include "ZipUtils.h"
 #include <stack>
+#include <algorithm>
+
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#endif
 
 using namespace std;
 
@@ -465,14 +475,55 @@ void FileUtils::destroyInstance()
     CC_SAFE_DELETE(s_sharedFileUtils);
 }
 
+// FileView
+
+// files smaller than this are read rather than mapped, the mapping is not worth it
+static const long FILE_VIEW_MAPPING_THRESHOLD = 16 * 1024;
+
+FileView::FileView(unsigned char* buffer, long size)
+: _bytes(buffer)
+, _size(size)
+, _mappingLength(0)
+, _referenceCount(1)
+{
+    _bytes[size] = 0;
+}
+
+FileView::FileView(void* mapping, long size, long mappingLength)
+: _bytes((unsigned char*)mapping)
+, _size(size)
+, _mappingLength(mappingLength)
+, _referenceCount(1)
+{
+}
+
+FileView::~FileView()
+{
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32)
+    if (_mappingLength > 0)
+    {
+        munmap(_bytes, _mappingLength);
+        return;
+    }
+#endif
+    delete [] _bytes;
+}
+
 FileUtils::FileUtils()
 : _filenameLookupDict(NULL)
+, _searchPathIndexEnabled(false)
+, _searchPathIndexBuilt(false)
 {
 }
 
 FileUtils::~FileUtils()
 {
     CC_SAFE_RELEASE(_filenameLookupDict);
+
+    for (auto iter = _zipFiles.begin(); iter != _zipFiles.end(); ++iter)
+    {
+        delete iter->second;
+    }
 }
 
 
@@ -486,6 +537,89 @@ bool FileUtils::init()
 void FileUtils::purgeCachedEntries()
 {
     _fullPathCache.clear();
+    _missingPathCache.clear();
+    _searchPathIndex.clear();
+    _searchPathIndexBuilt = false;
+}
+
+void FileUtils::setSearchPathIndexEnabled(bool enabled)
+{
+    if (_searchPathIndexEnabled != enabled)
+    {
+        _searchPathIndexEnabled = enabled;
+        purgeCachedEntries();
+    }
+}
+
+bool FileUtils::isSearchPathIndexEnabled() const
+{
+    return _searchPathIndexEnabled;
+}
+
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32)
+static bool scanDirectory(const std::string& directory, const std::string& relativePath, int depth, std::unordered_set<std::string>& files)
+{
+    DIR *dir = opendir((directory + relativePath).c_str());
+    if (!dir)
+    {
+        return false;
+    }
+
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL)
+    {
+        if (entry->d_name[0] == '.' && (entry->d_name[1] == 0 || (entry->d_name[1] == '.' && entry->d_name[2] == 0)))
+        {
+            continue;
+        }
+
+        std::string path = relativePath + entry->d_name;
+        struct stat st;
+        if (stat((directory + path).c_str(), &st) != 0)
+        {
+            continue;
+        }
+
+        if (S_ISDIR(st.st_mode))
+        {
+            // the depth limit guards against links looping back
+            if (depth < 32)
+            {
+                files.insert(path + "/");
+                scanDirectory(directory, path + "/", depth + 1, files);
+            }
+        }
+        else
+        {
+            files.insert(path);
+        }
+    }
+    closedir(dir);
+    return true;
+}
+#endif
+
+void FileUtils::buildSearchPathIndex()
+{
+    _searchPathIndex.clear();
+    _searchPathIndexBuilt = true;
+
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32)
+    for (auto searchIt = _searchPathArray.begin(); searchIt != _searchPathArray.end(); ++searchIt)
+    {
+        // relative search paths are not on the file system, like "assets/" on Android
+        if (searchIt->empty() || (*searchIt)[0] != '/' || _searchPathIndex.find(*searchIt) != _searchPathIndex.end())
+        {
+            continue;
+        }
+
+        std::unordered_set<std::string> files;
+        if (scanDirectory(*searchIt, "", 0, files))
+        {
+            _searchPathIndex[*searchIt].swap(files);
+        }
+    }
+#endif
 }
 
 unsigned char* FileUtils::getFileData(const char* filename, const char* mode, long *size)
@@ -497,6 +631,10 @@ unsigned char* FileUtils::getFileData(const char* filename, const char* mode, lo
     {
         // read the file from hardware
         std::string fullPath = fullPathForFilename(filename);
+
+        buffer = getFileDataFromAssetPack(fullPath, size);
+        CC_BREAK_IF(buffer);
+
         FILE *fp = fopen(fullPath.c_str(), mode);
         CC_BREAK_IF(!fp);
         
@@ -521,7 +659,6 @@ unsigned char* FileUtils::getFileData(const char* filename, const char* mode, lo
 unsigned char* FileUtils::getFileDataFromZip(const char* zipFilePath, const char* filename, long *size)
 {
     unsigned char * buffer = NULL;
-    unzFile pFile = NULL;
     *size = 0;
 
     do 
@@ -529,34 +666,178 @@ unsigned char* FileUtils::getFileDataFromZip(const char* zipFilePath, const char
         CC_BREAK_IF(!zipFilePath || !filename);
         CC_BREAK_IF(strlen(zipFilePath) == 0);
 
-        pFile = unzOpen(zipFilePath);
-        CC_BREAK_IF(!pFile);
+        ZipFile *zipFile = getZipFile(zipFilePath);
+        CC_BREAK_IF(!zipFile);
 
-        int nRet = unzLocateFile(pFile, filename, 1);
-        CC_BREAK_IF(UNZ_OK != nRet);
+        buffer = zipFile->getFileData(filename, size);
+    } while (0);
 
-        char szFilePathA[260];
-        unz_file_info FileInfo;
-        nRet = unzGetCurrentFileInfo(pFile, &FileInfo, szFilePathA, sizeof(szFilePathA), NULL, 0, NULL, 0);
-        CC_BREAK_IF(UNZ_OK != nRet);
+    return buffer;
+}
 
-        nRet = unzOpenCurrentFile(pFile);
-        CC_BREAK_IF(UNZ_OK != nRet);
+FileView* FileUtils::openFileView(const std::string& filename)
+{
+    std::string fullPath = fullPathForFilename(filename);
+    long size = 0;
 
-        buffer = new unsigned char[FileInfo.uncompressed_size];
-        int CC_UNUSED nSize = unzReadCurrentFile(pFile, buffer, FileInfo.uncompressed_size);
-        CCASSERT(nSize == 0 || nSize == (int)FileInfo.uncompressed_size, "the file size is wrong");
+    // ZipFile leaves a zero byte after the data
+    unsigned char* buffer = getFileDataFromAssetPack(fullPath, &size);
+    if (buffer)
+    {
+        return new FileView(buffer, size);
+    }
 
-        *size = FileInfo.uncompressed_size;
-        unzCloseCurrentFile(pFile);
-    } while (0);
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32)
+    int fd = open(fullPath.c_str(), O_RDONLY);
+    if (fd >= 0)
+    {
+        FileView* view = NULL;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode))
+        {
+            size = (long)st.st_size;
+            long pageSize = sysconf(_SC_PAGESIZE);
+
+            // the end of the last page is filled with zeros, unless the file fills it
+            if (size >= FILE_VIEW_MAPPING_THRESHOLD && pageSize > 0 && size % pageSize != 0)
+            {
+                // copy on write, as some decoders work in place (encrypted ccz)
+                void* mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+                if (mapping != MAP_FAILED)
+                {
+                    view = new FileView(mapping, size, size);
+                }
+            }
+
+            if (!view)
+            {
+                buffer = new unsigned char[size + 1];
+                long offset = 0;
+                while (offset < size)
+                {
+                    ssize_t count = read(fd, buffer + offset, size - offset);
+                    if (count <= 0)
+                    {
+                        break;
+                    }
+                    offset += count;
+                }
+                view = new FileView(buffer, offset);
+            }
+        }
+        close(fd);
+
+        if (view)
+        {
+            return view;
+        }
+    }
+#endif
 
-    if (pFile)
+    FILE *fp = fopen(fullPath.c_str(), "rb");
+    if (fp)
     {
-        unzClose(pFile);
+        fseek(fp, 0, SEEK_END);
+        size = ftell(fp);
+        fseek(fp, 0, SEEK_SET);
+        buffer = new unsigned char[size + 1];
+        size = fread(buffer, sizeof(unsigned char), size, fp);
+        fclose(fp);
+        return new FileView(buffer, size);
     }
 
-    return buffer;
+    // files which are not on the file system, like the assets of the apk on Android
+    unsigned char* data = getFileData(fullPath.c_str(), "rb", &size);
+    if (!data)
+    {
+        return NULL;
+    }
+    buffer = new unsigned char[size + 1];
+    memcpy(buffer, data, size);
+    delete [] data;
+    return new FileView(buffer, size);
+}
+
+ZipFile* FileUtils::getZipFile(const std::string& zipFilePath)
+{
+    std::lock_guard<std::mutex> lock(_zipFilesMutex);
+
+    auto iter = _zipFiles.find(zipFilePath);
+    if (iter != _zipFiles.end())
+    {
+        return iter->second;
+    }
+
+    ZipFile *zipFile = new ZipFile(zipFilePath);
+    if (!zipFile->isOpen())
+    {
+        // not cached, the file may be created later
+        delete zipFile;
+        return NULL;
+    }
+
+    _zipFiles[zipFilePath] = zipFile;
+    return zipFile;
+}
+
+unsigned char* FileUtils::getFileDataFromAssetPack(const std::string& fullPath, long *size)
+{
+    ZipFile *zipFile = NULL;
+    std::string filename;
+    {
+        std::lock_guard<std::mutex> lock(_zipFilesMutex);
+        for (auto iter = _assetPacks.begin(); iter != _assetPacks.end(); ++iter)
+        {
+            const std::string& pack = *iter;
+            if (fullPath.length() > pack.length() && fullPath[pack.length()] == '/'
+                && fullPath.compare(0, pack.length(), pack) == 0)
+            {
+                auto zipIter = _zipFiles.find(pack);
+                if (zipIter != _zipFiles.end())
+                {
+                    zipFile = zipIter->second;
+                    filename = fullPath.substr(pack.length() + 1);
+                }
+                break;
+            }
+        }
+    }
+
+    if (!zipFile)
+    {
+        return NULL;
+    }
+    return zipFile->getFileData(filename, size);
+}
+
+void FileUtils::addAssetPack(const std::string& zipFilePath)
+{
+    if (!getZipFile(zipFilePath))
+    {
+        CCLOG("cocos2d: FileUtils: can't open the asset pack %s", zipFilePath.c_str());
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_zipFilesMutex);
+    if (std::find(_assetPacks.begin(), _assetPacks.end(), zipFilePath) == _assetPacks.end())
+    {
+        _assetPacks.push_back(zipFilePath);
+        _fullPathCache.clear();
+        _missingPathCache.clear();
+    }
+}
+
+void FileUtils::removeAssetPack(const std::string& zipFilePath)
+{
+    std::lock_guard<std::mutex> lock(_zipFilesMutex);
+    auto iter = std::find(_assetPacks.begin(), _assetPacks.end(), zipFilePath);
+    if (iter != _assetPacks.end())
+    {
+        // the zip file stays open, as loading threads may still be reading from it
+        _assetPacks.erase(iter);
+        _fullPathCache.clear();
+        _missingPathCache.clear();
+    }
 }
 
 std::string FileUtils::getNewFilename(const std::string &filename)
@@ -610,16 +891,55 @@ std::string FileUtils::fullPathForFilename(const std::string &filename)
     {
         return cacheIter->second;
     }
+
+    // Already known to be missing ?
+    if (_missingPathCache.find(filename) != _missingPathCache.end())
+    {
+        return filename;
+    }
     
     // Get the new file name.
     std::string newFilename( getNewFilename(filename) );
     
     string fullpath = "";
+
+    std::string file = newFilename;
+    std::string file_path = "";
+    size_t pos = newFilename.find_last_of("/");
+    if (pos != std::string::npos)
+    {
+        file_path = newFilename.substr(0, pos+1);
+        file = newFilename.substr(pos+1);
+    }
+
+    // the index only knows the plain paths of the files
+    bool useIndex = _searchPathIndexEnabled
+        && newFilename.find("./") == std::string::npos && newFilename.find("//") == std::string::npos;
+    if (useIndex && !_searchPathIndexBuilt)
+    {
+        buildSearchPathIndex();
+    }
     
     for (auto searchIt = _searchPathArray.begin(); searchIt != _searchPathArray.end(); ++searchIt) {
+        auto indexIt = useIndex ? _searchPathIndex.find(*searchIt) : _searchPathIndex.end();
+
         for (auto resolutionIt = _searchResolutionsOrderArray.begin(); resolutionIt != _searchResolutionsOrderArray.end(); ++resolutionIt) {
             
-            fullpath = this->getPathForFilename(newFilename, *resolutionIt, *searchIt);
+            if (indexIt != _searchPathIndex.end())
+            {
+                std::string relativePath = file_path + *resolutionIt;
+                if (relativePath.length() > 0 && relativePath[relativePath.length()-1] != '/')
+                {
+                    relativePath += '/';
+                }
+                relativePath += file;
+
+                fullpath = indexIt->second.find(relativePath) != indexIt->second.end() ? *searchIt + relativePath : "";
+            }
+            else
+            {
+                fullpath = this->getPathForFilename(newFilename, *resolutionIt, *searchIt);
+            }
             
             if (fullpath.length() > 0)
             {
@@ -629,7 +949,26 @@ std::string FileUtils::fullPathForFilename(const std::string &filename)
             }
         }
     }
+
+    if (!_assetPacks.empty())
+    {
+        std::lock_guard<std::mutex> lock(_zipFilesMutex);
+        for (auto packIt = _assetPacks.begin(); packIt != _assetPacks.end(); ++packIt) {
+            ZipFile *zipFile = _zipFiles[*packIt];
+            for (auto resolutionIt = _searchResolutionsOrderArray.begin(); resolutionIt != _searchResolutionsOrderArray.end(); ++resolutionIt) {
+
+                std::string entry = file_path + *resolutionIt + file;
+                if (zipFile->fileExists(entry))
+                {
+                    fullpath = *packIt + "/" + entry;
+                    _fullPathCache.insert(std::pair<std::string, std::string>(filename, fullpath));
+                    return fullpath;
+                }
+            }
+        }
+    }
     
+    _missingPathCache.insert(filename);
     CCLOG("cocos2d: fullPathForFilename: No file found at %s. Possible missing file.", filename.c_str());
 
     // XXX: Should it return nullptr ? or an empty string ?
@@ -646,6 +985,7 @@ void FileUtils::setSearchResolutionsOrder(const std::vector<std::string>& search
 {
     bool existDefault = false;
     _fullPathCache.clear();
+    _missingPathCache.clear();
     _searchResolutionsOrderArray.clear();
     for(auto iter = searchResolutionsOrder.begin(); iter != searchResolutionsOrder.end(); ++iter)
     {
@@ -670,6 +1010,8 @@ void FileUtils::setSearchResolutionsOrder(const std::vector<std::string>& search
 
 void FileUtils::addSearchResolutionsOrder(const std::string &order)
 {
+    _fullPathCache.clear();
+    _missingPathCache.clear();
     _searchResolutionsOrderArray.push_back(order);
 }
 
@@ -687,7 +1029,7 @@ void FileUtils::setSearchPaths(const std::vector<std::string>& searchPaths)
 {
     bool existDefaultRootPath = false;
     
-    _fullPathCache.clear();
+    purgeCachedEntries();
     _searchPathArray.clear();
     for (auto iter = searchPaths.begin(); iter != searchPaths.end(); ++iter)
     {
@@ -728,12 +1070,14 @@ void FileUtils::addSearchPath(const std::string &searchpath)
     {
         path += "/";
     }
+    purgeCachedEntries();
     _searchPathArray.push_back(path);
 }
 
 void FileUtils::setFilenameLookupDictionary(Dictionary* pFilenameLookupDict)
 {
-    _fullPathCache.clear();    
+    _fullPathCache.clear();
+    _missingPathCache.clear();
     CC_SAFE_RELEASE(_filenameLookupDict);
     _filenameLookupDict = pFilenameLookupDict;
     CC_SAFE_RETAIN(_filenameLookupDict);
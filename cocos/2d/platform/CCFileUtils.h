@@ -27,18 +27,74 @@ THE SOFTWARE.
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+#include <atomic>
 #include "CCPlatformMacros.h"
+#include "CCObject.h"
 #include "ccTypes.h"
 
 NS_CC_BEGIN
 
 class Dictionary;
 class Array;
+class ZipFile;
 /**
  * @addtogroup platform
  * @{
  */
 
+/** @brief Read-only content of a file, either mapped in memory or read into a buffer.
+ *
+ *  The bytes are always followed by a zero byte, so that text files can be parsed in place.
+ *  It isn't an Object: file views are created and released by loader threads, so the reference
+ *  count is atomic and the view is never seen by the script engines or autorelease pools.
+ *  @see FileUtils::openFileView
+ *  @since v3.0
+ */
+class CC_DLL FileView
+{
+public:
+    /** Increases the reference count, it can be called from any thread */
+    inline void retain()
+    {
+        CCASSERT(_referenceCount > 0, "reference count should greater than 0");
+        ++_referenceCount;
+    }
+
+    /** Decreases the reference count and deletes the view when it reaches 0, it can be called from any thread */
+    inline void release()
+    {
+        CCASSERT(_referenceCount > 0, "reference count should greater than 0");
+        if (--_referenceCount == 0)
+            delete this;
+    }
+
+    /** The content of the file, followed by a zero byte */
+    inline const unsigned char* getBytes() const { return _bytes; }
+    /** The size of the file, without the trailing zero byte */
+    inline long getSize() const { return _size; }
+    /** Whether the file is mapped in memory rather than read into a buffer */
+    inline bool isMapped() const { return _mappingLength > 0; }
+
+protected:
+    friend class FileUtils;
+
+    /** Takes the ownership of a buffer allocated with new[], of size + 1 bytes */
+    FileView(unsigned char* buffer, long size);
+    /** Takes the ownership of a mapping of a file */
+    FileView(void* mapping, long size, long mappingLength);
+
+    /** Use release() instead */
+    ~FileView();
+
+    unsigned char* _bytes;
+    long _size;
+    long _mappingLength;
+    std::atomic<int> _referenceCount;
+};
+
 //! @brief  Helper class to handle file operations
 class CC_DLL FileUtils
 {
@@ -70,7 +126,7 @@ public:
     virtual ~FileUtils();
     
     /**
-     *  Purges the file searching cache.
+     *  Purges the file searching cache, including the files which were not found and the index of the search paths.
      *
      *  @note It should be invoked after the resources were updated.
      *        For instance, in the CocosPlayer sample, every time you run application from CocosBuilder,
@@ -93,6 +149,8 @@ public:
     /**
      *  Gets resource file data from a zip file.
      *
+     *  The zip file is kept open, with the index of its files, so that reading other files from it is fast.
+     *
      *  @param[in]  filename The resource file name which contains the relative path of the zip file.
      *  @param[out] size If the file read operation succeeds, it will be the data size, otherwise 0.
      *  @return Upon success, a pointer to the data is returned, otherwise NULL.
@@ -100,6 +158,20 @@ public:
      */
     virtual unsigned char* getFileDataFromZip(const char* zipFilePath, const char* filename, long *size);
 
+    /**
+     *  Opens a read-only view of the content of a file, without copying it where possible.
+     *  Large files are mapped in memory on the platforms supporting it, other files are read into a buffer.
+     *  It may be called from loading threads, as long as the full path of the file is passed.
+     *
+     *  @param[in]  filename The resource file name which contains the path.
+     *  @return The view, or NULL if the file can't be read.
+     *  @warning The view is not autoreleased, so that it can be used from loading threads:
+     *           you are responsible for calling release() on any Non-NULL view returned.
+     *  @since v3.0
+     *  @lua NA
+     */
+    virtual FileView* openFileView(const std::string& filename);
+
     
     /** Returns the fullpath for a given filename.
      
@@ -267,6 +339,39 @@ public:
      */
     virtual const std::vector<std::string>& getSearchPaths() const;
 
+    /**
+     *  Enables an index of the files of the search paths.
+     *  The directories of the search paths are scanned once, and fullPathForFilename() then looks files up
+     *  in the index rather than on the file system. File names are matched case sensitively.
+     *  Search paths which can't be scanned, like the assets of the apk on Android, are still searched on the file system.
+     *  The index is rebuilt when the search paths change and by purgeCachedEntries(),
+     *  which must be called when files are added to the search paths. Disabled by default.
+     *
+     *  @since v3.0
+     *  @lua NA
+     */
+    void setSearchPathIndexEnabled(bool enabled);
+    bool isSearchPathIndexEnabled() const;
+
+    /**
+     *  Adds a zip archive to search for files, after the search paths.
+     *  The files are searched from the root of the archive, with the resolution directories,
+     *  and their full path is the path of the archive followed by the name of the file in the archive.
+     *  getFileData() reads them from the archive, which is kept open.
+     *
+     *  @param zipFilePath The full path of the zip archive.
+     *  @since v3.0
+     *  @lua NA
+     */
+    void addAssetPack(const std::string& zipFilePath);
+
+    /**
+     *  Removes a zip archive added with addAssetPack().
+     *  @since v3.0
+     *  @lua NA
+     */
+    void removeAssetPack(const std::string& zipFilePath);
+
     /**
      *  Gets the writable path.
      *  @return  The path that can be write/read a file in
@@ -364,6 +469,24 @@ protected:
      *  @note This method is used internally.
      */
     virtual Array* createArrayWithContentsOfFile(const std::string& filename);
+
+    /**
+     *  Scans the directories of the search paths into _searchPathIndex.
+     */
+    void buildSearchPathIndex();
+
+    /**
+     *  Gets the zip file opened for the path, opening it the first time. Thread safe.
+     *  @return The zip file, owned by FileUtils, or NULL if it can't be opened.
+     */
+    ZipFile* getZipFile(const std::string& zipFilePath);
+
+    /**
+     *  Reads a file of an asset pack. Thread safe.
+     *  @param fullPath The full path of the file, as returned by fullPathForFilename().
+     *  @return The data, or NULL if the full path is not in an asset pack.
+     */
+    unsigned char* getFileDataFromAssetPack(const std::string& fullPath, long *size);
     
     /** Dictionary used to lookup filenames based on a key.
      *  It is used internally by the following methods:
@@ -399,7 +522,35 @@ protected:
      *  The full path cache. When a file is found, it will be added into this cache. 
      *  This variable is used for improving the performance of file search.
      */
-    std::map<std::string, std::string> _fullPathCache;
+    std::unordered_map<std::string, std::string> _fullPathCache;
+
+    /**
+     *  The file names which were not found, so that looking them up again doesn't touch the file system.
+     */
+    std::unordered_set<std::string> _missingPathCache;
+
+    /**
+     *  The relative paths of the files of each search path directory.
+     *  Search paths which can't be scanned have no entry.
+     */
+    std::unordered_map<std::string, std::unordered_set<std::string> > _searchPathIndex;
+    bool _searchPathIndexEnabled;
+    bool _searchPathIndexBuilt;
+
+    /**
+     *  The zip files opened by getFileDataFromZip() and the asset packs, by path.
+     */
+    std::unordered_map<std::string, ZipFile*> _zipFiles;
+
+    /**
+     *  The paths of the asset packs, in search order.
+     */
+    std::vector<std::string> _assetPacks;
+
+    /**
+     *  Guards _zipFiles and _assetPacks, which are used by the loading threads.
+     */
+    std::mutex _zipFilesMutex;
     
     /**
      *  The singleton pointer of FileUtils.
@@ -416,15 +416,14 @@ bool Image::initWithImageFile(const char * strPath)
 
     SDL_FreeSurface(iSurf);
 #else
-    long bufferLen = 0;
-    unsigned char* buffer = FileUtils::getInstance()->getFileData(fullPath.c_str(), "rb", &bufferLen);
+    FileView* view = FileUtils::getInstance()->openFileView(fullPath);
 
-    if (buffer != nullptr && bufferLen > 0)
+    if (view != nullptr && view->getSize() > 0)
     {
-        bRet = initWithImageData(buffer, bufferLen);
+        bRet = initWithImageData(view->getBytes(), view->getSize());
     }
 
-    CC_SAFE_DELETE_ARRAY(buffer);
+    CC_SAFE_RELEASE(view);
 #endif // EMSCRIPTEN
 
     return bRet;
@@ -433,18 +432,23 @@ bool Image::initWithImageFile(const char * strPath)
 bool Image::initWithImageFileThreadSafe(const char *fullpath)
 {
     bool ret = false;
-    long dataLen = 0;
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+    long dataLen = 0;
     FileUtilsAndroid *fileUitls = (FileUtilsAndroid*)FileUtils::getInstance();
     unsigned char *buffer = fileUitls->getFileDataForAsync(fullpath, "rb", &dataLen);
-#else
-    unsigned char *buffer = FileUtils::getInstance()->getFileData(fullpath, "rb", &dataLen);
-#endif
     if (buffer != NULL && dataLen > 0)
     {
         ret = initWithImageData(buffer, dataLen);
     }
     CC_SAFE_DELETE_ARRAY(buffer);
+#else
+    FileView* view = FileUtils::getInstance()->openFileView(fullpath);
+    if (view != NULL && view->getSize() > 0)
+    {
+        ret = initWithImageData(view->getBytes(), view->getSize());
+    }
+    CC_SAFE_RELEASE(view);
+#endif
     return ret;
 }
 
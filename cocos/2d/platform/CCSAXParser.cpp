@@ -115,13 +115,12 @@ bool SAXParser::parse(const char* pXMLData, unsigned int uDataLength)
 bool SAXParser::parse(const char *pszFile)
 {
     bool ret = false;
-    long size = 0;
-    char* pBuffer = (char*)FileUtils::getInstance()->getFileData(pszFile, "rt", &size);
-    if (pBuffer != NULL && size > 0)
+    FileView* view = FileUtils::getInstance()->openFileView(pszFile);
+    if (view != NULL && view->getSize() > 0)
     {
-        ret = parse(pBuffer, size);
+        ret = parse((const char*)view->getBytes(), (unsigned int)view->getSize());
     }
-    CC_SAFE_DELETE_ARRAY(pBuffer);
+    CC_SAFE_RELEASE(view);
     return ret;
 }
 
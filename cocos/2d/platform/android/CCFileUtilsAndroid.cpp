@@ -150,6 +150,12 @@ unsigned char* FileUtilsAndroid::doGetFileData(const char* filename, const char*
     }
     
     string fullPath = fullPathForFilename(filename);
+
+    data = getFileDataFromAssetPack(fullPath, size);
+    if (data)
+    {
+        return data;
+    }
     
     if (fullPath[0] != '/')
     {
@@ -2,8 +2,10 @@
 
 #include <algorithm>
 #include <vector>
+#include <list>
 #include <string>
 #include <sstream>
+#include <unordered_map>
 #include <fontconfig/fontconfig.h>
 
 #include "platform/CCFileUtils.h"
@@ -23,6 +25,28 @@ using namespace std;
 // as FcFontMatch is quite an expensive call, cache the results of getFontFile
 static std::map<std::string, std::string> fontCache;
 
+// as opening a face parses the font file, the faces are kept open, one per font file and size
+static const size_t MAX_CACHED_FACES = 8;
+// number of rendered glyphs kept for all the faces, so that the labels updated every frame don't render them again
+static const size_t MAX_CACHED_GLYPHS = 1024;
+
+struct CachedFace {
+	FT_Face face;
+	unsigned int serial; // identifies the glyphs of the face in the glyph cache
+};
+
+struct CachedGlyph {
+	// metrics, in pixels
+	int width;
+	int bearingX;
+	int bearingY;
+	int horizAdvance;
+
+	int bitmapWidth;
+	int bitmapRows;
+	std::vector<unsigned char> bitmap;
+};
+
 struct LineBreakGlyph {
 	FT_UInt glyphIndex;
 	int paintPosition;
@@ -61,10 +85,18 @@ public:
 		libError = FT_Init_FreeType( &library );
 		FcInit();
 		_data = NULL;
+		nextFaceSerial = 0;
 		reset();
 	}
 
 	~BitmapDC() {
+		glyphs.clear();
+		glyphMap.clear();
+		for (auto& cachedFace : faces) {
+			FT_Done_Face(cachedFace.second.face);
+		}
+		faces.clear();
+
 		FT_Done_FreeType(library);
 		FcFini();
 		//data will be deleted by Image
@@ -123,7 +155,107 @@ public:
     	return false;
     }
 
-	bool divideString(FT_Face face, const char* sText, int iMaxWidth, int iMaxHeight) {
+	/**
+	 * get the face of a font file at a size, opened the first time
+	 */
+	CachedFace* getFace(const std::string& fontFile, float fontSize) {
+		std::ostringstream keyStream;
+		keyStream << fontFile << ":" << fontSize;
+		std::string key = keyStream.str();
+
+		for (auto it = faces.begin(); it != faces.end(); ++it) {
+			if (it->first == key) {
+				faces.splice(faces.begin(), faces, it);
+				return &faces.front().second;
+			}
+		}
+
+		FT_Face face;
+		if ( FT_New_Face(library, fontFile.c_str(), 0, &face) ) {
+			//no valid font found use default
+			if ( FT_New_Face(library, "/usr/share/fonts/truetype/freefont/FreeSerif.ttf", 0, &face) ) {
+				return NULL;
+			}
+		}
+
+		//select utf8 charmap
+		if ( FT_Select_Charmap(face, FT_ENCODING_UNICODE) ) {
+			FT_Done_Face(face);
+			return NULL;
+		}
+
+		if ( FT_Set_Pixel_Sizes(face, fontSize, fontSize) ) {
+			FT_Done_Face(face);
+			return NULL;
+		}
+
+		// close the least recently used face
+		if (faces.size() >= MAX_CACHED_FACES) {
+			removeGlyphs(faces.back().second.serial);
+			FT_Done_Face(faces.back().second.face);
+			faces.pop_back();
+		}
+
+		CachedFace cachedFace;
+		cachedFace.face = face;
+		cachedFace.serial = nextFaceSerial++;
+		faces.push_front(std::make_pair(key, cachedFace));
+		return &faces.front().second;
+	}
+
+	/**
+	 * get the metrics and the bitmap of a glyph, rendered the first time
+	 */
+	const CachedGlyph* getGlyph(const CachedFace& cachedFace, FT_UInt glyphIndex) {
+		unsigned long long key = ((unsigned long long)cachedFace.serial << 32) | glyphIndex;
+
+		auto it = glyphMap.find(key);
+		if (it != glyphMap.end()) {
+			glyphs.splice(glyphs.begin(), glyphs, it->second);
+			return &it->second->second;
+		}
+
+		if (FT_Load_Glyph(cachedFace.face, glyphIndex, FT_LOAD_RENDER)) {
+			return NULL;
+		}
+
+		FT_GlyphSlot slot = cachedFace.face->glyph;
+		CachedGlyph glyph;
+		glyph.width = slot->metrics.width >> 6;
+		glyph.bearingX = slot->metrics.horiBearingX >> 6;
+		glyph.bearingY = slot->metrics.horiBearingY >> 6;
+		glyph.horizAdvance = slot->metrics.horiAdvance >> 6;
+		glyph.bitmapWidth = slot->bitmap.width;
+		glyph.bitmapRows = slot->bitmap.rows;
+		glyph.bitmap.resize(glyph.bitmapWidth * glyph.bitmapRows);
+		for (int y = 0; y < glyph.bitmapRows; ++y) {
+			memcpy(&glyph.bitmap[y * glyph.bitmapWidth], slot->bitmap.buffer + y * slot->bitmap.pitch, glyph.bitmapWidth);
+		}
+
+		// forget the least recently used glyph
+		if (glyphs.size() >= MAX_CACHED_GLYPHS) {
+			glyphMap.erase(glyphs.back().first);
+			glyphs.pop_back();
+		}
+
+		glyphs.push_front(std::make_pair(key, glyph));
+		glyphMap[key] = glyphs.begin();
+		return &glyphs.front().second;
+	}
+
+	void removeGlyphs(unsigned int faceSerial) {
+		for (auto it = glyphs.begin(); it != glyphs.end(); ) {
+			if ((unsigned int)(it->first >> 32) == faceSerial) {
+				glyphMap.erase(it->first);
+				it = glyphs.erase(it);
+			} else {
+				++it;
+			}
+		}
+	}
+
+	bool divideString(const CachedFace& cachedFace, const char* sText, int iMaxWidth, int iMaxHeight) {
+		FT_Face face = cachedFace.face;
 		const char* pText = sText;
 		textLines.clear();
 		iMaxLineWidth = 0;
@@ -156,12 +288,13 @@ public:
             }
 
 			glyphIndex = FT_Get_Char_Index(face, unicode);
-			if (FT_Load_Glyph(face, glyphIndex, FT_LOAD_DEFAULT)) {
+			const CachedGlyph* cachedGlyph = getGlyph(cachedFace, glyphIndex);
+			if (!cachedGlyph) {
 				return false;
 			}
 
 			if (isspace(unicode)) {
-				currentPaintPosition += face->glyph->metrics.horiAdvance >> 6;
+				currentPaintPosition += cachedGlyph->horizAdvance;
 				prevGlyphIndex = glyphIndex;
 				prevCharacter = unicode;
 				lastBreakIndex = currentLine.glyphs.size();
@@ -170,9 +303,9 @@ public:
 
 			LineBreakGlyph glyph;
 			glyph.glyphIndex = glyphIndex;
-			glyph.glyphWidth = face->glyph->metrics.width >> 6;
-			glyph.bearingX = face->glyph->metrics.horiBearingX >> 6;
-			glyph.horizAdvance = face->glyph->metrics.horiAdvance >> 6;
+			glyph.glyphWidth = cachedGlyph->width;
+			glyph.bearingX = cachedGlyph->bearingX;
+			glyph.horizAdvance = cachedGlyph->horizAdvance;
 			glyph.kerning = 0;
 
 			if (prevGlyphIndex != 0 && hasKerning) {
@@ -319,28 +452,14 @@ public:
 			return false;
 		}
 
-		FT_Face face;
 		std::string fontfile = getFontFile(pFontName);
-		if ( FT_New_Face(library, fontfile.c_str(), 0, &face) ) {
-			//no valid font found use default
-			if ( FT_New_Face(library, "/usr/share/fonts/truetype/freefont/FreeSerif.ttf", 0, &face) ) {
-				return false;
-			}
-		}
-
-		//select utf8 charmap
-		if ( FT_Select_Charmap(face, FT_ENCODING_UNICODE) ) {
-			FT_Done_Face(face);
+		CachedFace* cachedFace = getFace(fontfile, fontSize);
+		if ( !cachedFace ) {
 			return false;
 		}
+		FT_Face face = cachedFace->face;
 
-		if ( FT_Set_Pixel_Sizes(face, fontSize, fontSize) ) {
-			FT_Done_Face(face);
-			return false;
-		}
-
-		if ( divideString(face, text, nWidth, nHeight) == false ) {
-			FT_Done_Face(face);
+		if ( divideString(*cachedFace, text, nWidth, nHeight) == false ) {
 			return false;
 		}
 
@@ -369,15 +488,15 @@ public:
 			for (int i = 0; i < glyphCount; i++) {
 				LineBreakGlyph glyph = textLines.at(line).glyphs.at(i);
 
-				if (FT_Load_Glyph(face, glyph.glyphIndex, FT_LOAD_RENDER)) {
+				const CachedGlyph* cachedGlyph = getGlyph(*cachedFace, glyph.glyphIndex);
+				if (!cachedGlyph) {
 					continue;
 				}
 
-				FT_Bitmap& bitmap = face->glyph->bitmap;
-				int yoffset = iCurYCursor - (face->glyph->metrics.horiBearingY >> 6);
+				int yoffset = iCurYCursor - cachedGlyph->bearingY;
 				int xoffset = iCurXCursor + glyph.paintPosition;
 
-				for (int y = 0; y < bitmap.rows; ++y) {
+				for (int y = 0; y < cachedGlyph->bitmapRows; ++y) {
                     int iY = yoffset + y;
                     if (iY>=iMaxLineHeight) {
                         //exceed the height truncate
@@ -385,10 +504,10 @@ public:
                     }
                     iY *= iMaxLineWidth;
 
-                    int bitmap_y = y * bitmap.width;
+                    int bitmap_y = y * cachedGlyph->bitmapWidth;
 
-					for (int x = 0; x < bitmap.width; ++x) {
-						unsigned char cTemp = bitmap.buffer[bitmap_y + x];
+					for (int x = 0; x < cachedGlyph->bitmapWidth; ++x) {
+						unsigned char cTemp = cachedGlyph->bitmap[bitmap_y + x];
 						if (cTemp == 0) {
 							continue;
 						}
@@ -404,8 +523,6 @@ public:
 			iCurYCursor += lineHeight;
 		}
 
-		//  free face
-		FT_Done_Face(face);
 		return true;
 	}
 
@@ -417,6 +534,14 @@ public:
 	std::vector<LineBreakLine> textLines;
 	int iMaxLineWidth;
 	int iMaxLineHeight;
+
+	// opened faces, most recently used first
+	std::list<std::pair<std::string, CachedFace> > faces;
+	unsigned int nextFaceSerial;
+
+	// rendered glyphs, most recently used first, keyed by face serial and glyph index
+	std::list<std::pair<unsigned long long, CachedGlyph> > glyphs;
+	std::unordered_map<unsigned long long, std::list<std::pair<unsigned long long, CachedGlyph> >::iterator> glyphMap;
 };
 
 static BitmapDC& sharedBitmapDC()
@@ -415,6 +415,7 @@ const AffineTransform& Armature::getNodeToParentTransform() const
         }
 
         _transformDirty = false;
+        _transformUpdated = true;
     }
 
     return _transform;
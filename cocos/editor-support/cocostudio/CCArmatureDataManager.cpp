@@ -266,8 +266,8 @@ void ArmatureDataManager::addArmatureFileInfoAsync(const char *imagePath, const
     addRelativeData(configFilePath);
 
     _autoLoadSpriteFile = false;
+    // the sprite frames are added once the texture is decoded
     DataReaderHelper::getInstance()->addDataFromFileAsync(imagePath, plistPath, configFilePath, target, selector);
-    addSpriteFrameFromFile(plistPath, imagePath);
 }
 
 void ArmatureDataManager::addSpriteFrameFromFile(const char *plistPath, const char *imagePath, const char *configFilePath)
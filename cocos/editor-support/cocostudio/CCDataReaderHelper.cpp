@@ -30,6 +30,8 @@ THE SOFTWARE.
 #include "cocostudio/CCArmatureDefine.h"
 #include "cocostudio/CCDatas.h"
 
+#include <unordered_map>
+
 using namespace cocos2d;
 
 
@@ -158,27 +160,17 @@ void DataReaderHelper::loadData()
         Thread thread;
         thread.createAutoreleasePool();
 
-        std::queue<AsyncStruct *> *pQueue = _asyncStructQueue;
-        _asyncStructQueueMutex.lock(); // get async struct from queue
-        if (pQueue->empty())
         {
-            _asyncStructQueueMutex.unlock();
+            // get async struct from queue
+            std::unique_lock<std::mutex> lk(_asyncStructQueueMutex);
+            _sleepCondition.wait(lk, [this] { return need_quit || !_asyncStructQueue->empty(); });
             if (need_quit)
             {
                 break;
             }
-            else
-            {
-				std::unique_lock<std::mutex> lk(_sleepMutex);
-				_sleepCondition.wait(lk);
-                continue;
-            }
-        }
-        else
-        {
-            pAsyncStruct = pQueue->front();
-            pQueue->pop();
-            _asyncStructQueueMutex.unlock();
+
+            pAsyncStruct = _asyncStructQueue->front();
+            _asyncStructQueue->pop();
         }
 
         // generate data info
@@ -187,28 +179,67 @@ void DataReaderHelper::loadData()
         pDataInfo->filename = pAsyncStruct->filename;
         pDataInfo->baseFilePath = pAsyncStruct->baseFilePath;
 
+        if (pAsyncStruct->configType == CocoStudio_Binary)
+        {
+            bool added = DataReaderHelper::addDataFromBinaryCache(pAsyncStruct->fileView->getBytes(), pAsyncStruct->fileView->getSize(), pDataInfo);
+            CC_SAFE_RELEASE_NULL(pAsyncStruct->fileView);
+            if (!added)
+            {
+                // load the config file instead, as addDataFromFile() does
+                CCLOG("invalid armature binary file of %s, load the config file", pDataInfo->filename.c_str());
+                pAsyncStruct->configType = pAsyncStruct->fileConfigType;
+                pAsyncStruct->fileView = FileUtils::getInstance()->openFileView(pAsyncStruct->fullPath);
+            }
+        }
+
+        const char *fileContent = pAsyncStruct->fileView ? (const char *)pAsyncStruct->fileView->getBytes() : "";
         if (pAsyncStruct->configType == DragonBone_XML)
         {
-            DataReaderHelper::addDataFromCache(pAsyncStruct->fileContent.c_str(), pDataInfo);
+            DataReaderHelper::addDataFromCache(fileContent, pDataInfo);
         }
         else if(pAsyncStruct->configType == CocoStudio_JSON)
         {
-            DataReaderHelper::addDataFromJsonCache(pAsyncStruct->fileContent.c_str(), pDataInfo);
+            DataReaderHelper::addDataFromJsonCache(fileContent, pDataInfo);
         }
+        CC_SAFE_RELEASE_NULL(pAsyncStruct->fileView);
+
+        // hand the data info over to the main thread
+        Director::getInstance()->getScheduler()->performFunctionInCocosThread([this, pDataInfo] {
+            if (_dataReaderHelper == this)
+            {
+                addDataAsyncCallBack(pDataInfo);
+            }
+            else
+            {
+                // the helper was destroyed while the data was waiting
+                deleteDataInfo(pDataInfo);
+            }
+        });
+    }
+}
 
-        // put the image info into the queue
-        _dataInfoMutex.lock();
-        _dataQueue->push(pDataInfo);
-        _dataInfoMutex.unlock();
+void DataReaderHelper::deleteDataInfo(DataInfo *dataInfo)
+{
+    for (auto armatureData : dataInfo->armatureDatas)
+    {
+        armatureData->release();
+    }
+    for (auto animationData : dataInfo->animationDatas)
+    {
+        animationData->release();
+    }
+    for (auto textureData : dataInfo->textureDatas)
+    {
+        textureData->release();
     }
 
-    if( _asyncStructQueue != nullptr )
+    if (dataInfo->asyncStruct)
     {
-        delete _asyncStructQueue;
-        _asyncStructQueue = nullptr;
-        delete _dataQueue;
-        _dataQueue = nullptr;
+        CC_SAFE_RELEASE(dataInfo->asyncStruct->target);
+        CC_SAFE_RELEASE(dataInfo->asyncStruct->fileView);
+        delete dataInfo->asyncStruct;
     }
+    delete dataInfo;
 }
 
 
@@ -241,9 +272,7 @@ void DataReaderHelper::purge()
 
 
 DataReaderHelper::DataReaderHelper()
-	: _loadingThread(nullptr)
-	, _asyncStructQueue(nullptr)
-	, _dataQueue(nullptr)
+	: _asyncStructQueue(nullptr)
 	, need_quit(false)
 	, _asyncRefCount(0)
 	, _asyncRefTotalCount(0)
@@ -253,12 +282,32 @@ DataReaderHelper::DataReaderHelper()
 
 DataReaderHelper::~DataReaderHelper()
 {
+    _asyncStructQueueMutex.lock();
     need_quit = true;
+    _asyncStructQueueMutex.unlock();
 
-	_sleepCondition.notify_one();
-	if (_loadingThread) _loadingThread->join();
+	_sleepCondition.notify_all();
+	for (auto loadingThread : _loadingThreads)
+	{
+		loadingThread->join();
+		delete loadingThread;
+	}
+	_loadingThreads.clear();
+
+	if (_asyncStructQueue != nullptr)
+	{
+		// the files which were not decoded yet
+		while (!_asyncStructQueue->empty())
+		{
+			AsyncStruct *asyncStruct = _asyncStructQueue->front();
+			_asyncStructQueue->pop();
+			CC_SAFE_RELEASE(asyncStruct->target);
+			CC_SAFE_RELEASE(asyncStruct->fileView);
+			delete asyncStruct;
+		}
+		CC_SAFE_DELETE(_asyncStructQueue);
+	}
 
-	CC_SAFE_DELETE(_loadingThread);
 	_dataReaderHelper = nullptr;
 }
 
@@ -295,15 +344,27 @@ void DataReaderHelper::addDataFromFile(const char *filePath)
     size_t startPos = filePathStr.find_last_of(".");
     std::string str = &filePathStr[startPos];
 
-    long size;
     std::string fullPath = CCFileUtils::getInstance()->fullPathForFilename(filePath);
-    const char *pFileContent = (char *)CCFileUtils::getInstance()->getFileData(fullPath.c_str() , "r", &size);
 
     DataInfo dataInfo;
     dataInfo.filename = filePathStr;
     dataInfo.asyncStruct = nullptr;
     dataInfo.baseFilePath = basefilePath;
 
+    FileView *binaryView = openBinaryFile(fullPath);
+    if (binaryView)
+    {
+        bool added = DataReaderHelper::addDataFromBinaryCache(binaryView->getBytes(), binaryView->getSize(), &dataInfo);
+        binaryView->release();
+        if (added)
+        {
+            return;
+        }
+    }
+
+    FileView *fileView = CCFileUtils::getInstance()->openFileView(fullPath);
+    const char *pFileContent = fileView ? (const char *)fileView->getBytes() : "";
+
     if (str.compare(".xml") == 0)
     {
         DataReaderHelper::addDataFromCache(pFileContent, &dataInfo);
@@ -312,6 +373,8 @@ void DataReaderHelper::addDataFromFile(const char *filePath)
     {
         DataReaderHelper::addDataFromJsonCache(pFileContent, &dataInfo);
     }
+
+    CC_SAFE_RELEASE(fileView);
 }
 
 void DataReaderHelper::addDataFromFileAsync(const char *imagePath, const char *plistPath, const char *filePath, Object *target, SEL_SCHEDULE selector)
@@ -323,6 +386,11 @@ void DataReaderHelper::addDataFromFileAsync(const char *imagePath, const char *p
     {
         if (_configFileList[i].compare(filePath) == 0)
         {
+            if (*imagePath && *plistPath)
+            {
+                ArmatureDataManager::getInstance()->addSpriteFrameFromFile(plistPath, imagePath);
+            }
+
             if (target && selector)
             {
                 if (_asyncRefTotalCount == 0 && _asyncRefCount == 0)
@@ -357,17 +425,22 @@ void DataReaderHelper::addDataFromFileAsync(const char *imagePath, const char *p
     if (_asyncStructQueue == nullptr)
     {
         _asyncStructQueue = new std::queue<AsyncStruct *>();
-        _dataQueue = new std::queue<DataInfo *>();
-
-		// create a new thread to load images
-		_loadingThread = new std::thread(&DataReaderHelper::loadData, this);
 
         need_quit = false;
+
+		// create the threads decoding the files, the main thread and the texture threads keep their cores
+		int cores = (int)std::thread::hardware_concurrency();
+		int count = std::max(1, std::min(4, cores - 1));
+		for (int i = 0; i < count; ++i)
+		{
+			_loadingThreads.push_back(new std::thread(&DataReaderHelper::loadData, this));
+		}
     }
 
-    if (0 == _asyncRefCount)
+    // decode the texture while the file is decoded
+    if (*imagePath && *plistPath)
     {
-		Director::getInstance()->getScheduler()->scheduleSelector(schedule_selector(DataReaderHelper::addDataAsyncCallBack), this, 0, false);
+        Director::getInstance()->getTextureCache()->addImageAsync(imagePath, nullptr, nullptr);
     }
 
     ++_asyncRefCount;
@@ -385,6 +458,7 @@ void DataReaderHelper::addDataFromFileAsync(const char *imagePath, const char *p
     data->target = target;
     data->selector = selector;
     data->autoLoadSpriteFile = ArmatureDataManager::getInstance()->isAutoLoadSpriteFile();
+    data->preloadTextures = true;
 
     data->imagePath = imagePath;
     data->plistPath = plistPath;
@@ -393,17 +467,25 @@ void DataReaderHelper::addDataFromFileAsync(const char *imagePath, const char *p
     size_t startPos = filePathStr.find_last_of(".");
     std::string str = &filePathStr[startPos];
 
-    std::string fullPath = CCFileUtils::getInstance()->fullPathForFilename(filePath);
-    long size;
-    data->fileContent = (char *)CCFileUtils::getInstance()->getFileData(fullPath.c_str() , "r", &size);
-
+    data->fullPath = CCFileUtils::getInstance()->fullPathForFilename(filePath);
     if (str.compare(".xml") == 0)
     {
-        data->configType = DragonBone_XML;
+        data->fileConfigType = DragonBone_XML;
     }
     else if(str.compare(".json") == 0 || str.compare(".ExportJson") == 0)
     {
-        data->configType = CocoStudio_JSON;
+        data->fileConfigType = CocoStudio_JSON;
+    }
+
+    data->fileView = openBinaryFile(data->fullPath);
+    if (data->fileView)
+    {
+        data->configType = CocoStudio_Binary;
+    }
+    else
+    {
+        data->fileView = CCFileUtils::getInstance()->openFileView(data->fullPath);
+        data->configType = data->fileConfigType;
     }
 
 
@@ -415,62 +497,114 @@ void DataReaderHelper::addDataFromFileAsync(const char *imagePath, const char *p
     _sleepCondition.notify_one();
 }
 
-void DataReaderHelper::addDataAsyncCallBack(float dt)
+// number of datas added to ArmatureDataManager per frame
+static const size_t DATAS_ADDED_PER_FRAME = 32;
+
+void DataReaderHelper::addDataAsyncCallBack(DataInfo *pDataInfo)
 {
     // the data is generated in loading thread
-    std::queue<DataInfo *> *dataQueue = _dataQueue;
+    AsyncStruct *pAsyncStruct = pDataInfo->asyncStruct;
+    ArmatureDataManager *dataManager = ArmatureDataManager::getInstance();
+    const char *configFilePath = pAsyncStruct->configType == DragonBone_XML ? pDataInfo->filename.c_str() : "";
 
-    _dataInfoMutex.lock();
-    if (dataQueue->empty())
+    // add a chunk of datas, the others are added on the next frames
+    size_t count = 0;
+    for (; count < DATAS_ADDED_PER_FRAME && count < pDataInfo->armatureDatas.size(); ++count)
     {
-        _dataInfoMutex.unlock();
+        ArmatureData *armatureData = pDataInfo->armatureDatas[count];
+        dataManager->addArmatureData(armatureData->name.c_str(), armatureData, configFilePath);
+        armatureData->release();
     }
-    else
-    {
-        DataInfo *pDataInfo = dataQueue->front();
-        dataQueue->pop();
-        _dataInfoMutex.unlock();
+    pDataInfo->armatureDatas.erase(pDataInfo->armatureDatas.begin(), pDataInfo->armatureDatas.begin() + count);
 
-        AsyncStruct *pAsyncStruct = pDataInfo->asyncStruct;
+    size_t added = count;
+    for (count = 0; added + count < DATAS_ADDED_PER_FRAME && count < pDataInfo->animationDatas.size(); ++count)
+    {
+        AnimationData *animationData = pDataInfo->animationDatas[count];
+        dataManager->addAnimationData(animationData->name.c_str(), animationData, configFilePath);
+        animationData->release();
+    }
+    pDataInfo->animationDatas.erase(pDataInfo->animationDatas.begin(), pDataInfo->animationDatas.begin() + count);
 
+    added += count;
+    for (count = 0; added + count < DATAS_ADDED_PER_FRAME && count < pDataInfo->textureDatas.size(); ++count)
+    {
+        TextureData *textureData = pDataInfo->textureDatas[count];
+        dataManager->addTextureData(textureData->name.c_str(), textureData, configFilePath);
+        textureData->release();
+    }
+    pDataInfo->textureDatas.erase(pDataInfo->textureDatas.begin(), pDataInfo->textureDatas.begin() + count);
 
+    // wait for the remaining datas, or for the textures being decoded
+    bool done = pDataInfo->armatureDatas.empty() && pDataInfo->animationDatas.empty() && pDataInfo->textureDatas.empty();
+    if (done)
+    {
+        TextureCache *textureCache = Director::getInstance()->getTextureCache();
         if (pAsyncStruct->imagePath != "" && pAsyncStruct->plistPath != "")
         {
-            _getFileMutex.lock();
-            ArmatureDataManager::getInstance()->addSpriteFrameFromFile(pAsyncStruct->plistPath.c_str(), pAsyncStruct->imagePath.c_str());
-            _getFileMutex.unlock();
+            done = !textureCache->isLoadingImageAsync(pAsyncStruct->imagePath);
         }
 
-        while (!pDataInfo->configFileQueue.empty())
+        std::queue<std::string> configFileQueue = pDataInfo->configFileQueue;
+        while (done && !configFileQueue.empty())
         {
-            std::string configPath = pDataInfo->configFileQueue.front();
-            _getFileMutex.lock();
-            ArmatureDataManager::getInstance()->addSpriteFrameFromFile((pAsyncStruct->baseFilePath + configPath + ".plist").c_str(), (pAsyncStruct->baseFilePath + configPath + ".png").c_str());
-            _getFileMutex.unlock();
-            pDataInfo->configFileQueue.pop();
+            done = !textureCache->isLoadingImageAsync(pAsyncStruct->baseFilePath + configFileQueue.front() + ".png");
+            configFileQueue.pop();
         }
+    }
 
+    if (!done)
+    {
+        Director::getInstance()->getScheduler()->performFunctionInCocosThread([this, pDataInfo] {
+            if (_dataReaderHelper == this)
+            {
+                addDataAsyncCallBack(pDataInfo);
+            }
+            else
+            {
+                deleteDataInfo(pDataInfo);
+            }
+        });
+        return;
+    }
 
-        Object *target = pAsyncStruct->target;
-        SEL_SCHEDULE selector = pAsyncStruct->selector;
 
-        --_asyncRefCount;
+    if (pAsyncStruct->imagePath != "" && pAsyncStruct->plistPath != "")
+    {
+        _getFileMutex.lock();
+        ArmatureDataManager::getInstance()->addSpriteFrameFromFile(pAsyncStruct->plistPath.c_str(), pAsyncStruct->imagePath.c_str());
+        _getFileMutex.unlock();
+    }
 
-        if (target && selector)
-        {
-            (target->*selector)((_asyncRefTotalCount - _asyncRefCount) / (float)_asyncRefTotalCount);
-            target->release();
-        }
+    while (!pDataInfo->configFileQueue.empty())
+    {
+        std::string configPath = pDataInfo->configFileQueue.front();
+        _getFileMutex.lock();
+        ArmatureDataManager::getInstance()->addSpriteFrameFromFile((pAsyncStruct->baseFilePath + configPath + ".plist").c_str(), (pAsyncStruct->baseFilePath + configPath + ".png").c_str());
+        _getFileMutex.unlock();
+        pDataInfo->configFileQueue.pop();
+    }
 
 
-        delete pAsyncStruct;
-        delete pDataInfo;
+    Object *target = pAsyncStruct->target;
+    SEL_SCHEDULE selector = pAsyncStruct->selector;
 
-        if (0 == _asyncRefCount)
-        {
-            _asyncRefTotalCount = 0;
-            CCDirector::getInstance()->getScheduler()->unscheduleSelector(schedule_selector(DataReaderHelper::addDataAsyncCallBack), this);
-        }
+    --_asyncRefCount;
+
+    if (target && selector)
+    {
+        (target->*selector)((_asyncRefTotalCount - _asyncRefCount) / (float)_asyncRefTotalCount);
+        target->release();
+    }
+
+
+    CC_SAFE_RELEASE(pAsyncStruct->fileView);
+    delete pAsyncStruct;
+    delete pDataInfo;
+
+    if (0 == _asyncRefCount)
+    {
+        _asyncRefTotalCount = 0;
     }
 }
 
@@ -516,13 +650,13 @@ void DataReaderHelper::addDataFromCache(const char *pFileContent, DataInfo *data
 
         if (dataInfo->asyncStruct)
         {
-            _dataReaderHelper->_addDataMutex.lock();
+            // added on the main thread
+            dataInfo->armatureDatas.push_back(armatureData);
         }
-        ArmatureDataManager::getInstance()->addArmatureData(armatureData->name.c_str(), armatureData, dataInfo->filename.c_str());
-        armatureData->release();
-        if (dataInfo->asyncStruct)
+        else
         {
-            _dataReaderHelper->_addDataMutex.unlock();
+            ArmatureDataManager::getInstance()->addArmatureData(armatureData->name.c_str(), armatureData, dataInfo->filename.c_str());
+            armatureData->release();
         }
 
         armatureXML = armatureXML->NextSiblingElement(ARMATURE);
@@ -539,13 +673,13 @@ void DataReaderHelper::addDataFromCache(const char *pFileContent, DataInfo *data
         AnimationData *animationData = DataReaderHelper::decodeAnimation(animationXML, dataInfo);
         if (dataInfo->asyncStruct)
         {
-            _dataReaderHelper->_addDataMutex.lock();
+            // added on the main thread
+            dataInfo->animationDatas.push_back(animationData);
         }
-        ArmatureDataManager::getInstance()->addAnimationData(animationData->name.c_str(), animationData, dataInfo->filename.c_str());
-        animationData->release();
-        if (dataInfo->asyncStruct)
+        else
         {
-            _dataReaderHelper->_addDataMutex.unlock();
+            ArmatureDataManager::getInstance()->addAnimationData(animationData->name.c_str(), animationData, dataInfo->filename.c_str());
+            animationData->release();
         }
         animationXML = animationXML->NextSiblingElement(ANIMATION);
     }
@@ -562,13 +696,13 @@ void DataReaderHelper::addDataFromCache(const char *pFileContent, DataInfo *data
 
         if (dataInfo->asyncStruct)
         {
-            _dataReaderHelper->_addDataMutex.lock();
+            // added on the main thread
+            dataInfo->textureDatas.push_back(textureData);
         }
-        ArmatureDataManager::getInstance()->addTextureData(textureData->name.c_str(), textureData, dataInfo->filename.c_str());
-        textureData->release();
-        if (dataInfo->asyncStruct)
+        else
         {
-            _dataReaderHelper->_addDataMutex.unlock();
+            ArmatureDataManager::getInstance()->addTextureData(textureData->name.c_str(), textureData, dataInfo->filename.c_str());
+            textureData->release();
         }
         textureXML = textureXML->NextSiblingElement(SUB_TEXTURE);
     }
@@ -692,7 +826,19 @@ AnimationData *DataReaderHelper::decodeAnimation(tinyxml2::XMLElement *animation
 
     const char	*name = animationXML->Attribute(A_NAME);
 
-    ArmatureData *armatureData = ArmatureDataManager::getInstance()->getArmatureData(name);
+    // the armatures of the file are not added yet when it is loaded asynchronously
+    ArmatureData *armatureData = nullptr;
+    for (auto data : dataInfo->armatureDatas)
+    {
+        if (data->name == name)
+        {
+            armatureData = data;
+        }
+    }
+    if (armatureData == nullptr)
+    {
+        armatureData = ArmatureDataManager::getInstance()->getArmatureData(name);
+    }
 
     aniData->name = name;
 
@@ -1131,13 +1277,13 @@ ContourData *DataReaderHelper::decodeContour(tinyxml2::XMLElement *contourXML, D
     while (vertexDataXML)
     {
         ContourVertex2 *vertex = new ContourVertex2(0, 0);
-        vertex->release();
 
         vertexDataXML->QueryFloatAttribute(A_X, &vertex->x);
         vertexDataXML->QueryFloatAttribute(A_Y, &vertex->y);
 
         vertex->y = -vertex->y;
         contourData->vertexList.addObject(vertex);
+        vertex->release();
 
         vertexDataXML = vertexDataXML->NextSiblingElement(CONTOUR_VERTEX);
     }
@@ -1154,6 +1300,30 @@ void DataReaderHelper::addDataFromJsonCache(const char *fileContent, DataInfo *d
 
     dataInfo->contentScale = json.getItemFloatValue(CONTENT_SCALE, 1);
 
+    // Auto load sprite file, first so that the textures are decoded while the datas are
+    bool autoLoad = dataInfo->asyncStruct == nullptr ? ArmatureDataManager::getInstance()->isAutoLoadSpriteFile() : dataInfo->asyncStruct->autoLoadSpriteFile;
+    if (autoLoad)
+    {
+        std::vector<std::string> configFiles;
+
+        int length = json.getArrayItemCount(CONFIG_FILE_PATH);
+        for (int i = 0; i < length; i++)
+        {
+            const char *path = json.getStringValueFromArray(CONFIG_FILE_PATH, i);
+            if (path == nullptr)
+            {
+                CCLOG("load CONFIG_FILE_PATH error.");
+                break;
+            }
+
+            std::string filePath = path;
+            filePath = filePath.erase(filePath.find_last_of("."));
+            configFiles.push_back(filePath);
+        }
+
+        addConfigFiles(configFiles, dataInfo);
+    }
+
     // Decode armatures
     int length = json.getArrayItemCount(ARMATURE_DATA);
     for (int i = 0; i < length; i++)
@@ -1163,13 +1333,13 @@ void DataReaderHelper::addDataFromJsonCache(const char *fileContent, DataInfo *d
 
         if (dataInfo->asyncStruct)
         {
-            _dataReaderHelper->_addDataMutex.lock();
+            // added on the main thread
+            dataInfo->armatureDatas.push_back(armatureData);
         }
-        ArmatureDataManager::getInstance()->addArmatureData(armatureData->name.c_str(), armatureData);
-        armatureData->release();
-        if (dataInfo->asyncStruct)
+        else
         {
-            _dataReaderHelper->_addDataMutex.unlock();
+            ArmatureDataManager::getInstance()->addArmatureData(armatureData->name.c_str(), armatureData);
+            armatureData->release();
         }
         delete armatureDic;
     }
@@ -1183,13 +1353,13 @@ void DataReaderHelper::addDataFromJsonCache(const char *fileContent, DataInfo *d
 
         if (dataInfo->asyncStruct)
         {
-            _dataReaderHelper->_addDataMutex.lock();
+            // added on the main thread
+            dataInfo->animationDatas.push_back(animationData);
         }
-        ArmatureDataManager::getInstance()->addAnimationData(animationData->name.c_str(), animationData);
-        animationData->release();
-        if (dataInfo->asyncStruct)
+        else
         {
-            _dataReaderHelper->_addDataMutex.unlock();
+            ArmatureDataManager::getInstance()->addAnimationData(animationData->name.c_str(), animationData);
+            animationData->release();
         }
         delete animationDic;
     }
@@ -1203,47 +1373,16 @@ void DataReaderHelper::addDataFromJsonCache(const char *fileContent, DataInfo *d
 
         if (dataInfo->asyncStruct)
         {
-            _dataReaderHelper->_addDataMutex.lock();
+            // added on the main thread
+            dataInfo->textureDatas.push_back(textureData);
         }
-        ArmatureDataManager::getInstance()->addTextureData(textureData->name.c_str(), textureData);
-        textureData->release();
-        if (dataInfo->asyncStruct)
+        else
         {
-            _dataReaderHelper->_addDataMutex.unlock();
+            ArmatureDataManager::getInstance()->addTextureData(textureData->name.c_str(), textureData);
+            textureData->release();
         }
         delete textureDic;
     }
-
-    // Auto load sprite file
-    bool autoLoad = dataInfo->asyncStruct == nullptr ? ArmatureDataManager::getInstance()->isAutoLoadSpriteFile() : dataInfo->asyncStruct->autoLoadSpriteFile;
-    if (autoLoad)
-    {
-        length = json.getArrayItemCount(CONFIG_FILE_PATH);
-        for (int i = 0; i < length; i++)
-        {
-            const char *path = json.getStringValueFromArray(CONFIG_FILE_PATH, i);
-            if (path == nullptr)
-            {
-                CCLOG("load CONFIG_FILE_PATH error.");
-                return;
-            }
-
-            std::string filePath = path;
-            filePath = filePath.erase(filePath.find_last_of("."));
-
-            if (dataInfo->asyncStruct)
-            {
-                dataInfo->configFileQueue.push(filePath);
-            }
-            else
-            {
-                std::string plistPath = filePath + ".plist";
-                std::string pngPath =  filePath + ".png";
-
-                ArmatureDataManager::getInstance()->addSpriteFrameFromFile((dataInfo->baseFilePath + plistPath).c_str(), (dataInfo->baseFilePath + pngPath).c_str());
-            }
-        }
-    }
 }
 
 ArmatureData *DataReaderHelper::decodeArmature(JsonDictionary &json, DataInfo *dataInfo)
@@ -1635,4 +1774,863 @@ void DataReaderHelper::decodeNode(BaseData *node, JsonDictionary &json, DataInfo
 
 }
 
+
+
+/*
+ * Binary config files
+ *
+ * The datas decoded from a config file, as they are added to ArmatureDataManager. The file starts with a
+ * BinaryHeader, followed by the sections, which are arrays of 32 bits records in the byte order of the
+ * device which saved them. The records refer to the strings and to their children by index, so that
+ * the file is read in place, without parsing.
+ */
+
+static const char BINARY_FILE_SUFFIX[] = ".bin";
+static const char BINARY_FILE_MAGIC[4] = { 'C', 'S', 'A', 'B' };
+static const uint32_t BINARY_FILE_VERSION = 1;
+static const uint32_t BINARY_FILE_BYTE_ORDER = 0x01020304;
+static const uint32_t BINARY_FILE_XML = 1;      //! saved from a xml file, the datas are added with their config file path
+
+enum BinarySection
+{
+    BINARY_STRINGS,             //! offsets of the strings in BINARY_CHARS
+    BINARY_CHARS,               //! zero terminated strings
+    BINARY_CONFIG_FILES,        //! sprite files, without extension
+    BINARY_ARMATURES,
+    BINARY_BONES,
+    BINARY_DISPLAYS,
+    BINARY_ANIMATIONS,
+    BINARY_MOVEMENTS,
+    BINARY_MOVEMENT_BONES,
+    BINARY_FRAMES,
+    BINARY_TEXTURES,
+    BINARY_CONTOURS,
+    BINARY_VERTICES,
+    BINARY_SECTION_COUNT
+};
+
+struct BinaryHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t flags;
+    float positionReadScale;                        //! the position read scale of the datas
+    uint32_t sectionOffsets[BINARY_SECTION_COUNT];
+    uint32_t sectionCounts[BINARY_SECTION_COUNT];   //! records, or bytes for BINARY_CHARS
+};
+
+struct BinaryNode
+{
+    float x, y;
+    int32_t zOrder;
+    float skewX, skewY, scaleX, scaleY, tweenRotate;
+    int32_t isUseColorInfo, a, r, g, b;
+};
+
+struct BinaryArmature
+{
+    uint32_t name;
+    float dataVersion;
+    uint32_t firstBone, boneCount;
+};
+
+struct BinaryBone
+{
+    BinaryNode node;
+    uint32_t name, parentName;
+    uint32_t firstDisplay, displayCount;
+};
+
+struct BinaryDisplay
+{
+    int32_t displayType;
+    uint32_t name;              //! display name, or plist relative to the config file for the particles
+    BinaryNode skin;
+};
+
+struct BinaryAnimation
+{
+    uint32_t name;
+    uint32_t firstMovement, movementCount;
+};
+
+struct BinaryMovement
+{
+    uint32_t name;
+    int32_t duration;
+    float scale;
+    int32_t durationTo, durationTween, loop, tweenEasing;
+    uint32_t firstMovementBone, movementBoneCount;
+};
+
+struct BinaryMovementBone
+{
+    uint32_t name;
+    float delay, scale, duration;
+    uint32_t firstFrame, frameCount;
+};
+
+struct BinaryFrame
+{
+    BinaryNode node;
+    int32_t frameID, duration, tweenEasing, isTween, displayIndex, blendType;
+    uint32_t strEvent, strMovement, strSound, strSoundEffect;
+};
+
+struct BinaryTexture
+{
+    uint32_t name;
+    float width, height, pivotX, pivotY;
+    uint32_t firstContour, contourCount;
+};
+
+struct BinaryContour
+{
+    uint32_t firstVertex, vertexCount;
+};
+
+struct BinaryVertex
+{
+    float x, y;
+};
+
+static size_t binaryRecordSize(int section)
+{
+    switch (section)
+    {
+    case BINARY_STRINGS:        return sizeof(uint32_t);
+    case BINARY_CHARS:          return 1;
+    case BINARY_CONFIG_FILES:   return sizeof(uint32_t);
+    case BINARY_ARMATURES:      return sizeof(BinaryArmature);
+    case BINARY_BONES:          return sizeof(BinaryBone);
+    case BINARY_DISPLAYS:       return sizeof(BinaryDisplay);
+    case BINARY_ANIMATIONS:     return sizeof(BinaryAnimation);
+    case BINARY_MOVEMENTS:      return sizeof(BinaryMovement);
+    case BINARY_MOVEMENT_BONES: return sizeof(BinaryMovementBone);
+    case BINARY_FRAMES:         return sizeof(BinaryFrame);
+    case BINARY_TEXTURES:       return sizeof(BinaryTexture);
+    case BINARY_CONTOURS:       return sizeof(BinaryContour);
+    case BINARY_VERTICES:       return sizeof(BinaryVertex);
+    default:                    return 0;
+    }
+}
+
+static bool isValidBinaryHeader(const unsigned char *fileContent, long size)
+{
+    if (fileContent == nullptr || size < (long)sizeof(BinaryHeader))
+    {
+        return false;
+    }
+
+    const BinaryHeader *header = (const BinaryHeader *)fileContent;
+    return memcmp(header->magic, BINARY_FILE_MAGIC, sizeof(BINARY_FILE_MAGIC)) == 0
+        && header->version == BINARY_FILE_VERSION
+        && header->byteOrder == BINARY_FILE_BYTE_ORDER
+        && header->positionReadScale > 0;
+}
+
+static void writeBinaryNode(BinaryNode &out, const BaseData &node)
+{
+    out.x = node.x;
+    out.y = node.y;
+    out.zOrder = node.zOrder;
+    out.skewX = node.skewX;
+    out.skewY = node.skewY;
+    out.scaleX = node.scaleX;
+    out.scaleY = node.scaleY;
+    out.tweenRotate = node.tweenRotate;
+    out.isUseColorInfo = node.isUseColorInfo;
+    out.a = node.a;
+    out.r = node.r;
+    out.g = node.g;
+    out.b = node.b;
+}
+
+static void readBinaryNode(BaseData &node, const BinaryNode &in, float positionScale)
+{
+    node.x = in.x * positionScale;
+    node.y = in.y * positionScale;
+    node.zOrder = in.zOrder;
+    node.skewX = in.skewX;
+    node.skewY = in.skewY;
+    node.scaleX = in.scaleX;
+    node.scaleY = in.scaleY;
+    node.tweenRotate = in.tweenRotate;
+    node.isUseColorInfo = in.isUseColorInfo != 0;
+    node.a = in.a;
+    node.r = in.r;
+    node.g = in.g;
+    node.b = in.b;
+}
+
+namespace {
+
+// the records of each section are added once their children are added, so that they are contiguous
+class BinaryWriter
+{
+public:
+    BinaryWriter()
+    {
+        memset(_counts, 0, sizeof(_counts));
+    }
+
+    uint32_t addString(const std::string &str)
+    {
+        auto iter = _strings.find(str);
+        if (iter != _strings.end())
+        {
+            return iter->second;
+        }
+
+        uint32_t index = add(BINARY_STRINGS, (uint32_t)_sections[BINARY_CHARS].size());
+        _sections[BINARY_CHARS].insert(_sections[BINARY_CHARS].end(), str.c_str(), str.c_str() + str.size() + 1);
+        _counts[BINARY_CHARS] = (uint32_t)_sections[BINARY_CHARS].size();
+
+        _strings[str] = index;
+        return index;
+    }
+
+    template <typename T>
+    uint32_t add(BinarySection section, const T &record)
+    {
+        const char *bytes = (const char *)&record;
+        _sections[section].insert(_sections[section].end(), bytes, bytes + sizeof(T));
+        return _counts[section]++;
+    }
+
+    uint32_t count(BinarySection section) const
+    {
+        return _counts[section];
+    }
+
+    bool save(const char *filePath, uint32_t flags)
+    {
+        BinaryHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, BINARY_FILE_MAGIC, sizeof(BINARY_FILE_MAGIC));
+        header.version = BINARY_FILE_VERSION;
+        header.byteOrder = BINARY_FILE_BYTE_ORDER;
+        header.flags = flags;
+        header.positionReadScale = DataReaderHelper::getPositionReadScale();
+
+        // the sections are aligned on 4 bytes, so that the records are read in place
+        uint32_t offset = sizeof(header);
+        for (int i = 0; i < BINARY_SECTION_COUNT; ++i)
+        {
+            _sections[i].resize((_sections[i].size() + 3) & ~3, 0);
+            header.sectionOffsets[i] = offset;
+            header.sectionCounts[i] = _counts[i];
+            offset += _sections[i].size();
+        }
+
+        FILE *fp = fopen(filePath, "wb");
+        if (!fp)
+        {
+            return false;
+        }
+
+        bool written = fwrite(&header, sizeof(header), 1, fp) == 1;
+        for (int i = 0; written && i < BINARY_SECTION_COUNT; ++i)
+        {
+            written = _sections[i].empty() || fwrite(&_sections[i][0], _sections[i].size(), 1, fp) == 1;
+        }
+        return fclose(fp) == 0 && written;
+    }
+
+private:
+    std::vector<char> _sections[BINARY_SECTION_COUNT];
+    uint32_t _counts[BINARY_SECTION_COUNT];
+    std::unordered_map<std::string, uint32_t> _strings;
+};
+
+}
+
+FileView *DataReaderHelper::openBinaryFile(const std::string &fullPath)
+{
+    std::string binaryPath = fullPath + BINARY_FILE_SUFFIX;
+    if (!FileUtils::getInstance()->isFileExist(binaryPath))
+    {
+        return nullptr;
+    }
+
+    // a file saved by another version, or on a device of another byte order, is replaced by its config file
+    FileView *fileView = FileUtils::getInstance()->openFileView(binaryPath);
+    if (fileView && !isValidBinaryHeader(fileView->getBytes(), fileView->getSize()))
+    {
+        CCLOG("ignore armature binary file: %s", binaryPath.c_str());
+        CC_SAFE_RELEASE_NULL(fileView);
+    }
+    return fileView;
+}
+
+void DataReaderHelper::addConfigFiles(const std::vector<std::string> &configFiles, DataInfo *dataInfo)
+{
+    std::vector<std::string> texturePaths;
+
+    for (auto& filePath : configFiles)
+    {
+        if (dataInfo->asyncStruct)
+        {
+            dataInfo->configFileQueue.push(filePath);
+            texturePaths.push_back(dataInfo->baseFilePath + filePath + ".png");
+        }
+        else
+        {
+            std::string plistPath = filePath + ".plist";
+            std::string pngPath =  filePath + ".png";
+
+            ArmatureDataManager::getInstance()->addSpriteFrameFromFile((dataInfo->baseFilePath + plistPath).c_str(), (dataInfo->baseFilePath + pngPath).c_str());
+        }
+    }
+
+    if (!texturePaths.empty() && dataInfo->asyncStruct->preloadTextures)
+    {
+        Director::getInstance()->getScheduler()->performFunctionInCocosThread([texturePaths] {
+            for (auto& texturePath : texturePaths)
+            {
+                Director::getInstance()->getTextureCache()->addImageAsync(texturePath, nullptr, nullptr);
+            }
+        });
+    }
+}
+
+bool DataReaderHelper::saveBinaryFile(const char *filePath, const char *binaryFilePath)
+{
+    std::string filePathStr = filePath;
+    size_t startPos = filePathStr.find_last_of(".");
+    std::string str = startPos != std::string::npos ? filePathStr.substr(startPos) : "";
+
+    std::string fullPath = CCFileUtils::getInstance()->fullPathForFilename(filePath);
+    FileView *fileView = CCFileUtils::getInstance()->openFileView(fullPath);
+    if (!fileView)
+    {
+        return false;
+    }
+
+    // decode the datas as if the file was loaded asynchronously, so they are kept rather than added
+    AsyncStruct asyncStruct;
+    asyncStruct.filename = filePathStr;
+    asyncStruct.fileView = nullptr;
+    asyncStruct.baseFilePath = filePathStr.substr(0, filePathStr.find_last_of("/") + 1);
+    asyncStruct.target = nullptr;
+    asyncStruct.selector = nullptr;
+    asyncStruct.autoLoadSpriteFile = true;
+    asyncStruct.preloadTextures = false;
+
+    DataInfo dataInfo;
+    dataInfo.asyncStruct = &asyncStruct;
+    dataInfo.filename = asyncStruct.filename;
+    dataInfo.baseFilePath = asyncStruct.baseFilePath;
+
+    bool isXML = str.compare(".xml") == 0;
+    bool decoded = true;
+    if (isXML)
+    {
+        DataReaderHelper::addDataFromCache((const char *)fileView->getBytes(), &dataInfo);
+    }
+    else if (str.compare(".json") == 0 || str.compare(".ExportJson") == 0)
+    {
+        DataReaderHelper::addDataFromJsonCache((const char *)fileView->getBytes(), &dataInfo);
+    }
+    else
+    {
+        decoded = false;
+    }
+    fileView->release();
+
+    bool saved = decoded && writeBinaryFile(binaryFilePath, &dataInfo, isXML);
+
+    for (auto armatureData : dataInfo.armatureDatas)
+    {
+        armatureData->release();
+    }
+    for (auto animationData : dataInfo.animationDatas)
+    {
+        animationData->release();
+    }
+    for (auto textureData : dataInfo.textureDatas)
+    {
+        textureData->release();
+    }
+
+    return saved;
+}
+
+bool DataReaderHelper::writeBinaryFile(const char *binaryFilePath, DataInfo *dataInfo, bool isXML)
+{
+    BinaryWriter writer;
+
+    std::queue<std::string> configFileQueue = dataInfo->configFileQueue;
+    while (!configFileQueue.empty())
+    {
+        writer.add(BINARY_CONFIG_FILES, writer.addString(configFileQueue.front()));
+        configFileQueue.pop();
+    }
+
+    for (auto armatureData : dataInfo->armatureDatas)
+    {
+        BinaryArmature armature;
+        armature.name = writer.addString(armatureData->name);
+        armature.dataVersion = armatureData->dataVersion;
+        armature.firstBone = writer.count(BINARY_BONES);
+        armature.boneCount = 0;
+
+        // the bones are added in the order of the dictionary
+        Dictionary *boneDataDic = &armatureData->boneDataDic;
+        DictElement *element = nullptr;
+        CCDICT_FOREACH(boneDataDic, element)
+        {
+            BoneData *boneData = static_cast<BoneData *>(element->getObject());
+
+            BinaryBone bone;
+            writeBinaryNode(bone.node, *boneData);
+            bone.name = writer.addString(boneData->name);
+            bone.parentName = writer.addString(boneData->parentName);
+            bone.firstDisplay = writer.count(BINARY_DISPLAYS);
+            bone.displayCount = boneData->displayDataList.count();
+
+            Object *object = nullptr;
+            CCARRAY_FOREACH(&boneData->displayDataList, object)
+            {
+                DisplayData *displayData = static_cast<DisplayData *>(object);
+
+                BinaryDisplay display;
+                memset(&display, 0, sizeof(display));
+                display.displayType = displayData->displayType;
+
+                switch (displayData->displayType)
+                {
+                case CS_DISPLAY_SPRITE:
+                    display.name = writer.addString(static_cast<SpriteDisplayData *>(displayData)->displayName);
+                    writeBinaryNode(display.skin, static_cast<SpriteDisplayData *>(displayData)->skinData);
+                    break;
+                case CS_DISPLAY_ARMATURE:
+                    display.name = writer.addString(static_cast<ArmatureDisplayData *>(displayData)->displayName);
+                    break;
+                case CS_DISPLAY_PARTICLE:
+                {
+                    std::string plist = static_cast<ParticleDisplayData *>(displayData)->plist;
+                    if (plist.compare(0, dataInfo->baseFilePath.size(), dataInfo->baseFilePath) == 0)
+                    {
+                        plist = plist.substr(dataInfo->baseFilePath.size());
+                    }
+                    display.name = writer.addString(plist);
+                }
+                break;
+                default:
+                    display.name = writer.addString("");
+                    break;
+                }
+
+                writer.add(BINARY_DISPLAYS, display);
+            }
+
+            writer.add(BINARY_BONES, bone);
+            ++armature.boneCount;
+        }
+
+        writer.add(BINARY_ARMATURES, armature);
+    }
+
+    for (auto animationData : dataInfo->animationDatas)
+    {
+        BinaryAnimation animation;
+        animation.name = writer.addString(animationData->name);
+        animation.firstMovement = writer.count(BINARY_MOVEMENTS);
+        animation.movementCount = 0;
+
+        for (auto& movementName : animationData->movementNames)
+        {
+            MovementData *movementData = animationData->getMovement(movementName.c_str());
+
+            BinaryMovement movement;
+            movement.name = writer.addString(movementData->name);
+            movement.duration = movementData->duration;
+            movement.scale = movementData->scale;
+            movement.durationTo = movementData->durationTo;
+            movement.durationTween = movementData->durationTween;
+            movement.loop = movementData->loop;
+            movement.tweenEasing = movementData->tweenEasing;
+            movement.firstMovementBone = writer.count(BINARY_MOVEMENT_BONES);
+            movement.movementBoneCount = 0;
+
+            Dictionary *movBoneDataDic = &movementData->movBoneDataDic;
+            DictElement *element = nullptr;
+            CCDICT_FOREACH(movBoneDataDic, element)
+            {
+                MovementBoneData *movBoneData = static_cast<MovementBoneData *>(element->getObject());
+
+                BinaryMovementBone movementBone;
+                movementBone.name = writer.addString(movBoneData->name);
+                movementBone.delay = movBoneData->delay;
+                movementBone.scale = movBoneData->scale;
+                movementBone.duration = movBoneData->duration;
+                movementBone.firstFrame = writer.count(BINARY_FRAMES);
+                movementBone.frameCount = movBoneData->frameList.count();
+
+                Object *object = nullptr;
+                CCARRAY_FOREACH(&movBoneData->frameList, object)
+                {
+                    FrameData *frameData = static_cast<FrameData *>(object);
+
+                    BinaryFrame frame;
+                    writeBinaryNode(frame.node, *frameData);
+                    frame.frameID = frameData->frameID;
+                    frame.duration = frameData->duration;
+                    frame.tweenEasing = frameData->tweenEasing;
+                    frame.isTween = frameData->isTween;
+                    frame.displayIndex = frameData->displayIndex;
+                    frame.blendType = frameData->blendType;
+                    frame.strEvent = writer.addString(frameData->strEvent);
+                    frame.strMovement = writer.addString(frameData->strMovement);
+                    frame.strSound = writer.addString(frameData->strSound);
+                    frame.strSoundEffect = writer.addString(frameData->strSoundEffect);
+
+                    writer.add(BINARY_FRAMES, frame);
+                }
+
+                writer.add(BINARY_MOVEMENT_BONES, movementBone);
+                ++movement.movementBoneCount;
+            }
+
+            writer.add(BINARY_MOVEMENTS, movement);
+            ++animation.movementCount;
+        }
+
+        writer.add(BINARY_ANIMATIONS, animation);
+    }
+
+    for (auto textureData : dataInfo->textureDatas)
+    {
+        BinaryTexture texture;
+        texture.name = writer.addString(textureData->name);
+        texture.width = textureData->width;
+        texture.height = textureData->height;
+        texture.pivotX = textureData->pivotX;
+        texture.pivotY = textureData->pivotY;
+        texture.firstContour = writer.count(BINARY_CONTOURS);
+        texture.contourCount = textureData->contourDataList.count();
+
+        Object *object = nullptr;
+        CCARRAY_FOREACH(&textureData->contourDataList, object)
+        {
+            ContourData *contourData = static_cast<ContourData *>(object);
+
+            BinaryContour contour;
+            contour.firstVertex = writer.count(BINARY_VERTICES);
+            contour.vertexCount = contourData->vertexList.count();
+
+            Object *vertexObject = nullptr;
+            CCARRAY_FOREACH(&contourData->vertexList, vertexObject)
+            {
+                ContourVertex2 *vertex2 = static_cast<ContourVertex2 *>(vertexObject);
+
+                BinaryVertex vertex;
+                vertex.x = vertex2->x;
+                vertex.y = vertex2->y;
+                writer.add(BINARY_VERTICES, vertex);
+            }
+
+            writer.add(BINARY_CONTOURS, contour);
+        }
+
+        writer.add(BINARY_TEXTURES, texture);
+    }
+
+    return writer.save(binaryFilePath, isXML ? BINARY_FILE_XML : 0);
+}
+
+bool DataReaderHelper::addDataFromBinaryCache(const unsigned char *fileContent, long size, DataInfo *dataInfo)
+{
+    if (!isValidBinaryHeader(fileContent, size))
+    {
+        return false;
+    }
+
+    const BinaryHeader *header = (const BinaryHeader *)fileContent;
+    const uint32_t *counts = header->sectionCounts;
+
+    for (int i = 0; i < BINARY_SECTION_COUNT; ++i)
+    {
+        uint32_t offset = header->sectionOffsets[i];
+        if (offset % 4 != 0 || offset > (unsigned long)size || (uint64_t)counts[i] * binaryRecordSize(i) > (uint64_t)(size - offset))
+        {
+            return false;
+        }
+    }
+
+    const uint32_t *strings = (const uint32_t *)(fileContent + header->sectionOffsets[BINARY_STRINGS]);
+    const char *chars = (const char *)(fileContent + header->sectionOffsets[BINARY_CHARS]);
+    const uint32_t *configFiles = (const uint32_t *)(fileContent + header->sectionOffsets[BINARY_CONFIG_FILES]);
+    const BinaryArmature *armatures = (const BinaryArmature *)(fileContent + header->sectionOffsets[BINARY_ARMATURES]);
+    const BinaryBone *bones = (const BinaryBone *)(fileContent + header->sectionOffsets[BINARY_BONES]);
+    const BinaryDisplay *displays = (const BinaryDisplay *)(fileContent + header->sectionOffsets[BINARY_DISPLAYS]);
+    const BinaryAnimation *animations = (const BinaryAnimation *)(fileContent + header->sectionOffsets[BINARY_ANIMATIONS]);
+    const BinaryMovement *movements = (const BinaryMovement *)(fileContent + header->sectionOffsets[BINARY_MOVEMENTS]);
+    const BinaryMovementBone *movementBones = (const BinaryMovementBone *)(fileContent + header->sectionOffsets[BINARY_MOVEMENT_BONES]);
+    const BinaryFrame *frames = (const BinaryFrame *)(fileContent + header->sectionOffsets[BINARY_FRAMES]);
+    const BinaryTexture *textures = (const BinaryTexture *)(fileContent + header->sectionOffsets[BINARY_TEXTURES]);
+    const BinaryContour *contours = (const BinaryContour *)(fileContent + header->sectionOffsets[BINARY_CONTOURS]);
+    const BinaryVertex *vertices = (const BinaryVertex *)(fileContent + header->sectionOffsets[BINARY_VERTICES]);
+
+    /*
+    * Check the indices first, so that nothing is added from a damaged file
+    */
+    auto isValidString = [&](uint32_t index) { return index < counts[BINARY_STRINGS]; };
+    auto isValidRange = [&](uint32_t first, uint32_t count, BinarySection section) { return (uint64_t)first + count <= counts[section]; };
+
+    bool valid = counts[BINARY_CHARS] == 0 || chars[counts[BINARY_CHARS] - 1] == '\0';
+    for (uint32_t i = 0; valid && i < counts[BINARY_STRINGS]; ++i)
+    {
+        valid = strings[i] < counts[BINARY_CHARS];
+    }
+    for (uint32_t i = 0; valid && i < counts[BINARY_CONFIG_FILES]; ++i)
+    {
+        valid = isValidString(configFiles[i]);
+    }
+    for (uint32_t i = 0; valid && i < counts[BINARY_ARMATURES]; ++i)
+    {
+        valid = isValidString(armatures[i].name) && isValidRange(armatures[i].firstBone, armatures[i].boneCount, BINARY_BONES);
+    }
+    for (uint32_t i = 0; valid && i < counts[BINARY_BONES]; ++i)
+    {
+        valid = isValidString(bones[i].name) && isValidString(bones[i].parentName) && isValidRange(bones[i].firstDisplay, bones[i].displayCount, BINARY_DISPLAYS);
+    }
+    for (uint32_t i = 0; valid && i < counts[BINARY_DISPLAYS]; ++i)
+    {
+        valid = isValidString(displays[i].name);
+    }
+    for (uint32_t i = 0; valid && i < counts[BINARY_ANIMATIONS]; ++i)
+    {
+        valid = isValidString(animations[i].name) && isValidRange(animations[i].firstMovement, animations[i].movementCount, BINARY_MOVEMENTS);
+    }
+    for (uint32_t i = 0; valid && i < counts[BINARY_MOVEMENTS]; ++i)
+    {
+        valid = isValidString(movements[i].name) && isValidRange(movements[i].firstMovementBone, movements[i].movementBoneCount, BINARY_MOVEMENT_BONES);
+    }
+    for (uint32_t i = 0; valid && i < counts[BINARY_MOVEMENT_BONES]; ++i)
+    {
+        valid = isValidString(movementBones[i].name) && isValidRange(movementBones[i].firstFrame, movementBones[i].frameCount, BINARY_FRAMES);
+    }
+    for (uint32_t i = 0; valid && i < counts[BINARY_FRAMES]; ++i)
+    {
+        valid = isValidString(frames[i].strEvent) && isValidString(frames[i].strMovement) && isValidString(frames[i].strSound) && isValidString(frames[i].strSoundEffect);
+    }
+    for (uint32_t i = 0; valid && i < counts[BINARY_TEXTURES]; ++i)
+    {
+        valid = isValidString(textures[i].name) && isValidRange(textures[i].firstContour, textures[i].contourCount, BINARY_CONTOURS);
+    }
+    for (uint32_t i = 0; valid && i < counts[BINARY_CONTOURS]; ++i)
+    {
+        valid = isValidRange(contours[i].firstVertex, contours[i].vertexCount, BINARY_VERTICES);
+    }
+    if (!valid)
+    {
+        return false;
+    }
+
+    auto getString = [&](uint32_t index) { return chars + strings[index]; };
+
+    // the positions are scaled again if the position read scale changed since the file was saved
+    float positionScale = s_PositionReadScale / header->positionReadScale;
+
+    bool isXML = (header->flags & BINARY_FILE_XML) != 0;
+    const char *configFilePath = isXML ? dataInfo->filename.c_str() : "";
+    if (dataInfo->asyncStruct)
+    {
+        // the datas are added on the main thread as the ones of the config file
+        dataInfo->asyncStruct->configType = isXML ? DragonBone_XML : CocoStudio_JSON;
+    }
+
+    bool autoLoad = dataInfo->asyncStruct == nullptr ? ArmatureDataManager::getInstance()->isAutoLoadSpriteFile() : dataInfo->asyncStruct->autoLoadSpriteFile;
+    if (autoLoad)
+    {
+        std::vector<std::string> configFileList;
+        for (uint32_t i = 0; i < counts[BINARY_CONFIG_FILES]; ++i)
+        {
+            configFileList.push_back(getString(configFiles[i]));
+        }
+        addConfigFiles(configFileList, dataInfo);
+    }
+
+    for (uint32_t i = 0; i < counts[BINARY_ARMATURES]; ++i)
+    {
+        const BinaryArmature &armature = armatures[i];
+
+        ArmatureData *armatureData = new ArmatureData();
+        armatureData->init();
+        armatureData->name = getString(armature.name);
+        armatureData->dataVersion = armature.dataVersion;
+
+        for (uint32_t j = armature.firstBone; j < armature.firstBone + armature.boneCount; ++j)
+        {
+            const BinaryBone &bone = bones[j];
+
+            BoneData *boneData = new BoneData();
+            boneData->init();
+            readBinaryNode(*boneData, bone.node, positionScale);
+            boneData->name = getString(bone.name);
+            boneData->parentName = getString(bone.parentName);
+
+            for (uint32_t k = bone.firstDisplay; k < bone.firstDisplay + bone.displayCount; ++k)
+            {
+                const BinaryDisplay &display = displays[k];
+
+                DisplayData *displayData = nullptr;
+                switch (display.displayType)
+                {
+                case CS_DISPLAY_ARMATURE:
+                    displayData = new ArmatureDisplayData();
+                    static_cast<ArmatureDisplayData *>(displayData)->displayName = getString(display.name);
+                    break;
+                case CS_DISPLAY_PARTICLE:
+                    displayData = new ParticleDisplayData();
+                    static_cast<ParticleDisplayData *>(displayData)->plist = dataInfo->baseFilePath + getString(display.name);
+                    break;
+                default:
+                    displayData = new SpriteDisplayData();
+                    static_cast<SpriteDisplayData *>(displayData)->displayName = getString(display.name);
+                    readBinaryNode(static_cast<SpriteDisplayData *>(displayData)->skinData, display.skin, positionScale);
+                    break;
+                }
+                displayData->displayType = (DisplayType)display.displayType;
+
+                boneData->addDisplayData(displayData);
+                displayData->release();
+            }
+
+            armatureData->addBoneData(boneData);
+            boneData->release();
+        }
+
+        if (dataInfo->asyncStruct)
+        {
+            // added on the main thread
+            dataInfo->armatureDatas.push_back(armatureData);
+        }
+        else
+        {
+            ArmatureDataManager::getInstance()->addArmatureData(armatureData->name.c_str(), armatureData, configFilePath);
+            armatureData->release();
+        }
+    }
+
+    for (uint32_t i = 0; i < counts[BINARY_ANIMATIONS]; ++i)
+    {
+        const BinaryAnimation &animation = animations[i];
+
+        AnimationData *animationData = new AnimationData();
+        animationData->name = getString(animation.name);
+
+        for (uint32_t j = animation.firstMovement; j < animation.firstMovement + animation.movementCount; ++j)
+        {
+            const BinaryMovement &movement = movements[j];
+
+            MovementData *movementData = new MovementData();
+            movementData->name = getString(movement.name);
+            movementData->duration = movement.duration;
+            movementData->scale = movement.scale;
+            movementData->durationTo = movement.durationTo;
+            movementData->durationTween = movement.durationTween;
+            movementData->loop = movement.loop != 0;
+            movementData->tweenEasing = (TweenType)movement.tweenEasing;
+
+            for (uint32_t k = movement.firstMovementBone; k < movement.firstMovementBone + movement.movementBoneCount; ++k)
+            {
+                const BinaryMovementBone &movementBone = movementBones[k];
+
+                MovementBoneData *movBoneData = new MovementBoneData();
+                movBoneData->init();
+                movBoneData->name = getString(movementBone.name);
+                movBoneData->delay = movementBone.delay;
+                movBoneData->scale = movementBone.scale;
+                movBoneData->duration = movementBone.duration;
+
+                for (uint32_t l = movementBone.firstFrame; l < movementBone.firstFrame + movementBone.frameCount; ++l)
+                {
+                    const BinaryFrame &frame = frames[l];
+
+                    FrameData *frameData = new FrameData();
+                    readBinaryNode(*frameData, frame.node, positionScale);
+                    frameData->frameID = frame.frameID;
+                    frameData->duration = frame.duration;
+                    frameData->tweenEasing = (TweenType)frame.tweenEasing;
+                    frameData->isTween = frame.isTween != 0;
+                    frameData->displayIndex = frame.displayIndex;
+                    frameData->blendType = (BlendType)frame.blendType;
+                    frameData->strEvent = getString(frame.strEvent);
+                    frameData->strMovement = getString(frame.strMovement);
+                    frameData->strSound = getString(frame.strSound);
+                    frameData->strSoundEffect = getString(frame.strSoundEffect);
+
+                    movBoneData->addFrameData(frameData);
+                    frameData->release();
+                }
+
+                movementData->addMovementBoneData(movBoneData);
+                movBoneData->release();
+            }
+
+            animationData->addMovement(movementData);
+            movementData->release();
+        }
+
+        if (dataInfo->asyncStruct)
+        {
+            // added on the main thread
+            dataInfo->animationDatas.push_back(animationData);
+        }
+        else
+        {
+            ArmatureDataManager::getInstance()->addAnimationData(animationData->name.c_str(), animationData, configFilePath);
+            animationData->release();
+        }
+    }
+
+    for (uint32_t i = 0; i < counts[BINARY_TEXTURES]; ++i)
+    {
+        const BinaryTexture &texture = textures[i];
+
+        TextureData *textureData = new TextureData();
+        textureData->init();
+        textureData->name = getString(texture.name);
+        textureData->width = texture.width;
+        textureData->height = texture.height;
+        textureData->pivotX = texture.pivotX;
+        textureData->pivotY = texture.pivotY;
+
+        for (uint32_t j = texture.firstContour; j < texture.firstContour + texture.contourCount; ++j)
+        {
+            const BinaryContour &contour = contours[j];
+
+            ContourData *contourData = new ContourData();
+            contourData->init();
+
+            for (uint32_t k = contour.firstVertex; k < contour.firstVertex + contour.vertexCount; ++k)
+            {
+                ContourVertex2 *vertex = new ContourVertex2(vertices[k].x, vertices[k].y);
+                contourData->vertexList.addObject(vertex);
+                vertex->release();
+            }
+
+            textureData->contourDataList.addObject(contourData);
+            contourData->release();
+        }
+
+        if (dataInfo->asyncStruct)
+        {
+            // added on the main thread
+            dataInfo->textureDatas.push_back(textureData);
+        }
+        else
+        {
+            ArmatureDataManager::getInstance()->addTextureData(textureData->name.c_str(), textureData, configFilePath);
+            textureData->release();
+        }
+    }
+
+    return true;
+}
+
 }
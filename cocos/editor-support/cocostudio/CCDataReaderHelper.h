@@ -35,6 +35,8 @@ THE SOFTWARE.
 #include <list>
 #include <mutex>
 #include <thread>
+#include <condition_variable>
+#include <vector>
 
 namespace tinyxml2
 {
@@ -51,18 +53,22 @@ protected:
 	enum ConfigType
 	{
 		DragonBone_XML,
-		CocoStudio_JSON
+		CocoStudio_JSON,
+		CocoStudio_Binary
 	};
 
 	typedef struct _AsyncStruct
 	{
 		std::string    filename;
-		std::string    fileContent;
+		cocos2d::FileView *fileView;
 		ConfigType     configType;
+		std::string    fullPath;            //! the full path of the config file
+		ConfigType     fileConfigType;      //! the type of the config file, loaded in place of a rejected binary file
 		std::string    baseFilePath;
 		cocos2d::Object       *target;
 		cocos2d::SEL_SCHEDULE   selector;
 		bool           autoLoadSpriteFile;
+		bool           preloadTextures;     //! decode the textures of the sprite files while the datas are decoded
 
         std::string    imagePath;
         std::string    plistPath;
@@ -77,6 +83,11 @@ protected:
         std::string    baseFilePath;
         float flashToolVersion;
         float cocoStudioVersion;
+
+        // decoded by the loading threads, and added to ArmatureDataManager on the main thread
+        std::vector<ArmatureData *> armatureDatas;
+        std::vector<AnimationData *> animationDatas;
+        std::vector<TextureData *> textureDatas;
 	} DataInfo;
 
 public:
@@ -108,7 +119,9 @@ public:
     void addDataFromFile(const char *filePath);
     void addDataFromFileAsync(const char *imagePath, const char *plistPath, const char *filePath, cocos2d::Object *target, cocos2d::SEL_SCHEDULE selector);
 
-    void addDataAsyncCallBack(float dt);
+    // called on the main thread, through Scheduler::performFunctionInCocosThread(), once a file is loaded.
+    // The datas are added by chunks, over several frames, and the file is done once its textures are loaded
+    void addDataAsyncCallBack(DataInfo *dataInfo);
 
     void removeConfigFile(const char *configFile);
 public:
@@ -168,22 +181,46 @@ public:
 
     static void decodeNode(BaseData *node, JsonDictionary &json, DataInfo *dataInfo);
 
+public:
+    /**
+     * Decode a xml or json config file, and save its datas to a binary file which is loaded without parsing.
+     * addDataFromFile() and addDataFromFileAsync() load "<config file>.bin" in place of the config file
+     * when it is found next to it, so the binary files are generated offline, and generated again when
+     * the config files change.
+     *
+     * @return false if the config file can't be read or the binary file can't be written
+     */
+    static bool saveBinaryFile(const char *filePath, const char *binaryFilePath);
+
+    /**
+     * Add the datas of a binary file saved by saveBinaryFile(), the content is read in place.
+     *
+     * @return false if the content is not a valid binary file, nothing is added then
+     */
+    static bool addDataFromBinaryCache(const unsigned char *fileContent, long size, DataInfo *dataInfo);
+
 protected:
-	void loadData();
+    // add the sprite files of a config file, or queue them for the main thread when the file is loaded asynchronously
+    static void addConfigFiles(const std::vector<std::string> &configFiles, DataInfo *dataInfo);
 
+    // the binary file saved next to a config file, if any
+    static cocos2d::FileView *openBinaryFile(const std::string &fullPath);
 
+    static bool writeBinaryFile(const char *binaryFilePath, DataInfo *dataInfo, bool isXML);
 
 
-	std::condition_variable		_sleepCondition;
+	void loadData();
 
-	std::thread     *_loadingThread;
+    // releases the datas which were not added to ArmatureDataManager, and deletes the data info
+    static void deleteDataInfo(DataInfo *dataInfo);
 
-	std::mutex      _sleepMutex;
 
-	std::mutex      _asyncStructQueueMutex;
-	std::mutex      _dataInfoMutex;
+	std::condition_variable		_sleepCondition;
 
-	std::mutex      _addDataMutex;
+	// the files are decoded in parallel
+	std::vector<std::thread *>     _loadingThreads;
+
+	std::mutex      _asyncStructQueueMutex;
 
     std::mutex      _getFileMutex;
 
@@ -194,7 +231,6 @@ protected:
 	bool need_quit;
 
 	std::queue<AsyncStruct *> *_asyncStructQueue;
-	std::queue<DataInfo *>   *_dataQueue;
 
     static std::vector<std::string> _configFileList;
 
@@ -222,21 +222,20 @@ const cocos2d::Size CCSGUIReader::getFileDesignSize(const char* fileName) const
 UIWidget* CCSGUIReader::widgetFromJsonFile(const char *fileName)
 {
     m_bOlderVersion = false;
-    const char *des = NULL;
     std::string jsonpath;
     JsonDictionary *jsonDict = NULL;
     jsonpath = FileUtils::getInstance()->fullPathForFilename(fileName);
     
-    long size = 0;
-    des = (char*)(FileUtils::getInstance()->getFileData(jsonpath.c_str(),"r" , &size));
-	if(NULL == des || strcmp(des, "") == 0)
+    FileView *fileView = FileUtils::getInstance()->openFileView(jsonpath);
+	if(NULL == fileView || fileView->getBytes()[0] == 0)
 	{
 		printf("read json file[%s] error!\n", fileName);
+		CC_SAFE_RELEASE(fileView);
 		return NULL;
 	}
-	std::string strDes(des);
     jsonDict = new JsonDictionary();
-    jsonDict->initWithDescription(strDes.c_str());
+    jsonDict->initWithDescription((const char *)fileView->getBytes());
+    fileView->release();
 
     const char* fileVersion = DICTOOL->getStringValue_json(jsonDict, "version");
     if (!fileVersion || getVersionInteger(fileVersion) < 250)
@@ -288,7 +287,6 @@ UIWidget* CCSGUIReader::widgetFromJsonFile(const char *fileName)
 	CC_SAFE_DELETE(widgetTree);
 	CC_SAFE_DELETE(actions);
 	CC_SAFE_DELETE(jsonDict);
-    CC_SAFE_DELETE_ARRAY(des);
     return widget;
 }
 
@@ -47,18 +47,18 @@ namespace cocostudio {
 
     cocos2d::Node* SceneReader::createNodeWithSceneFile(const char* pszFileName)
     {
-        long size = 0;
-        const char* pData = 0;
+        cocos2d::FileView *fileView = NULL;
 		cocos2d::Node *pNode = NULL;
         do {
 			  CC_BREAK_IF(pszFileName == NULL);
-              pData = (char*)(cocos2d::FileUtils::getInstance()->getFileData(pszFileName, "r", &size));
-              CC_BREAK_IF(pData == NULL || strcmp(pData, "") == 0);
+              fileView = cocos2d::FileUtils::getInstance()->openFileView(pszFileName);
+              CC_BREAK_IF(fileView == NULL || fileView->getBytes()[0] == 0);
               JsonDictionary *jsonDict = new JsonDictionary();
-              jsonDict->initWithDescription(pData);
+              jsonDict->initWithDescription((const char*)fileView->getBytes());
               pNode = createObject(jsonDict,NULL);
               CC_SAFE_DELETE(jsonDict);
         } while (0);
+        CC_SAFE_RELEASE(fileView);
         
         return pNode;
 	}
@@ -213,14 +213,15 @@ namespace cocostudio {
 					{
 						file_path = reDir.substr(0, pos+1);
 					}
-					long size = 0;
-					const char *des = (char*)(cocos2d::FileUtils::getInstance()->getFileData(pPath.c_str(),"r" , &size));
+					cocos2d::FileView *fileView = cocos2d::FileUtils::getInstance()->openFileView(pPath);
+					const char *des = fileView ? (const char*)fileView->getBytes() : "";
 					JsonDictionary *jsonDict = new JsonDictionary();
 					jsonDict->initWithDescription(des);
-					if(NULL == des || strcmp(des, "") == 0)
+					if(strcmp(des, "") == 0)
 					{
 						CCLOG("read json file[%s] error!\n", pPath.c_str());
 					}
+					CC_SAFE_RELEASE(fileView);
 
 					int childrenCount = DICTOOL->getArrayCount_json(jsonDict, "armature_data");
 					JsonDictionary* subData = DICTOOL->getDictionaryFromArray_json(jsonDict, "armature_data", 0);
@@ -261,7 +262,6 @@ namespace cocostudio {
 
 					CC_SAFE_DELETE(jsonDict);
 					CC_SAFE_DELETE(subData);
-					CC_SAFE_DELETE_ARRAY(des);
                 }
                 else if(comName != NULL && strcmp(comName, "CCComAudio") == 0)
                 {
@@ -283,13 +283,12 @@ namespace cocostudio {
 					if (nResType == 0)
 					{
 						pAttribute = ComAttribute::create();
-						long size = 0;
-						const char* pData = 0;
-						pData = (char*)(cocos2d::FileUtils::getInstance()->getFileData(pPath.c_str(), "r", &size));
-						if(pData != NULL && strcmp(pData, "") != 0)
+						cocos2d::FileView *fileView = cocos2d::FileUtils::getInstance()->openFileView(pPath);
+						if(fileView != NULL && fileView->getBytes()[0] != 0)
 						{
-							pAttribute->getDict()->initWithDescription(pData);
+							pAttribute->getDict()->initWithDescription((const char*)fileView->getBytes());
 						}
+						CC_SAFE_RELEASE(fileView);
 					}
 					else
 					{
@@ -26,22 +26,35 @@
 #include "HttpClient.h"
 #include <thread>
 #include <queue>
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <chrono>
 #include <errno.h>
 
 #include "curl/curl.h"
 
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32)
+#include <sys/select.h>
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
 #include "platform/CCFileUtils.h"
 
  using namespace cocos2d;
 
 namespace network {
 
+// guards s_requestQueue, s_need_quit and the limits below, s_SleepCondition waits on it
 static std::mutex       s_requestQueueMutex;
-static std::mutex       s_responseQueueMutex;
 
-static std::mutex		s_SleepMutex;
 static std::condition_variable		s_SleepCondition;
 
+// copies of the limits of HttpClient, so the network thread doesn't have to access the client
+static int s_maxConcurrentRequests = 8;
+static int s_maxRequestsPerHost = 6;
+
 static unsigned long    s_asyncRequestCount = 0;
 
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
@@ -51,11 +64,34 @@ typedef int int32_t;
 static bool s_need_quit = false;
 
 static Array* s_requestQueue = NULL;
-static Array* s_responseQueue = NULL;
 
 static HttpClient *s_pHttpClient = NULL; // pointer to singleton
 
-static char s_errorBuffer[CURL_ERROR_SIZE];
+// longest time the network thread waits for socket activity. send() wakes it up through s_wakeupPipe,
+// except on win32 where select() only takes sockets, and a new request waits for the timeout
+static const long MAX_SELECT_TIMEOUT_MS = 50;
+
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32)
+// non blocking pipe, its read end is in the fd set of the network thread while transfers are in flight.
+// Created before the network thread is started, and closed by it under s_requestQueueMutex
+static int s_wakeupPipe[2] = { -1, -1 };
+#endif
+
+// wakes the network thread up, whether it waits on s_SleepCondition or in select(). s_requestQueueMutex must be locked
+static void wakeUpNetworkThread()
+{
+    s_SleepCondition.notify_one();
+
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32)
+    if (s_wakeupPipe[1] >= 0)
+    {
+        // fails only if the pipe is full, a wakeup is then pending anyway
+        char byte = 0;
+        ssize_t written = write(s_wakeupPipe[1], &byte, 1);
+        (void)written;
+    }
+#endif
+}
 
 typedef size_t (*write_callback)(void *ptr, size_t size, size_t nmemb, void *stream);
 
@@ -87,154 +123,27 @@ static size_t writeHeaderData(void *ptr, size_t size, size_t nmemb, void *stream
     return sizes;
 }
 
+// Returns the "host[:port]" part of an url, used to limit the number of requests per host
+static std::string getHostFromUrl(const char* url)
+{
+    std::string host(url ? url : "");
 
-static int processGetTask(HttpRequest *request, write_callback callback, void *stream, long *errorCode, write_callback headerCallback, void *headerStream);
-static int processPostTask(HttpRequest *request, write_callback callback, void *stream, long *errorCode, write_callback headerCallback, void *headerStream);
-static int processPutTask(HttpRequest *request, write_callback callback, void *stream, long *errorCode, write_callback headerCallback, void *headerStream);
-static int processDeleteTask(HttpRequest *request, write_callback callback, void *stream, long *errorCode, write_callback headerCallback, void *headerStream);
-// int processDownloadTask(HttpRequest *task, write_callback callback, void *stream, int32_t *errorCode);
-
-
-// Worker thread
-static void networkThread(void)
-{    
-    HttpRequest *request = NULL;
-    
-    while (true) 
-    {
-        if (s_need_quit)
-        {
-            break;
-        }
-        
-        // step 1: send http request if the requestQueue isn't empty
-        request = NULL;
-        
-        s_requestQueueMutex.lock();
-        
-        //Get request task from queue
-        
-        if (0 != s_requestQueue->count())
-        {
-            request = dynamic_cast<HttpRequest*>(s_requestQueue->getObjectAtIndex(0));
-            s_requestQueue->removeObjectAtIndex(0);
-        }
-        
-        s_requestQueueMutex.unlock();
-        
-        if (NULL == request)
-        {
-            // Wait for http request tasks from main thread
-            std::unique_lock<std::mutex> lk(s_SleepMutex); 
-            s_SleepCondition.wait(lk);
-            continue;
-        }
-        
-        // step 2: libcurl sync access
-        
-        // Create a HttpResponse object, the default setting is http access failed
-        HttpResponse *response = new HttpResponse(request);
-        
-        // request's refcount = 2 here, it's retained by HttpRespose constructor
-        request->release();
-        // ok, refcount = 1 now, only HttpResponse hold it.
-        
-        long responseCode = -1;
-        int retValue = 0;
-
-        // Process the request -> get response packet
-        switch (request->getRequestType())
-        {
-            case HttpRequest::Type::GET: // HTTP GET
-                retValue = processGetTask(request,
-                                          writeData, 
-                                          response->getResponseData(), 
-                                          &responseCode,
-                                          writeHeaderData,
-                                          response->getResponseHeader());
-                break;
-            
-            case HttpRequest::Type::POST: // HTTP POST
-                retValue = processPostTask(request,
-                                           writeData, 
-                                           response->getResponseData(), 
-                                           &responseCode,
-                                           writeHeaderData,
-                                           response->getResponseHeader());
-                break;
-
-            case HttpRequest::Type::PUT:
-                retValue = processPutTask(request,
-                                          writeData,
-                                          response->getResponseData(),
-                                          &responseCode,
-                                          writeHeaderData,
-                                          response->getResponseHeader());
-                break;
-
-            case HttpRequest::Type::DELETE:
-                retValue = processDeleteTask(request,
-                                             writeData,
-                                             response->getResponseData(),
-                                             &responseCode,
-                                             writeHeaderData,
-                                             response->getResponseHeader());
-                break;
-            
-            default:
-                CCASSERT(true, "CCHttpClient: unkown request type, only GET and POSt are supported");
-                break;
-        }
-                
-        // write data to HttpResponse
-        response->setResponseCode(responseCode);
-        
-        if (retValue != 0) 
-        {
-            response->setSucceed(false);
-            response->setErrorBuffer(s_errorBuffer);
-        }
-        else
-        {
-            response->setSucceed(true);
-        }
+    size_t start = host.find("://");
+    start = (start == std::string::npos) ? 0 : start + 3;
 
-        
-        // add response packet into queue
-        s_responseQueueMutex.lock();
-        s_responseQueue->addObject(response);
-        s_responseQueueMutex.unlock();
-        
-        // resume dispatcher selector
-        Director::getInstance()->getScheduler()->resumeTarget(HttpClient::getInstance());
-    }
-    
-    // cleanup: if worker thread received quit signal, clean up un-completed request queue
-    s_requestQueueMutex.lock();
-    s_requestQueue->removeAllObjects();
-    s_requestQueueMutex.unlock();
-    
-    s_asyncRequestCount -= s_requestQueue->count();
-    
-    if (s_requestQueue != NULL) {
-
-        s_requestQueue->release();
-        s_requestQueue = NULL;
-        s_responseQueue->release();
-        s_responseQueue = NULL;
-    }
-    
+    size_t end = host.find_first_of("/?#", start);
+    return host.substr(start, end == std::string::npos ? std::string::npos : end - start);
 }
 
 //Configure curl's timeout property
-static bool configureCURL(CURL *handle)
+static bool configureCURL(CURL *handle, char *errorBuffer)
 {
     if (!handle) {
         return false;
     }
     
     int32_t code;
-    code = curl_easy_setopt(handle, CURLOPT_ERRORBUFFER, s_errorBuffer);
+    code = curl_easy_setopt(handle, CURLOPT_ERRORBUFFER, errorBuffer);
     if (code != CURLE_OK) {
         return false;
     }
@@ -248,21 +157,38 @@ static bool configureCURL(CURL *handle)
     }
     curl_easy_setopt(handle, CURLOPT_SSL_VERIFYPEER, 0L);
     curl_easy_setopt(handle, CURLOPT_SSL_VERIFYHOST, 0L);
+    // the transfers run on the network thread: signals can't be used for the timeouts
+    curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
 
     return true;
 }
 
+/**
+ * A request being processed by the multi handle of the network thread.
+ * It owns the easy handle and the response the data is written into.
+ */
 class CURLRaii
 {
     /// Instance of CURL
     CURL *_curl;
     /// Keeps custom header data
     curl_slist *_headers;
+    /// Response of the request, which retains the request
+    HttpResponse *_response;
+    /// Host of the request, used to limit the number of requests per host
+    std::string _host;
+    /// Error message of the transfer
+    char _errorBuffer[CURL_ERROR_SIZE];
 public:
-    CURLRaii()
+    CURLRaii(HttpResponse *response)
         : _curl(curl_easy_init())
         , _headers(NULL)
+        , _response(response)
+        , _host(getHostFromUrl(response->getHttpRequest()->getUrl()))
     {
+        _errorBuffer[0] = '\0';
+        if (_curl)
+            curl_easy_setopt(_curl, CURLOPT_PRIVATE, this);
     }
 
     ~CURLRaii()
@@ -272,8 +198,14 @@ public:
         /* free the linked list for header data */
         if (_headers)
             curl_slist_free_all(_headers);
+        CC_SAFE_RELEASE(_response);
     }
 
+    inline CURL* getHandle() const { return _curl; }
+    inline HttpResponse* getResponse() const { return _response; }
+    inline const std::string& getHost() const { return _host; }
+    inline const char* getErrorBuffer() const { return _errorBuffer; }
+
     template <class T>
     bool setOption(CURLoption option, T data)
     {
@@ -290,7 +222,7 @@ public:
     {
         if (!_curl)
             return false;
-        if (!configureCURL(_curl))
+        if (!configureCURL(_curl, _errorBuffer))
             return false;
 
         /* get custom header data (if set) */
@@ -321,65 +253,310 @@ public:
         
     }
 
-    /// @param responseCode Null not allowed
-    bool perform(long *responseCode)
+    /// Writes the result of the finished transfer into the response
+    void finish(CURLcode result)
     {
-        if (CURLE_OK != curl_easy_perform(_curl))
-            return false;
-        CURLcode code = curl_easy_getinfo(_curl, CURLINFO_RESPONSE_CODE, responseCode);
-        if (code != CURLE_OK || *responseCode != 200) {
-            CCLOGERROR("Curl curl_easy_getinfo failed: %s", curl_easy_strerror(code));
-            return false;
+        long responseCode = -1;
+        bool succeed = false;
+
+        if (result == CURLE_OK)
+        {
+            CURLcode code = curl_easy_getinfo(_curl, CURLINFO_RESPONSE_CODE, &responseCode);
+            succeed = (code == CURLE_OK && responseCode == 200);
+            if (! succeed) {
+                CCLOGERROR("Curl curl_easy_getinfo failed: %s", curl_easy_strerror(code));
+            }
+        }
+        else if (_errorBuffer[0] == '\0')
+        {
+            strncpy(_errorBuffer, curl_easy_strerror(result), CURL_ERROR_SIZE - 1);
+            _errorBuffer[CURL_ERROR_SIZE - 1] = '\0';
+        }
+
+        _response->setResponseCode(responseCode);
+        _response->setSucceed(succeed);
+        if (! succeed)
+        {
+            _response->setErrorBuffer(_errorBuffer);
         }
-        // Get some mor data.
-        
-        return true;
     }
 };
 
-//Process Get Request
-static int processGetTask(HttpRequest *request, write_callback callback, void *stream, long *responseCode, write_callback headerCallback, void *headerStream)
+//Setup Get Request
+static bool setupGetTask(CURLRaii *curl, HttpRequest *request)
 {
-    CURLRaii curl;
-    bool ok = curl.init(request, callback, stream, headerCallback, headerStream)
-            && curl.setOption(CURLOPT_FOLLOWLOCATION, true)
-            && curl.perform(responseCode);
-    return ok ? 0 : 1;
+    return curl->setOption(CURLOPT_FOLLOWLOCATION, true);
 }
 
-//Process POST Request
-static int processPostTask(HttpRequest *request, write_callback callback, void *stream, long *responseCode, write_callback headerCallback, void *headerStream)
+//Setup POST Request
+static bool setupPostTask(CURLRaii *curl, HttpRequest *request)
 {
-    CURLRaii curl;
-    bool ok = curl.init(request, callback, stream, headerCallback, headerStream)
-            && curl.setOption(CURLOPT_POST, 1)
-            && curl.setOption(CURLOPT_POSTFIELDS, request->getRequestData())
-            && curl.setOption(CURLOPT_POSTFIELDSIZE, request->getRequestDataSize())
-            && curl.perform(responseCode);
-    return ok ? 0 : 1;
+    return curl->setOption(CURLOPT_POST, 1)
+            && curl->setOption(CURLOPT_POSTFIELDS, request->getRequestData())
+            && curl->setOption(CURLOPT_POSTFIELDSIZE, request->getRequestDataSize());
 }
 
-//Process PUT Request
-static int processPutTask(HttpRequest *request, write_callback callback, void *stream, long *responseCode, write_callback headerCallback, void *headerStream)
+//Setup PUT Request
+static bool setupPutTask(CURLRaii *curl, HttpRequest *request)
 {
-    CURLRaii curl;
-    bool ok = curl.init(request, callback, stream, headerCallback, headerStream)
-            && curl.setOption(CURLOPT_CUSTOMREQUEST, "PUT")
-            && curl.setOption(CURLOPT_POSTFIELDS, request->getRequestData())
-            && curl.setOption(CURLOPT_POSTFIELDSIZE, request->getRequestDataSize())
-            && curl.perform(responseCode);
-    return ok ? 0 : 1;
+    return curl->setOption(CURLOPT_CUSTOMREQUEST, "PUT")
+            && curl->setOption(CURLOPT_POSTFIELDS, request->getRequestData())
+            && curl->setOption(CURLOPT_POSTFIELDSIZE, request->getRequestDataSize());
 }
 
-//Process DELETE Request
-static int processDeleteTask(HttpRequest *request, write_callback callback, void *stream, long *responseCode, write_callback headerCallback, void *headerStream)
+//Setup DELETE Request
+static bool setupDeleteTask(CURLRaii *curl, HttpRequest *request)
 {
-    CURLRaii curl;
-    bool ok = curl.init(request, callback, stream, headerCallback, headerStream)
-            && curl.setOption(CURLOPT_CUSTOMREQUEST, "DELETE")
-            && curl.setOption(CURLOPT_FOLLOWLOCATION, true)
-            && curl.perform(responseCode);
-    return ok ? 0 : 1;
+    return curl->setOption(CURLOPT_CUSTOMREQUEST, "DELETE")
+            && curl->setOption(CURLOPT_FOLLOWLOCATION, true);
+}
+
+// Hands a response over to the main thread, which notifies the target of the request
+static void addResponse(HttpResponse *response)
+{
+    response->retain();
+
+    Director::getInstance()->getScheduler()->performFunctionInCocosThread([response] {
+        --s_asyncRequestCount;
+
+        HttpRequest *request = response->getHttpRequest();
+        Object *pTarget = request->getTarget();
+        SEL_HttpResponse pSelector = request->getSelector();
+
+        // the client may have been destroyed while the response was waiting
+        if (s_pHttpClient && pTarget && pSelector)
+        {
+            (pTarget->*pSelector)(s_pHttpClient, response);
+        }
+
+        response->release();
+    });
+}
+
+// Creates the transfer of a request and adds it to the multi handle. Returns NULL on failure, the response is then queued right away
+static CURLRaii* startTransfer(CURLM *multi, HttpRequest *request)
+{
+    // Create a HttpResponse object, the default setting is http access failed
+    HttpResponse *response = new HttpResponse(request);
+
+    // request's refcount = 2 here, it's retained by HttpRespose constructor
+    request->release();
+    // ok, refcount = 1 now, only HttpResponse hold it.
+
+    // the transfer owns the response now
+    CURLRaii *curl = new CURLRaii(response);
+
+    bool ok = curl->init(request, writeData, response->getResponseData(), writeHeaderData, response->getResponseHeader());
+    if (ok)
+    {
+        switch (request->getRequestType())
+        {
+            case HttpRequest::Type::GET: // HTTP GET
+                ok = setupGetTask(curl, request);
+                break;
+
+            case HttpRequest::Type::POST: // HTTP POST
+                ok = setupPostTask(curl, request);
+                break;
+
+            case HttpRequest::Type::PUT:
+                ok = setupPutTask(curl, request);
+                break;
+
+            case HttpRequest::Type::DELETE:
+                ok = setupDeleteTask(curl, request);
+                break;
+
+            default:
+                CCASSERT(true, "CCHttpClient: unkown request type, only GET and POSt are supported");
+                ok = false;
+                break;
+        }
+    }
+
+    if (ok)
+    {
+        ok = (CURLM_OK == curl_multi_add_handle(multi, curl->getHandle()));
+    }
+
+    if (! ok)
+    {
+        curl->finish(CURLE_FAILED_INIT);
+        addResponse(response);
+        delete curl;
+        return NULL;
+    }
+
+    return curl;
+}
+
+// Worker thread
+static void networkThread(void)
+{
+    // The easy handles added to the same multi handle share its connection cache and its DNS cache,
+    // so the connections are kept alive and reused by the following requests to the same hosts.
+    CURLM *multi = curl_multi_init();
+
+    // transfers in flight, and how many of them target each host
+    std::vector<CURLRaii*> transfers;
+    std::map<std::string, int> hostTransfers;
+
+    while (true) 
+    {
+        // step 1: start as many queued requests as the limits allow, in the order they were sent
+        std::unique_lock<std::mutex> lk(s_requestQueueMutex);
+
+        if (s_need_quit)
+        {
+            break;
+        }
+
+        for (int i = 0; i < s_requestQueue->count() && (int)transfers.size() < s_maxConcurrentRequests; )
+        {
+            HttpRequest *request = static_cast<HttpRequest*>(s_requestQueue->getObjectAtIndex(i));
+            std::string host = getHostFromUrl(request->getUrl());
+
+            if (hostTransfers[host] >= s_maxRequestsPerHost)
+            {
+                // wait for a transfer to this host to finish, the requests to other hosts can start
+                ++i;
+                continue;
+            }
+
+            // the request is still retained by send()
+            s_requestQueue->removeObjectAtIndex(i);
+
+            CURLRaii *curl = startTransfer(multi, request);
+            if (curl)
+            {
+                transfers.push_back(curl);
+                ++hostTransfers[curl->getHost()];
+            }
+        }
+        
+        if (transfers.empty())
+        {
+            // Wait for http request tasks from main thread. With nothing in flight, any queued request
+            // could have been started above, so the predicate only needs to check the queue.
+            s_SleepCondition.wait(lk, [] { return s_need_quit || s_requestQueue->count() > 0; });
+            continue;
+        }
+
+        lk.unlock();
+        
+        // step 2: let libcurl send and receive what it can without blocking
+        int running = 0;
+        while (CURLM_CALL_MULTI_PERFORM == curl_multi_perform(multi, &running));
+
+        // step 3: hand the finished transfers over to the main thread
+        CURLMsg *msg = NULL;
+        int msgsInQueue = 0;
+        while ((msg = curl_multi_info_read(multi, &msgsInQueue)))
+        {
+            if (msg->msg != CURLMSG_DONE)
+            {
+                continue;
+            }
+
+            CURLRaii *curl = NULL;
+            curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char**)&curl);
+            CURLcode result = msg->data.result;
+
+            curl_multi_remove_handle(multi, msg->easy_handle);
+
+            curl->finish(result);
+            addResponse(curl->getResponse());
+
+            if (--hostTransfers[curl->getHost()] == 0)
+            {
+                hostTransfers.erase(curl->getHost());
+            }
+            transfers.erase(std::find(transfers.begin(), transfers.end(), curl));
+            delete curl;
+        }
+
+        // step 4: wait for socket activity on the transfers still in flight
+        if (running > 0)
+        {
+            long timeout = -1;
+            curl_multi_timeout(multi, &timeout);
+            if (timeout < 0 || timeout > MAX_SELECT_TIMEOUT_MS)
+            {
+                timeout = MAX_SELECT_TIMEOUT_MS;
+            }
+
+            fd_set readSet, writeSet, exceptSet;
+            FD_ZERO(&readSet);
+            FD_ZERO(&writeSet);
+            FD_ZERO(&exceptSet);
+            int maxFd = -1;
+            curl_multi_fdset(multi, &readSet, &writeSet, &exceptSet, &maxFd);
+
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32)
+            // a request sent in the meantime ends the wait
+            int wakeupFd = s_wakeupPipe[0];
+            if (wakeupFd >= 0)
+            {
+                FD_SET(wakeupFd, &readSet);
+                maxFd = std::max(maxFd, wakeupFd);
+            }
+#endif
+
+            if (maxFd >= 0)
+            {
+                struct timeval tv;
+                tv.tv_sec = timeout / 1000;
+                tv.tv_usec = (timeout % 1000) * 1000;
+                int ready = select(maxFd + 1, &readSet, &writeSet, &exceptSet, &tv);
+
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32)
+                if (ready > 0 && wakeupFd >= 0 && FD_ISSET(wakeupFd, &readSet))
+                {
+                    char buffer[64];
+                    while (read(wakeupFd, buffer, sizeof(buffer)) > 0);
+                }
+#endif
+                (void)ready;
+            }
+            else if (timeout > 0)
+            {
+                // libcurl has no socket to wait for yet (name resolving...)
+                std::this_thread::sleep_for(std::chrono::milliseconds(timeout));
+            }
+        }
+    }
+    
+    // cleanup: if worker thread received quit signal, clean up the transfers in flight and un-completed request queue
+    for (std::vector<CURLRaii*>::iterator it = transfers.begin(); it != transfers.end(); ++it)
+    {
+        curl_multi_remove_handle(multi, (*it)->getHandle());
+        delete *it;
+    }
+    s_asyncRequestCount -= transfers.size();
+    transfers.clear();
+    curl_multi_cleanup(multi);
+
+    s_requestQueueMutex.lock();
+    s_asyncRequestCount -= s_requestQueue->count();
+    s_requestQueue->removeAllObjects();
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32)
+    for (int i = 0; i < 2; ++i)
+    {
+        if (s_wakeupPipe[i] >= 0)
+        {
+            close(s_wakeupPipe[i]);
+            s_wakeupPipe[i] = -1;
+        }
+    }
+#endif
+    s_requestQueueMutex.unlock();
+    
+    if (s_requestQueue != NULL) {
+
+        s_requestQueue->release();
+        s_requestQueue = NULL;
+    }
+    
 }
 
 // HttpClient implementation
@@ -395,7 +572,6 @@ HttpClient* HttpClient::getInstance()
 void HttpClient::destroyInstance()
 {
     CCASSERT(s_pHttpClient, "");
-    Director::getInstance()->getScheduler()->unscheduleSelector(schedule_selector(HttpClient::dispatchResponseCallbacks), s_pHttpClient);
     s_pHttpClient->release();
 }
 
@@ -411,23 +587,39 @@ void HttpClient::enableCookies(const char* cookieFile) {
 HttpClient::HttpClient()
 : _timeoutForConnect(30)
 , _timeoutForRead(60)
+, _maxConcurrentRequests(8)
+, _maxRequestsPerHost(6)
 {
-    Director::getInstance()->getScheduler()->scheduleSelector(
-                    schedule_selector(HttpClient::dispatchResponseCallbacks), this, 0, false);
-    Director::getInstance()->getScheduler()->pauseTarget(this);
 }
 
 HttpClient::~HttpClient()
 {
+    s_requestQueueMutex.lock();
     s_need_quit = true;
-    
     if (s_requestQueue != NULL) {
-    	s_SleepCondition.notify_one();
+        wakeUpNetworkThread();
     }
+    s_requestQueueMutex.unlock();
     
     s_pHttpClient = NULL;
 }
 
+void HttpClient::setMaxConcurrentRequests(int value)
+{
+    _maxConcurrentRequests = std::max(value, 1);
+
+    std::lock_guard<std::mutex> lk(s_requestQueueMutex);
+    s_maxConcurrentRequests = _maxConcurrentRequests;
+}
+
+void HttpClient::setMaxRequestsPerHost(int value)
+{
+    _maxRequestsPerHost = std::max(value, 1);
+
+    std::lock_guard<std::mutex> lk(s_requestQueueMutex);
+    s_maxRequestsPerHost = _maxRequestsPerHost;
+}
+
 //Lazy create semaphore & mutex & thread
 bool HttpClient::lazyInitThreadSemphore()
 {
@@ -438,14 +630,23 @@ bool HttpClient::lazyInitThreadSemphore()
         s_requestQueue = new Array();
         s_requestQueue->init();
         
-        s_responseQueue = new Array();
-        s_responseQueue->init();
-
+        s_need_quit = false;
+        
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32)
+        // without the pipe, a request sent while transfers are in flight waits for the select() timeout
+        if (pipe(s_wakeupPipe) == 0)
+        {
+            fcntl(s_wakeupPipe[0], F_SETFL, fcntl(s_wakeupPipe[0], F_GETFL) | O_NONBLOCK);
+            fcntl(s_wakeupPipe[1], F_SETFL, fcntl(s_wakeupPipe[1], F_GETFL) | O_NONBLOCK);
+        }
+        else
+        {
+            s_wakeupPipe[0] = s_wakeupPipe[1] = -1;
+        }
+#endif
         
         auto t = std::thread(&networkThread);
         t.detach();
-        
-        s_need_quit = false;
     }
     
     return true;
@@ -470,50 +671,10 @@ void HttpClient::send(HttpRequest* request)
     
     s_requestQueueMutex.lock();
     s_requestQueue->addObject(request);
-    s_requestQueueMutex.unlock();
     
     // Notify thread start to work
-    s_SleepCondition.notify_one();
-}
-
-// Poll and notify main thread if responses exists in queue
-void HttpClient::dispatchResponseCallbacks(float delta)
-{
-    // log("CCHttpClient::dispatchResponseCallbacks is running");
-    
-    HttpResponse* response = NULL;
-    
-    s_responseQueueMutex.lock();
-
-    if (s_responseQueue->count())
-    {
-        response = dynamic_cast<HttpResponse*>(s_responseQueue->getObjectAtIndex(0));
-        s_responseQueue->removeObjectAtIndex(0);
-    }
-    
-    s_responseQueueMutex.unlock();
-    
-    if (response)
-    {
-        --s_asyncRequestCount;
-        
-        HttpRequest *request = response->getHttpRequest();
-        Object *pTarget = request->getTarget();
-        SEL_HttpResponse pSelector = request->getSelector();
-
-        if (pTarget && pSelector) 
-        {
-            (pTarget->*pSelector)(this, response);
-        }
-        
-        response->release();
-    }
-    
-    if (0 == s_asyncRequestCount) 
-    {
-        Director::getInstance()->getScheduler()->pauseTarget(this);
-    }
-    
+    wakeUpNetworkThread();
+    s_requestQueueMutex.unlock();
 }
 
 }
@@ -42,6 +42,7 @@ namespace network {
 
 /** @brief Singleton that handles asynchrounous http requests
  * Once the request completed, a callback will issued in main thread when it provided during make request
+ * Several requests are processed at the same time by a single network thread, see setMaxConcurrentRequests()
  */
 class HttpClient : public cocos2d::Object
 {
@@ -88,6 +89,32 @@ public:
      * @return int
      */
     inline int getTimeoutForRead() {return _timeoutForRead;};
+
+    /**
+     * Change the maximum number of requests processed at the same time
+     * The requests are sent in the order they were added. Connections to a host are kept alive
+     * and reused by the following requests to the same host.
+     * @param value The desired number of requests, 8 by default. Values lower than 1 are clamped to 1.
+     */
+    void setMaxConcurrentRequests(int value);
+
+    /**
+     * Get the maximum number of requests processed at the same time
+     * @return int
+     */
+    inline int getMaxConcurrentRequests() {return _maxConcurrentRequests;};
+
+    /**
+     * Change the maximum number of requests to the same host processed at the same time
+     * @param value The desired number of requests, 6 by default. Values lower than 1 are clamped to 1.
+     */
+    void setMaxRequestsPerHost(int value);
+
+    /**
+     * Get the maximum number of requests to the same host processed at the same time
+     * @return int
+     */
+    inline int getMaxRequestsPerHost() {return _maxRequestsPerHost;};
         
 private:
     HttpClient();
@@ -99,12 +126,12 @@ private:
      * @return bool
      */
     bool lazyInitThreadSemphore();
-    /** Poll function called from main thread to dispatch callbacks when http requests finished **/
-    void dispatchResponseCallbacks(float delta);
     
 private:
     int _timeoutForConnect;
     int _timeoutForRead;
+    int _maxConcurrentRequests;
+    int _maxRequestsPerHost;
     
     // std::string reqId;
 };
@@ -68,6 +68,12 @@ extern const char* PHYSICSCONTACT_EVENT_NAME;
 
 const float PHYSICS_INFINITY = INFINITY;
 
+static int getContactEventID()
+{
+    static int eventID = EventCustom::getEventIDForName(PHYSICSCONTACT_EVENT_NAME);
+    return eventID;
+}
+
 namespace
 {
     typedef struct RayCastCallbackInfo
@@ -807,9 +813,7 @@ int PhysicsWorld::collisionBeginCallback(PhysicsContact& contact)
     
     contact.setEventCode(PhysicsContact::EventCode::BEGIN);
     contact.setWorld(this);
-    EventCustom event(PHYSICSCONTACT_EVENT_NAME);
-    event.setUserData(&contact);
-    _scene->getEventDispatcher()->dispatchEvent(&event);
+    _scene->getEventDispatcher()->dispatchCustomEvent(getContactEventID(), &contact);
     
     return ret ? contact.resetResult() : false;
 }
@@ -824,9 +828,7 @@ int PhysicsWorld::collisionPreSolveCallback(PhysicsContact& contact)
     
     contact.setEventCode(PhysicsContact::EventCode::PRESOLVE);
     contact.setWorld(this);
-    EventCustom event(PHYSICSCONTACT_EVENT_NAME);
-    event.setUserData(&contact);
-    _scene->getEventDispatcher()->dispatchEvent(&event);
+    _scene->getEventDispatcher()->dispatchCustomEvent(getContactEventID(), &contact);
     
     return contact.resetResult();
 }
@@ -840,9 +842,7 @@ void PhysicsWorld::collisionPostSolveCallback(PhysicsContact& contact)
     
     contact.setEventCode(PhysicsContact::EventCode::POSTSOLVE);
     contact.setWorld(this);
-    EventCustom event(PHYSICSCONTACT_EVENT_NAME);
-    event.setUserData(&contact);
-    _scene->getEventDispatcher()->dispatchEvent(&event);
+    _scene->getEventDispatcher()->dispatchCustomEvent(getContactEventID(), &contact);
 }
 
 void PhysicsWorld::collisionSeparateCallback(PhysicsContact& contact)
@@ -854,9 +854,7 @@ void PhysicsWorld::collisionSeparateCallback(PhysicsContact& contact)
     
     contact.setEventCode(PhysicsContact::EventCode::SEPERATE);
     contact.setWorld(this);
-    EventCustom event(PHYSICSCONTACT_EVENT_NAME);
-    event.setUserData(&contact);
-    _scene->getEventDispatcher()->dispatchEvent(&event);
+    _scene->getEventDispatcher()->dispatchCustomEvent(getContactEventID(), &contact);
 }
 
 void PhysicsWorld::setGravity(const Vect& gravity)
@@ -504,6 +504,9 @@ void ScrollView::beforeDraw()
 {
     if (_clippingToBounds)
     {
+        // the scissor test is changed right away, draw what was recorded before
+        Director::getInstance()->getRenderer()->render();
+
 		_scissorRestored = false;
         Rect frame = getViewRect();
         if (EGLView::getInstance()->isScissorEnabled()) {
@@ -533,6 +536,10 @@ void ScrollView::afterDraw()
 {
     if (_clippingToBounds)
     {
+        // draw the clipped children before restoring the scissor test
+        Director::getInstance()->getRenderer()->render();
+
+
         if (_scissorRestored) {//restore the parent's scissor rect
             EGLView::getInstance()->setScissorInPoints(_parentScissorRect.origin.x, _parentScissorRect.origin.y, _parentScissorRect.size.width, _parentScissorRect.size.height);
         }
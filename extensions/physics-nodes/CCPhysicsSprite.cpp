@@ -348,6 +348,11 @@ const AffineTransform& PhysicsSprite::getNodeToParentTransform() const
 	// the sprite is animated (scaled up/down) using actions.
 	// For more info see: http://www.cocos2d-iphone.org/forum/topic/68990
 
+    // the body may have moved: the model-view matrix has to be recomputed
+    _transformUpdated = true;
+
+    AffineTransform previousTransform = _transform;
+
 #if CC_ENABLE_CHIPMUNK_INTEGRATION
 
 	cpVect rot = (_ignoreBodyRotation ? cpvforangle(-CC_DEGREES_TO_RADIANS(_rotationX)) : _CPBody->rot);
@@ -360,9 +365,9 @@ const AffineTransform& PhysicsSprite::getNodeToParentTransform() const
 		y += _anchorPointInPoints.y;
 	}
 
-	return (_transform = AffineTransformMake(rot.x * _scaleX, rot.y * _scaleX,
-                                             -rot.y * _scaleY, rot.x * _scaleY,
-                                             x,	y));
+	_transform = AffineTransformMake(rot.x * _scaleX, rot.y * _scaleX,
+                                     -rot.y * _scaleY, rot.x * _scaleY,
+                                     x,	y);
 
 
 #elif CC_ENABLE_BOX2D_INTEGRATION
@@ -393,9 +398,15 @@ const AffineTransform& PhysicsSprite::getNodeToParentTransform() const
 	_transform = AffineTransformMake( c * _scaleX,	s * _scaleX,
                                      -s * _scaleY,	c * _scaleY,
                                      x,	y );
-
-	return _transform;
 #endif
+
+    // the caches of world space data, like the touch hit index, find out the body moved from the transform version
+    if (!AffineTransformEqualToTransform(previousTransform, _transform))
+    {
+        updateTransformVersion();
+    }
+
+    return _transform;
 }
 
 NS_CC_EXT_END
@@ -24,6 +24,9 @@ Layer *CreateLayer(int index)
     case TEST_DIRECT_LOADING:
         pLayer = new TestDirectLoading();
         break;
+    case TEST_BINARY_LOADING:
+        pLayer = new TestBinaryLoading();
+        break;
     case TEST_DRAGON_BONES_2_0:
         pLayer = new TestDragonBones20();
         break;
@@ -316,6 +319,43 @@ std::string TestDirectLoading::title()
 }
 
 
+void TestBinaryLoading::onEnter()
+{
+    // save the binary file next to a config file path in the writable path, the config file itself isn't there,
+    // so the datas can only be added from the binary file
+    std::string configFilePath = FileUtils::getInstance()->getWritablePath() + "bear.ExportJson";
+    std::string binaryFilePath = configFilePath + ".bin";
+
+    ArmatureDataManager::getInstance()->removeArmatureFileInfo("armature/bear.ExportJson");
+    ArmatureDataManager::getInstance()->removeArmatureFileInfo(configFilePath.c_str());
+
+    loaded = false;
+    if (DataReaderHelper::saveBinaryFile("armature/bear.ExportJson", binaryFilePath.c_str()))
+    {
+        ArmatureDataManager::getInstance()->addArmatureFileInfo("armature/bear0.png", "armature/bear0.plist", configFilePath.c_str());
+        loaded = ArmatureDataManager::getInstance()->getArmatureData("bear") != nullptr;
+    }
+
+    ArmatureTestLayer::onEnter();
+
+    if (loaded)
+    {
+        Armature *armature = Armature::create("bear");
+        armature->getAnimation()->playByIndex(0);
+        armature->setPosition(Point(VisibleRect::center().x, VisibleRect::center().y));
+        addChild(armature);
+    }
+}
+std::string TestBinaryLoading::title()
+{
+    return "Test Binary Loading";
+}
+std::string TestBinaryLoading::subtitle()
+{
+    return loaded ? "bear loaded from the binary file just saved" : "failed to save or load the binary file";
+}
+
+
 void TestCSWithSkeleton::onEnter()
 {
     ArmatureTestLayer::onEnter();
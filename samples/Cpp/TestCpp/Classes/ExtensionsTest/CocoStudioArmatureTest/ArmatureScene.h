@@ -28,6 +28,7 @@ public:
 enum {
 	TEST_ASYNCHRONOUS_LOADING = 0,
     TEST_DIRECT_LOADING,
+    TEST_BINARY_LOADING,
 	TEST_COCOSTUDIO_WITH_SKELETON,
 	TEST_DRAGON_BONES_2_0,
 	TEST_PERFORMANCE,
@@ -86,6 +87,16 @@ public:
     virtual std::string title();
 };
 
+class TestBinaryLoading : public ArmatureTestLayer
+{
+public:
+    virtual void onEnter();
+    virtual std::string title();
+    virtual std::string subtitle();
+
+    bool loaded;
+};
+
 class TestCSWithSkeleton : public ArmatureTestLayer
 {
 	virtual void onEnter();
@@ -20,7 +20,8 @@ std::function<Layer*()> createFunctions[] =
     CL(LabelKeyboardEventTest),
     CL(SpriteAccelerationEventTest),
     CL(RemoveAndRetainNodeTest),
-    CL(RemoveListenerAfterAddingTest)
+    CL(RemoveListenerAfterAddingTest),
+    CL(HitTestListenerTest)
 };
 
 unsigned int TEST_CASE_COUNT = sizeof(createFunctions) / sizeof(createFunctions[0]);
@@ -469,7 +470,60 @@ void CustomEventTest::onEnter()
     });
     sendItem2->setPosition(origin + Point(size.width/2, size.height/2 - 40));
     
-    auto menu = Menu::create(sendItem, sendItem2, nullptr);
+    auto statusLabel3 = LabelTTF::create("No custom event 3 received!", "", 20);
+    statusLabel3->setPosition(origin + Point(size.width/2, size.height-150));
+    addChild(statusLabel3);
+    
+    // Custom event 3 has a listener added by the ID of its name and another one added by its name
+    int eventID3 = EventCustom::getEventIDForName("game_custom_event3");
+    auto receivedCount3 = std::make_shared<int>(0);
+    
+    _listener3 = EventListenerCustom::create(eventID3, [=](EventCustom* event){
+        CCASSERT(event->getEventName() == "game_custom_event3", "The event name should be found from its ID");
+        ++*receivedCount3;
+    });
+    
+    _eventDispatcher->addEventListenerWithFixedPriority(_listener3, 1);
+    
+    _listener4 = EventListenerCustom::create("game_custom_event3", [=](EventCustom* event){
+        CCASSERT(event->getEventID() == eventID3, "The event ID should be the one of its name");
+        ++*receivedCount3;
+    });
+    
+    _eventDispatcher->addEventListenerWithFixedPriority(_listener4, 1);
+    
+    // Reused by every dispatch, it's only switched to custom event 3 before being dispatched
+    auto reusedEvent = std::make_shared<EventCustom>("game_custom_event1");
+    
+    auto sendItem3 = MenuItemFont::create("Send Custom Event 3 by ID and by name", [=](Object* sender){
+        // Every path should reach both listeners
+        int receivedCounts[3];
+        
+        *receivedCount3 = 0;
+        _eventDispatcher->dispatchCustomEvent(eventID3);
+        receivedCounts[0] = *receivedCount3;
+        
+        *receivedCount3 = 0;
+        reusedEvent->setEventID(eventID3);
+        _eventDispatcher->dispatchEvent(reusedEvent.get());
+        receivedCounts[1] = *receivedCount3;
+        
+        *receivedCount3 = 0;
+        EventCustom event("game_custom_event3");
+        _eventDispatcher->dispatchEvent(&event);
+        receivedCounts[2] = *receivedCount3;
+        
+        bool isSame = (receivedCounts[0] == 2 && receivedCounts[1] == 2 && receivedCounts[2] == 2);
+        if (!isSame)
+        {
+            log("Custom event 3 received by %d, %d and %d listeners", receivedCounts[0], receivedCounts[1], receivedCounts[2]);
+        }
+        statusLabel3->setString(isSame ? "Custom event 3 received by both listeners from the ID and the name"
+                                       : "Custom event 3 missed a listener!");
+    });
+    sendItem3->setPosition(origin + Point(size.width/2, size.height/2 - 80));
+    
+    auto menu = Menu::create(sendItem, sendItem2, sendItem3, nullptr);
     menu->setPosition(Point(0, 0));
     menu->setAnchorPoint(Point(0, 0));
     addChild(menu, -1);
@@ -479,6 +533,8 @@ void CustomEventTest::onExit()
 {
     _eventDispatcher->removeEventListener(_listener);
     _eventDispatcher->removeEventListener(_listener2);
+    _eventDispatcher->removeEventListener(_listener3);
+    _eventDispatcher->removeEventListener(_listener4);
     EventDispatcherTestDemo::onExit();
 }
 
@@ -751,3 +807,104 @@ std::string RemoveListenerAfterAddingTest::subtitle()
 }
 
 
+
+// HitTestListenerTest
+void HitTestListenerTest::onEnter()
+{
+    EventDispatcherTestDemo::onEnter();
+    
+    Point origin = Director::getInstance()->getVisibleOrigin();
+    Size size = Director::getInstance()->getVisibleSize();
+    
+    auto statusLabel = LabelTTF::create("No block touched", "", 20);
+    statusLabel->setPosition(origin + Point(size.width/2, 60));
+    addChild(statusLabel, 100);
+    
+    auto sprite1 = Sprite::create("Images/CyanSquare.png");
+    sprite1->setPosition(origin+Point(size.width/2, size.height/2) + Point(-60, 40));
+    sprite1->setRotation(30);
+    sprite1->setTag(1);
+    addChild(sprite1, 10);
+    
+    // The bounding boxes of the blocks overlap, the one on top swallows the touch
+    auto sprite2 = Sprite::create("Images/MagentaSquare.png");
+    sprite2->setPosition(origin+Point(size.width/2, size.height/2));
+    sprite2->runAction(RepeatForever::create(RotateBy::create(4, 360)));
+    sprite2->setTag(2);
+    addChild(sprite2, 20);
+    
+    // Moved by the rotation of its parent only
+    auto sprite3 = Sprite::create("Images/YellowSquare.png");
+    sprite3->setPosition(Point(sprite2->getContentSize().width, sprite2->getContentSize().height));
+    sprite3->setTag(3);
+    sprite2->addChild(sprite3, 1);
+    
+    auto addHitTestListener = [=](Sprite* sprite){
+        auto listener = EventListenerTouchOneByOne::create();
+        listener->setSwallowTouches(true);
+        listener->setHitTestEnabled(true);
+        
+        // The IDs of the touches claimed by this listener
+        auto claimedTouches = std::make_shared<std::set<int>>();
+        
+        listener->onTouchBegan = [=](Touch* touch, Event* event){
+            auto target = static_cast<Sprite*>(event->getCurrentTarget());
+            
+            // The dispatcher only tests the bounding box, which is larger than the rotated block
+            Point locationInNode = target->convertToNodeSpace(touch->getLocation());
+            Size s = target->getContentSize();
+            
+            if (Rect(0, 0, s.width, s.height).containsPoint(locationInNode))
+            {
+                statusLabel->setString(String::createWithFormat("Block %d touched", target->getTag())->getCString());
+                target->setOpacity(180);
+                claimedTouches->insert(touch->getID());
+                return true;
+            }
+            return false;
+        };
+        
+        listener->onTouchMoved = [=](Touch* touch, Event* event){
+            CCASSERT(claimedTouches->count(touch->getID()) > 0, "Only the listeners which claimed the touch should receive it");
+            auto target = static_cast<Sprite*>(event->getCurrentTarget());
+            target->setPosition(target->getPosition() + touch->getDelta());
+        };
+        
+        listener->onTouchEnded = [=](Touch* touch, Event* event){
+            size_t erased = claimedTouches->erase(touch->getID());
+            CCASSERT(erased > 0, "Only the listeners which claimed the touch should receive it");
+            auto target = static_cast<Sprite*>(event->getCurrentTarget());
+            target->setOpacity(255);
+        };
+        
+        listener->onTouchCancelled = listener->onTouchEnded;
+        
+        _eventDispatcher->addEventListenerWithSceneGraphPriority(listener, sprite);
+    };
+    
+    addHitTestListener(sprite1);
+    addHitTestListener(sprite2);
+    addHitTestListener(sprite3);
+    
+    // Without hit test, receives the touches which weren't swallowed by a block
+    auto layerListener = EventListenerTouchOneByOne::create();
+    layerListener->onTouchBegan = [=](Touch* touch, Event* event){
+        statusLabel->setString("No block touched");
+        return false;
+    };
+    layerListener->onTouchMoved = [](Touch* touch, Event* event){
+        CCASSERT(false, "The touch wasn't claimed, it shouldn't be moved here!");
+    };
+    
+    _eventDispatcher->addEventListenerWithSceneGraphPriority(layerListener, this);
+}
+
+std::string HitTestListenerTest::title()
+{
+    return "Hit Test Listener Test";
+}
+
+std::string HitTestListenerTest::subtitle()
+{
+    return "Drag the blocks, only the top one under the touch should move";
+}
@@ -65,6 +65,8 @@ public:
 private:
     EventListenerCustom* _listener;
     EventListenerCustom* _listener2;
+    EventListenerCustom* _listener3;
+    EventListenerCustom* _listener4;
 };
 
 class LabelKeyboardEventTest : public EventDispatcherTestDemo
@@ -105,4 +107,12 @@ public:
     virtual std::string subtitle() override;
 };
 
+class HitTestListenerTest : public EventDispatcherTestDemo
+{
+public:
+    virtual void onEnter() override;
+    virtual std::string title() override;
+    virtual std::string subtitle() override;
+};
+
 #endif /* defined(__samples__NewEventDispatcherTest__) */
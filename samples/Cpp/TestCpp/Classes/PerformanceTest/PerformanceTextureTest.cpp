@@ -127,6 +127,71 @@ void TextureTest::performTestsPNG(const char* filename)
     cache->removeTexture(texture);
 }
 
+void TextureTest::performTestsConversion(int width, int height)
+{
+    static const struct
+    {
+        const char* name;
+        Texture2D::PixelFormat from;
+        Texture2D::PixelFormat to;
+        int bytesPerPixel;
+    } conversions[] =
+    {
+        { "RGBA 8888 -> RGBA 4444", Texture2D::PixelFormat::RGBA8888, Texture2D::PixelFormat::RGBA4444, 4 },
+        { "RGBA 8888 -> RGB 565", Texture2D::PixelFormat::RGBA8888, Texture2D::PixelFormat::RGB565, 4 },
+        { "RGBA 8888 -> RGBA 5551", Texture2D::PixelFormat::RGBA8888, Texture2D::PixelFormat::RGB5A1, 4 },
+        { "RGB 888 -> RGBA 8888", Texture2D::PixelFormat::RGB888, Texture2D::PixelFormat::RGBA8888, 3 },
+    };
+
+    std::vector<unsigned char> data(width * height * 4);
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        data[i] = (unsigned char)(i * 7 + (i >> 8));
+    }
+
+    bool vectorized = Texture2D::isVectorizedConversionEnabled();
+    if (!vectorized)
+    {
+        log("  SSE2/NEON conversions not available, only timing the scalar ones");
+    }
+
+    for (const auto& conversion : conversions)
+    {
+        log("%s", conversion.name);
+        long dataLen = width * height * conversion.bytesPerPixel;
+
+        // the scalar output, then the simd one
+        unsigned char* outData[2] = { nullptr, nullptr };
+        int outDataLen[2] = { 0, 0 };
+
+        for (int simd = 0; simd < (vectorized ? 2 : 1); ++simd)
+        {
+            Texture2D::setVectorizedConversionEnabled(simd == 1);
+
+            struct timeval now;
+            gettimeofday(&now, NULL);
+            Texture2D::convertDataToFormat(&data[0], dataLen, conversion.from, conversion.to, &outData[simd], &outDataLen[simd]);
+            log("  %s ms:%f", simd ? "simd  " : "scalar", calculateDeltaTime(&now) * 1000);
+        }
+
+        // the simd kernels must give the same pixels as the scalar code, including the tail pixels
+        if (vectorized && (outDataLen[0] != outDataLen[1] || memcmp(outData[0], outData[1], outDataLen[0]) != 0))
+        {
+            log("  ERROR: the simd output differs from the scalar one");
+        }
+
+        for (auto out : outData)
+        {
+            if (out != &data[0])
+            {
+                delete [] out;
+            }
+        }
+    }
+
+    Texture2D::setVectorizedConversionEnabled(vectorized);
+}
+
 void TextureTest::performTests()
 {
 //     Texture2D *texture;
@@ -330,6 +395,14 @@ void TextureTest::performTests()
 //     else
 //         log("ERROR");
 //     cache->removeTexture(texture);
+
+    // pixel format conversions only, no GL upload, so 2048x2048 is fine everywhere
+    log("--- CONVERSION 2048x2048 ---");
+    performTestsConversion(2048, 2048);
+
+    // an odd pixel count, so the simd kernels also convert tail pixels
+    log("--- CONVERSION 127x3 ---");
+    performTestsConversion(127, 3);
 }
 
 std::string TextureTest::title()
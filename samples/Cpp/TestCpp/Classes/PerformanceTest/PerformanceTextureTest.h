@@ -31,6 +31,7 @@ public:
     virtual std::string title();
     virtual std::string subtitle();
     void performTestsPNG(const char* filename);
+    void performTestsConversion(int width, int height);
 
     static Scene* scene();
 };
@@ -29,7 +29,7 @@
 
 enum
 {
-    TEST_COUNT = 3,
+    TEST_COUNT = 4,
 };
 
 static int s_nTouchCurCase = 0;
@@ -53,6 +53,9 @@ void TouchesMainScene::showCurrentTest()
     case 2:
         layer = new TouchesPerformTest3(true, TEST_COUNT, _curCase);
         break;
+    case 3:
+        layer = new TouchesPerformTest4(true, TEST_COUNT, _curCase);
+        break;
     }
     s_nTouchCurCase = _curCase;
 
@@ -306,6 +309,9 @@ void TouchesPerformTest3::showCurrentTest()
         case 2:
             layer = new TouchesPerformTest3(true, TEST_COUNT, _curCase);
             break;
+        case 3:
+            layer = new TouchesPerformTest4(true, TEST_COUNT, _curCase);
+            break;
     }
     s_nTouchCurCase = _curCase;
     
@@ -319,6 +325,101 @@ void TouchesPerformTest3::showCurrentTest()
     }
 }
 
+////////////////////////////////////////////////////////
+//
+// TouchesPerformTest4
+//
+////////////////////////////////////////////////////////
+void TouchesPerformTest4::onEnter()
+{
+    PerformBasicLayer::onEnter();
+    
+    auto s = Director::getInstance()->getWinSize();
+    
+    // add title
+    auto label = LabelTTF::create(title().c_str(), "Arial", 32);
+    addChild(label, 1);
+    label->setPosition(Point(s.width/2, s.height-50));
+    
+#define SORT_PROFILER_NAME  "SceneGraphSortProfileName"
+#define CONTAINER_NODE_NUM 50
+#define CHILD_NODE_NUM 100
+    
+    // A big scene graph (5000 nodes) with only one touchable node in it,
+    // every dispatch below has to sort the scene graph priority listeners again.
+    Node* touchableParent = nullptr;
+    for (int i = 0; i < CONTAINER_NODE_NUM; ++i)
+    {
+        auto container = Node::create();
+        for (int j = 0; j < CHILD_NODE_NUM; ++j)
+        {
+            container->addChild(Node::create(), j - CHILD_NODE_NUM / 2);
+        }
+        addChild(container, i);
+        
+        if (i == CONTAINER_NODE_NUM / 2)
+            touchableParent = container;
+    }
+    
+    auto layer = new TouchableLayer();
+    
+    auto listener = EventListenerTouchOneByOne::create();
+    listener->onTouchBegan = CC_CALLBACK_2(TouchableLayer::onTouchBegan, layer);
+    listener->onTouchMoved = CC_CALLBACK_2(TouchableLayer::onTouchMoved, layer);
+    listener->onTouchEnded = CC_CALLBACK_2(TouchableLayer::onTouchEnded, layer);
+    listener->onTouchCancelled = CC_CALLBACK_2(TouchableLayer::onTouchCancelled, layer);
+    _eventDispatcher->addEventListenerWithSceneGraphPriority(listener, layer);
+    
+    touchableParent->addChild(layer);
+    layer->release();
+    
+    auto emitEventlabel = LabelTTF::create("Emit Touch Event", "", 24);
+    auto menuItem = MenuItemLabel::create(emitEventlabel, [this, layer](Object* sender){
+        
+        CC_PROFILER_PURGE_ALL();
+        
+        std::vector<Touch*> touches;
+        for (int i = 0; i < EventTouch::MAX_TOUCHES; ++i)
+        {
+            Touch* touch = new Touch();
+            touch->setTouchInfo(i, 10, (i+1) * 10);
+            touches.push_back(touch);
+        }
+        
+        EventTouch event;
+        event.setEventCode(EventTouch::EventCode::BEGAN);
+        event.setTouches(touches);
+        
+        for (int i = 0; i < 100; ++i)
+        {
+            // Marks the listener dirty so that it's sorted again
+            layer->setZOrder(layer->getZOrder());
+            
+            CC_PROFILER_START(SORT_PROFILER_NAME);
+            
+            _eventDispatcher->dispatchEvent(&event);
+            
+            CC_PROFILER_STOP(SORT_PROFILER_NAME);
+        }
+        
+        CC_PROFILER_DISPLAY_TIMERS();
+        
+        for (auto& touch : touches)
+        {
+            touch->release();
+        }
+    });
+    
+    menuItem->setPosition(Point(0, -20));
+    auto menu = Menu::create(menuItem, NULL);
+    addChild(menu);
+}
+
+std::string TouchesPerformTest4::title()
+{
+    return "Scene Graph Sort Perf Test";
+}
+
 void runTouchesTest()
 {
     s_nTouchCurCase = 0;
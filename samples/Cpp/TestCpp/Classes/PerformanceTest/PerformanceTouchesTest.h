@@ -72,6 +72,18 @@ public:
     virtual void showCurrentTest() override;
 };
 
+class TouchesPerformTest4 : public TouchesPerformTest3
+{
+public:
+    TouchesPerformTest4(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+    : TouchesPerformTest3(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+    
+    virtual void onEnter() override;
+    virtual std::string title() override;
+};
+
 void runTouchesTest();
 
 #endif